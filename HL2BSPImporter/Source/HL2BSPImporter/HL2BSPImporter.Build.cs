@@ -17,7 +17,11 @@ public class HL2BSPImporter : ModuleRules
                 "RenderCore", "RHI",
                 "AssetTools", "Projects",
                 // Needed for UDeveloperSettings (UHL2BSPImporterSettings)
-                "DeveloperSettings"
+                "DeveloperSettings",
+                // Brush hull collision: FKConvexElem cooking and the benchmark's Chaos cook/trace timings
+                "PhysicsCore", "Chaos",
+                // UHL2VisibilityData, written for chunked worlds
+                "HL2BSPRuntime"
             });
     }
 }
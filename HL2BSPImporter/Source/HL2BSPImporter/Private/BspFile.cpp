@@ -1,98 +1,378 @@
 #include "BspFile.h"
 #include "HL2BSPImporter.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
+#include "Tasks/Task.h"
+#include <atomic>
 
-// Source/HL2 BSP (VBSP v20) minimal reader for faces/verts and texnames.
+// Source/HL2 BSP (VBSP v20) reader: memory-mapped lump views, decoded concurrently into structure-of-arrays geometry.
 
-#pragma pack(push, 1)
-struct FLumpInfo { int32 Ofs; int32 Len; int32 Version; int32 FourCC; };
-struct FBspHeader { int32 Ident; int32 Version; FLumpInfo Lumps[64]; int32 MapRevision; };
-struct DVertex { float Pos[3]; };
-struct DEdge { uint16 V[2]; };
-struct DFace
+static constexpr int32 BspFaceChunkSize = 4096;
+static constexpr int32 BspGameLumpStaticProps = (int32('s') << 24) | (int32('p') << 16) | (int32('r') << 8) | int32('p');
+static constexpr int32 BspStaticPropNameLen = 128;
+// Rough cost of one face corner and one triangle further down the import: the builder's point and triangle streams
+// plus the MeshDescription vertex instance / triangle with their attributes
+static constexpr int32 BspBytesPerCorner = 160;
+static constexpr int32 BspBytesPerTriangle = 64;
+
+DECLARE_CYCLE_STAT(TEXT("BSP Open"), STAT_HL2_BspOpen, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("BSP Parse"), STAT_HL2_BspParse, STATGROUP_HL2BSPImporter);
+
+void FBspFile::Close()
 {
-    uint16 Planenum; uint8 Side; uint8 OnNode; int32 FirstEdge; int16 NumEdges; int16 TexInfo; int16 DispInfo; int16 SurfaceFogVolumeID;
-    uint8 Styles[4]; int32 Lightofs; float Area; int32 LmMins[2]; int32 LmSize[2]; int32 OrigFace; uint16 NumPrims; uint16 FirstPrimID; uint32 SmoothingGroups;
-};
-struct DTexInfo { float TextureVecs[2][4]; float LightmapVecs[2][4]; int32 Flags; int32 TexData; };
-struct DTexData { float Reflectivity[3]; int32 NameStringTableID; int32 Width; int32 Height; int32 ViewWidth; int32 ViewHeight; };
-#pragma pack(pop)
-
-static FORCEINLINE bool ReadArray(const TArray<uint8>& Data, int32 Ofs, int32 Count, void* Out)
+    RawData = TConstArrayView<uint8>();
+    MappedRegion.Reset();
+    MappedHandle.Reset();
+    FallbackBytes.Empty();
+    SourceFilename.Reset();
+}
+
+bool FBspFile::Open(const FString& Filename)
 {
-    int64 Need = (int64)Ofs + Count;
-    if (Ofs < 0 || Need > Data.Num()) return false;
-    FMemory::Memcpy(Out, Data.GetData() + Ofs, Count);
+    HL2_STAGE_SCOPE(STAT_HL2_BspOpen);
+    Close();
+    SourceFilename = Filename;
+
+    MappedHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+    if (MappedHandle.IsValid())
+    {
+        const int64 Size = MappedHandle->GetFileSize();
+        if (Size <= 0 || Size > MAX_int32)
+        {
+            UE_LOG(LogHL2BSPImporter, Error, TEXT("BSP size not supported for mapping: %s (size=%lld)"), *Filename, Size);
+            Close();
+            return false;
+        }
+        MappedRegion.Reset(MappedHandle->MapRegion(0, Size));
+        if (MappedRegion.IsValid())
+        {
+            RawData = TConstArrayView<uint8>(MappedRegion->GetMappedPtr(), (int32)MappedRegion->GetMappedSize());
+        }
+        else
+        {
+            MappedHandle.Reset();
+        }
+    }
+    if (!MappedRegion.IsValid())
+    {
+        UE_LOG(LogHL2BSPImporter, Verbose, TEXT("Memory mapping unavailable for %s; using buffered read."), *Filename);
+        if (!FFileHelper::LoadFileToArray(FallbackBytes, *Filename))
+        {
+            UE_LOG(LogHL2BSPImporter, Error, TEXT("BSP LoadFileToArray failed: %s"), *Filename);
+            Close();
+            return false;
+        }
+        RawData = FallbackBytes;
+    }
+
+    const FBspHeader* H = GetHeader();
+    if (!H) { UE_LOG(LogHL2BSPImporter, Error, TEXT("BSP too small for header: %s (size=%d)"), *Filename, RawData.Num()); return false; }
+    const int32 VBSP = int32('V') | (int32('B') << 8) | (int32('S') << 16) | (int32('P') << 24);
+    if (H->Ident != VBSP) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Wrong BSP magic. Expected 'VBSP' got 0x%08x for %s"), H->Ident, *Filename); return false; }
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("VBSP header: Version=%d MapRevision=%d Mapped=%s"), H->Version, H->MapRevision, IsMapped() ? TEXT("true") : TEXT("false"));
     return true;
 }
 
-bool FBspFile::LoadFromFile(const FString& Filename)
+bool FBspFile::GetLumpBytes(int32 LumpIndex, int32 ElementSize, int32 ElementAlign, TConstArrayView<uint8>& OutBytes) const
 {
-    Vertices.Reset();
-    Faces.Reset();
-    DispInfos.Reset();
-    DispVerts.Reset();
-
-    TArray<uint8> Bytes;
-    if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+    OutBytes = TConstArrayView<uint8>();
+    const FBspHeader* H = GetHeader();
+    if (!H || LumpIndex < 0 || LumpIndex >= 64) return false;
+    const FLumpInfo& L = H->Lumps[LumpIndex];
+    if (L.Len == 0) return true;
+    const int64 End = (int64)L.Ofs + L.Len;
+    if (L.Ofs < 0 || L.Len < 0 || End > RawData.Num())
     {
-        UE_LOG(LogHL2BSPImporter, Error, TEXT("BSP LoadFileToArray failed: %s"), *Filename);
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("Lump %d out of bounds (ofs=%d len=%d file=%d)"), LumpIndex, L.Ofs, L.Len, RawData.Num());
         return false;
     }
+    const uint8* Ptr = RawData.GetData() + L.Ofs;
+    if (!IsAligned(Ptr, ElementAlign))
+    {
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("Lump %d is not %d-byte aligned (ofs=%d)"), LumpIndex, ElementAlign, L.Ofs);
+        return false;
+    }
+    if (L.Len % ElementSize != 0)
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("Lump %d length %d is not a multiple of %d; trailing bytes ignored"), LumpIndex, L.Len, ElementSize);
+    }
+    OutBytes = TConstArrayView<uint8>(Ptr, L.Len - (L.Len % ElementSize));
+    return true;
+}
 
-    if (Bytes.Num() < (int32)sizeof(FBspHeader)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("BSP too small for header: %s (size=%d)"), *Filename, Bytes.Num()); return false; }
-    FBspHeader H{};
-    FMemory::Memcpy(&H, Bytes.GetData(), sizeof(FBspHeader));
-    const int32 VBSP = int32('V') | (int32('B') << 8) | (int32('S') << 16) | (int32('P') << 24);
-    if (H.Ident != VBSP) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Wrong BSP magic. Expected 'VBSP' got 0x%08x for %s"), H.Ident, *Filename); return false; }
-    UE_LOG(LogHL2BSPImporter, Log, TEXT("VBSP header: Version=%d MapRevision=%d"), H.Version, H.MapRevision);
-
-    const FLumpInfo& LVerts = H.Lumps[3]; // LUMP_VERTEXES
-    const FLumpInfo& LEdges = H.Lumps[12]; // LUMP_EDGES
-    const FLumpInfo& LSurfEdges = H.Lumps[13]; // LUMP_SURFEDGES
-    const FLumpInfo& LFaces = H.Lumps[7]; // LUMP_FACES
-    const FLumpInfo& LTexInfo = H.Lumps[6]; // LUMP_TEXINFO
-    const FLumpInfo& LTexData = H.Lumps[2]; // LUMP_TEXDATA
-    const FLumpInfo& LTexStrTab = H.Lumps[43]; // LUMP_TEXDATA_STRING_TABLE
-    const FLumpInfo& LTexStrData = H.Lumps[44]; // LUMP_TEXDATA_STRING_DATA
-
-    // Load vertices
-    const int32 NumSrcVerts = LVerts.Len / sizeof(DVertex);
-    TArray<DVertex> SrcVerts; SrcVerts.SetNum(NumSrcVerts);
-    if (!ReadArray(Bytes, LVerts.Ofs, LVerts.Len, SrcVerts.GetData())) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_VERTEXES (ofs=%d len=%d)"), LVerts.Ofs, LVerts.Len); return false; }
-
-    // Load edges
-    const int32 NumEdges = LEdges.Len / sizeof(DEdge);
-    TArray<DEdge> Edges; Edges.SetNum(NumEdges);
-    if (!ReadArray(Bytes, LEdges.Ofs, LEdges.Len, Edges.GetData())) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_EDGES (ofs=%d len=%d)"), LEdges.Ofs, LEdges.Len); return false; }
-
-    // Load surfedges (int32 indices, may be negative)
-    const int32 NumSurfEdges = LSurfEdges.Len / sizeof(int32);
-    TArray<int32> SurfEdges; SurfEdges.SetNum(NumSurfEdges);
-    if (!ReadArray(Bytes, LSurfEdges.Ofs, LSurfEdges.Len, SurfEdges.GetData())) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_SURFEDGES (ofs=%d len=%d)"), LSurfEdges.Ofs, LSurfEdges.Len); return false; }
-
-    // Load faces
-    const int32 NumFaces = LFaces.Len / sizeof(DFace);
-    TArray<DFace> FacesSrc; FacesSrc.SetNum(NumFaces);
-    if (!ReadArray(Bytes, LFaces.Ofs, LFaces.Len, FacesSrc.GetData())) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_FACES (ofs=%d len=%d)"), LFaces.Ofs, LFaces.Len); return false; }
-
-    // Load texinfo
-    const int32 NumTexInfos = LTexInfo.Len / sizeof(DTexInfo);
-    TArray<DTexInfo> TexInfos; TexInfos.SetNum(NumTexInfos);
-    if (!ReadArray(Bytes, LTexInfo.Ofs, LTexInfo.Len, TexInfos.GetData())) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_TEXINFO (ofs=%d len=%d)"), LTexInfo.Ofs, LTexInfo.Len); return false; }
-
-    // Load texdata
-    const int32 NumTexData = LTexData.Len / sizeof(DTexData);
-    TArray<DTexData> TexDatas; TexDatas.SetNum(NumTexData);
-    if (!ReadArray(Bytes, LTexData.Ofs, LTexData.Len, TexDatas.GetData())) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_TEXDATA (ofs=%d len=%d)"), LTexData.Ofs, LTexData.Len); return false; }
-
-    // Load texture string table and data
-    const int32 NumStrOffsets = LTexStrTab.Len / sizeof(int32);
-    TArray<int32> StrOffsets; StrOffsets.SetNum(NumStrOffsets);
-    if (!ReadArray(Bytes, LTexStrTab.Ofs, LTexStrTab.Len, StrOffsets.GetData())) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_TEXDATA_STRING_TABLE (ofs=%d len=%d)"), LTexStrTab.Ofs, LTexStrTab.Len); return false; }
-    TArray<uint8> StrData; StrData.SetNum(LTexStrData.Len);
-    if (!ReadArray(Bytes, LTexStrData.Ofs, LTexStrData.Len, StrData.GetData())) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_TEXDATA_STRING_DATA (ofs=%d len=%d)"), LTexStrData.Ofs, LTexStrData.Len); return false; }
+// Promotes the keys the entity DataTable cares about out of the flat key/value store
+static void BuildEntityRows(const FHL2EntityKeyValues& KV, TArray<FHL2Entity>& OutEntities)
+{
+    auto ToString = [](FAnsiStringView V) { return FString(V.Len(), V.GetData()); };
+
+    OutEntities.SetNum(KV.NumEntities());
+    for (int32 i = 0; i < KV.NumEntities(); ++i)
+    {
+        FHL2Entity& E = OutEntities[i];
+        E.Name = ToString(KV.FindValue(i, "targetname"));
+        E.Class = ToString(KV.FindValue(i, "classname"));
+        E.Model = ToString(KV.FindValue(i, "model"));
+        float V[3];
+        if (FHL2EntityKeyValues::ParseFloats(KV.FindValue(i, "origin"), V, 3) == 3)
+        {
+            E.Origin = FVector(V[0], V[1], V[2]);
+        }
+        if (FHL2EntityKeyValues::ParseFloats(KV.FindValue(i, "angles"), V, 3) == 3)
+        {
+            E.Rotation = FRotator(V[0], V[1], V[2]);
+        }
+    }
+}
+
+// sprp entry size per version (HL2 ships v4/v5, Episode Two v6, later Orange Box titles v7)
+static int32 StaticPropEntrySize(int32 Version)
+{
+    switch (Version)
+    {
+    case 4: return 56;
+    case 5: return 60;
+    case 6: return 64;
+    case 7: return 68;
+    default: return 0;
+    }
+}
+
+void FBspFile::ParseStaticProps()
+{
+    TConstArrayView<uint8> Dir;
+    if (!GetLumpView(BspLump::GameLump, Dir) || Dir.Num() < (int32)sizeof(int32))
+    {
+        return;
+    }
+    int32 NumGameLumps = 0;
+    FMemory::Memcpy(&NumGameLumps, Dir.GetData(), sizeof(int32));
+    if (NumGameLumps < 0 || (int64)NumGameLumps * (int64)sizeof(DGameLump) > (int64)Dir.Num() - (int64)sizeof(int32))
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("Game lump directory is truncated (count=%d bytes=%d)"), NumGameLumps, Dir.Num());
+        return;
+    }
+
+    for (int32 g = 0; g < NumGameLumps; ++g)
+    {
+        DGameLump GL;
+        FMemory::Memcpy(&GL, Dir.GetData() + sizeof(int32) + g * sizeof(DGameLump), sizeof(DGameLump));
+        if (GL.Id != BspGameLumpStaticProps)
+        {
+            continue;
+        }
+        if (GL.Flags & 1)
+        {
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("sprp game lump is compressed; static props skipped"));
+            return;
+        }
+        const int32 EntrySize = StaticPropEntrySize(GL.Version);
+        if (EntrySize == 0)
+        {
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("sprp game lump version %d is not supported (4-7); static props skipped"), GL.Version);
+            return;
+        }
+        if (GL.FileOfs < 0 || GL.FileLen < 0 || (int64)GL.FileOfs + GL.FileLen > RawData.Num())
+        {
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("sprp game lump out of bounds (ofs=%d len=%d file=%d)"), GL.FileOfs, GL.FileLen, RawData.Num());
+            return;
+        }
+
+        // Sequential reader over the lump; every read is bounds-checked and unaligned-safe
+        const uint8* Ptr = RawData.GetData() + GL.FileOfs;
+        const uint8* End = Ptr + GL.FileLen;
+        auto ReadCount = [&](int32 ElementSize, int32& OutCount)
+        {
+            if (End - Ptr < (int64)sizeof(int32)) return false;
+            FMemory::Memcpy(&OutCount, Ptr, sizeof(int32));
+            Ptr += sizeof(int32);
+            return OutCount >= 0 && (int64)OutCount * ElementSize <= End - Ptr;
+        };
+
+        int32 NumNames = 0;
+        if (!ReadCount(BspStaticPropNameLen, NumNames)) { UE_LOG(LogHL2BSPImporter, Warning, TEXT("sprp model dictionary is truncated")); return; }
+        StaticPropModels.SetNum(NumNames);
+        for (int32 n = 0; n < NumNames; ++n, Ptr += BspStaticPropNameLen)
+        {
+            const ANSICHAR* Name = (const ANSICHAR*)Ptr;
+            StaticPropModels[n] = FString((int32)FCStringAnsi::Strnlen(Name, BspStaticPropNameLen), Name);
+        }
+
+        int32 NumLeafs = 0;
+        if (!ReadCount(sizeof(uint16), NumLeafs)) { UE_LOG(LogHL2BSPImporter, Warning, TEXT("sprp leaf list is truncated")); return; }
+        Ptr += NumLeafs * sizeof(uint16);
+
+        int32 NumProps = 0;
+        if (!ReadCount(EntrySize, NumProps)) { UE_LOG(LogHL2BSPImporter, Warning, TEXT("sprp v%d prop list is truncated"), GL.Version); return; }
+        StaticProps.SetNum(NumProps);
+        for (int32 p = 0; p < NumProps; ++p, Ptr += EntrySize)
+        {
+            DStaticPropV4 Src;
+            FMemory::Memcpy(&Src, Ptr, sizeof(Src));
+            FBspStaticProp& Prop = StaticProps[p];
+            Prop.Origin = FVector3f(Src.Origin[0], Src.Origin[1], Src.Origin[2]);
+            Prop.Angles = FVector3f(Src.Angles[0], Src.Angles[1], Src.Angles[2]);
+            Prop.Model = Src.PropType < NumNames ? Src.PropType : INDEX_NONE;
+            Prop.Skin = Src.Skin;
+            Prop.FadeMinDist = Src.FadeMinDist;
+            Prop.FadeMaxDist = Src.FadeMaxDist;
+            Prop.Solid = Src.Solid;
+            Prop.Flags = Src.Flags;
+        }
+        return;
+    }
+}
+
+// Classes whose origin a player can stand at or see from: spawn points, level transition landmarks and the 3D
+// skybox camera (the skybox is a separate pocket of the world that no spawn point reaches)
+static bool IsVisStartClass(const FString& Class)
+{
+    return Class.StartsWith(TEXT("info_player_")) || Class == TEXT("info_landmark") || Class == TEXT("sky_camera");
+}
+
+void FBspFile::CullUnreachableFaces()
+{
+    const double Start = FPlatformTime::Seconds();
+    if (!Tree.IsValid() || !Tree.HasVisibility())
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("PVS face culling skipped: the map has no %s"), Tree.IsValid() ? TEXT("visibility data (compiled without vvis?)") : TEXT("BSP tree"));
+        return;
+    }
+    VisStats.Clusters = Tree.NumClusters;
+
+    // Start clusters, then the closure over the PVS: every cluster a start cluster can see, and so on. Clusters joined
+    // by a portal always see each other, so this covers every cluster a player can walk to.
+    TBitArray<> Reachable(false, Tree.NumClusters);
+    TArray<int32> Pending;
+    for (const FHL2Entity& Entity : Entities)
+    {
+        if (!IsVisStartClass(Entity.Class)) continue;
+        const int32 Leaf = Tree.PointInLeaf(FVector3f(Entity.Origin));
+        const int32 Cluster = Tree.Leafs.IsValidIndex(Leaf) ? Tree.Leafs[Leaf].Cluster : -1;
+        if (Cluster < 0 || Cluster >= Tree.NumClusters || Reachable[Cluster]) continue;
+        Reachable[Cluster] = true;
+        Pending.Add(Cluster);
+    }
+    VisStats.StartClusters = Pending.Num();
+    if (Pending.Num() == 0)
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("PVS face culling skipped: no info_player_*, info_landmark or sky_camera inside a cluster"));
+        return;
+    }
+    TBitArray<> Visible;
+    while (Pending.Num() > 0)
+    {
+        if (!Tree.GetClusterPVS(Pending.Pop(EAllowShrinking::No), Visible))
+        {
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("PVS face culling skipped: corrupt visibility row"));
+            return;
+        }
+        for (TConstSetBitIterator<> It(Visible); It; ++It)
+        {
+            if (Reachable[It.GetIndex()]) continue;
+            Reachable[It.GetIndex()] = true;
+            Pending.Add(It.GetIndex());
+        }
+    }
+    VisStats.ReachableClusters = Reachable.CountSetBits();
+
+    TBitArray<> Referenced(false, Geometry.NumFaces());
+    for (const FHL2BspLeaf& Leaf : Tree.Leafs)
+    {
+        if (Leaf.Cluster < 0 || Leaf.Cluster >= Tree.NumClusters || !Reachable[Leaf.Cluster]) continue;
+        for (int32 i = Leaf.FirstLeafFace; i < Leaf.FirstLeafFace + Leaf.NumLeafFaces; ++i)
+        {
+            const int32 Face = Tree.LeafFaces[i];
+            if (Face < Geometry.NumFaces()) Referenced[Face] = true;
+        }
+    }
+
+    // Only world brush faces are listed in leaves: brush entity faces and displacements stay. Sky faces kept for the
+    // sky mesh stay too.
+    for (int32 f = 0; f < Geometry.NumFaces(); ++f)
+    {
+        const int32 NumCorners = Geometry.FaceNumCorners[f];
+        if (Referenced[f] || NumCorners < 3 || Geometry.FaceModel[f] != 0) continue;
+        if (Geometry.FaceFlags[f] & (BspFaceFlags::Displacement | BspFaceFlags::Sky)) continue;
+        Geometry.FaceNumCorners[f] = 0;
+        Geometry.FaceFlags[f] |= BspFaceFlags::Culled;
+        ++VisStats.FacesRemoved;
+        VisStats.TrianglesRemoved += NumCorners - 2;
+        VisStats.BytesSaved += (int64)NumCorners * BspBytesPerCorner + (int64)(NumCorners - 2) * BspBytesPerTriangle;
+    }
+    CullStats.Faces[(int32)EBspCullReason::Unreachable] = VisStats.FacesRemoved;
+    VisStats.bApplied = true;
+    VisStats.Ms = (FPlatformTime::Seconds() - Start) * 1000.0;
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("PVS face culling: StartClusters=%d Reachable=%d/%d FacesRemoved=%d TrianglesRemoved=%d Saved~%.1fMB (%.2fms)"),
+        VisStats.StartClusters, VisStats.ReachableClusters, VisStats.Clusters, VisStats.FacesRemoved, VisStats.TrianglesRemoved,
+        VisStats.BytesSaved / (1024.0 * 1024.0), VisStats.Ms);
+}
+
+// Cull reason for one texinfo under Filter; Name is the texinfo's texture name
+static EBspCullReason ClassifyTexInfo(int32 SurfFlags, const FString& Name, const FBspFaceFilter& Filter)
+{
+    const int32 Flags = SurfFlags & Filter.CullSurfaceFlags;
+    if (Flags & BspSurf::NoDraw) return EBspCullReason::NoDraw;
+    if (Flags & (BspSurf::Sky | BspSurf::Sky2D)) return EBspCullReason::Sky;
+    if (Flags & BspSurf::Skip) return EBspCullReason::Skip;
+    if (Flags & BspSurf::Hint) return EBspCullReason::Hint;
+    if (Flags & BspSurf::Trigger) return EBspCullReason::Trigger;
+    if (Filter.CullTexturePrefixes.Num() > 0 && !Name.IsEmpty())
+    {
+        FString Key = Name.ToLower();
+        Key.ReplaceCharInline(TEXT('\\'), TEXT('/'));
+        for (const FString& Prefix : Filter.CullTexturePrefixes)
+        {
+            if (Key.StartsWith(Prefix, ESearchCase::CaseSensitive)) return EBspCullReason::ToolTexture;
+        }
+    }
+    return EBspCullReason::None;
+}
+
+bool FBspFile::Parse(const FBspFaceFilter& Filter)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_BspParse);
+    Geometry.Reset();
+    Models.Reset();
+    DispInfos.Reset();
+    DispVerts.Reset();
+    EntityKeyValues.Reset();
+    Entities.Reset();
+    StaticPropModels.Reset();
+    StaticProps.Reset();
+    DecodeStats = FBspDecodeStats();
+    CullStats = FBspCullStats();
+    VisStats = FBspVisStats();
+    Tree.Reset();
+
+    if (!GetHeader()) { UE_LOG(LogHL2BSPImporter, Error, TEXT("BSP Parse called without an open file")); return false; }
+
+    TConstArrayView<DVertex> SrcVerts;
+    if (!GetLumpView(BspLump::Vertexes, SrcVerts)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_VERTEXES")); return false; }
+    TConstArrayView<DEdge> Edges;
+    if (!GetLumpView(BspLump::Edges, Edges)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_EDGES")); return false; }
+    // Surfedges are int32 indices, may be negative
+    TConstArrayView<int32> SurfEdges;
+    if (!GetLumpView(BspLump::SurfEdges, SurfEdges)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_SURFEDGES")); return false; }
+    TConstArrayView<DFace> FacesSrc;
+    if (!GetLumpView(BspLump::Faces, FacesSrc)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_FACES")); return false; }
+    TConstArrayView<DTexInfo> TexInfos;
+    if (!GetLumpView(BspLump::TexInfo, TexInfos)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_TEXINFO")); return false; }
+    TConstArrayView<DTexData> TexDatas;
+    if (!GetLumpView(BspLump::TexData, TexDatas)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_TEXDATA")); return false; }
+    TConstArrayView<int32> StrOffsets;
+    if (!GetLumpView(BspLump::TexDataStringTable, StrOffsets)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_TEXDATA_STRING_TABLE")); return false; }
+    TConstArrayView<uint8> StrData;
+    if (!GetLumpView(BspLump::TexDataStringData, StrData)) { UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed reading LUMP_TEXDATA_STRING_DATA")); return false; }
+
+    const int32 NumSrcVerts = SrcVerts.Num();
+    const int32 NumEdges = Edges.Num();
+    const int32 NumSurfEdges = SurfEdges.Num();
+    const int32 NumFaces = FacesSrc.Num();
+    const int32 NumTexInfos = TexInfos.Num();
+    const int32 NumTexData = TexDatas.Num();
+    const int32 NumStrOffsets = StrOffsets.Num();
 
     UE_LOG(LogHL2BSPImporter, Log, TEXT("VBSP header OK. Verts=%d Edges=%d SurfEdges=%d Faces=%d TexInfo=%d TexData=%d StrTab=%d"),
         NumSrcVerts, NumEdges, NumSurfEdges, NumFaces, NumTexInfos, NumTexData, NumStrOffsets);
@@ -107,17 +387,17 @@ bool FBspFile::LoadFromFile(const FString& Filename)
         const int32 Ofs = StrOffsets[StrIdx];
         if (Ofs < 0 || Ofs >= StrData.Num()) return FString();
         const ANSICHAR* Start = (const ANSICHAR*)(StrData.GetData() + Ofs);
-        return FString(UTF8_TO_TCHAR(Start));
+        const int32 Len = (int32)FCStringAnsi::Strnlen(Start, StrData.Num() - Ofs);
+        const FUTF8ToTCHAR Conv(Start, Len);
+        return FString(Conv.Length(), Conv.Get());
     };
 
-    auto ComputeUV = [&](const FVector& P, int32 TexInfoIndex) -> FVector2D
+    auto ComputeUV = [&](const FVector3f& P, int32 TexInfoIndex) -> FVector2f
     {
-        if (TexInfoIndex < 0 || TexInfoIndex >= TexInfos.Num()) return FVector2D::ZeroVector;
+        if (TexInfoIndex < 0 || TexInfoIndex >= TexInfos.Num()) return FVector2f::ZeroVector;
         const DTexInfo& TI = TexInfos[TexInfoIndex];
-        const FVector4 S(TI.TextureVecs[0][0], TI.TextureVecs[0][1], TI.TextureVecs[0][2], TI.TextureVecs[0][3]);
-        const FVector4 T(TI.TextureVecs[1][0], TI.TextureVecs[1][1], TI.TextureVecs[1][2], TI.TextureVecs[1][3]);
-        float u = FVector::DotProduct(P, FVector(S.X, S.Y, S.Z)) + S.W;
-        float v = FVector::DotProduct(P, FVector(T.X, T.Y, T.Z)) + T.W;
+        float u = P.X * TI.TextureVecs[0][0] + P.Y * TI.TextureVecs[0][1] + P.Z * TI.TextureVecs[0][2] + TI.TextureVecs[0][3];
+        float v = P.X * TI.TextureVecs[1][0] + P.Y * TI.TextureVecs[1][1] + P.Z * TI.TextureVecs[1][2] + TI.TextureVecs[1][3];
         // Optional: normalize by texture size if available
         const int32 TexDataIndex = TI.TexData;
         if (TexDataIndex >= 0 && TexDataIndex < TexDatas.Num())
@@ -126,159 +406,317 @@ bool FBspFile::LoadFromFile(const FString& Filename)
             const float H = FMath::Max(1, TexDatas[TexDataIndex].Height);
             u /= W; v /= H;
         }
-        return FVector2D(u, v);
+        return FVector2f(u, v);
     };
 
-    // Build faces
-    for (int32 f = 0; f < FacesSrc.Num(); ++f)
+    auto ComputeLightmapUV = [&](const FVector3f& P, int32 TexInfoIndex) -> FVector2f
     {
-        const DFace& DF = FacesSrc[f];
-        if (DF.NumEdges < 3) continue;
-        const int32 StartIndex = Vertices.Num();
-        TArray<int32> PolyVertIdx; PolyVertIdx.Reserve(DF.NumEdges);
-        for (int32 i = 0; i < DF.NumEdges; ++i)
+        if (TexInfoIndex < 0 || TexInfoIndex >= TexInfos.Num()) return FVector2f::ZeroVector;
+        const DTexInfo& TI = TexInfos[TexInfoIndex];
+        return FVector2f(
+            P.X * TI.LightmapVecs[0][0] + P.Y * TI.LightmapVecs[0][1] + P.Z * TI.LightmapVecs[0][2] + TI.LightmapVecs[0][3],
+            P.X * TI.LightmapVecs[1][0] + P.Y * TI.LightmapVecs[1][1] + P.Z * TI.LightmapVecs[1][2] + TI.LightmapVecs[1][3]);
+    };
+
+    FBspGeometry& Geo = Geometry;
+
+    // Resolves one face corner (surfedge) to a vertex index, or INDEX_NONE if any reference is out of range
+    auto ResolveCorner = [&](int32 SurfEdgeIndex) -> int32
+    {
+        const int32 SeIdx = SurfEdges[SurfEdgeIndex];
+        int32 EdgeIndex = FMath::Abs(SeIdx);
+        if (EdgeIndex < 0 || EdgeIndex >= NumEdges) return INDEX_NONE;
+        const DEdge& E = Edges[EdgeIndex];
+        const int32 VIdx = (SeIdx >= 0) ? E.V[0] : E.V[1];
+        return (VIdx >= 0 && VIdx < NumSrcVerts) ? VIdx : INDEX_NONE;
+    };
+    auto FaceEdgesValid = [&](const DFace& DF)
+    {
+        return DF.NumEdges >= 3 && DF.FirstEdge >= 0 && (int64)DF.FirstEdge + DF.NumEdges <= NumSurfEdges;
+    };
+
+    // Decode graph. Positions, texture names, displacements and entities are independent of each other;
+    // face assembly counts corners per chunk, prefix-sums the offsets, then fills each chunk in place,
+    // so the output layout does not depend on scheduling.
+    enum EDecodeTask { DT_Positions, DT_TexNames, DT_FaceCount, DT_FacePrefix, DT_FaceFill, DT_Disp, DT_Entities, DT_StaticProps, DT_Tree, DT_Num };
+    static const TCHAR* DecodeTaskNames[DT_Num] = { TEXT("Positions"), TEXT("TexNames"), TEXT("FaceCount"), TEXT("FacePrefix"), TEXT("FaceFill"), TEXT("Disp"), TEXT("Entities"), TEXT("StaticProps"), TEXT("Tree") };
+    std::atomic<uint64> DecodeCycles[DT_Num];
+    for (std::atomic<uint64>& C : DecodeCycles) { C = 0; }
+    auto Timed = [&DecodeCycles](EDecodeTask Which, auto&& Body)
+    {
+        return [&DecodeCycles, Which, Body]()
+        {
+            TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(DecodeTaskNames[Which]);
+            const uint64 Start = FPlatformTime::Cycles64();
+            Body();
+            DecodeCycles[Which] += FPlatformTime::Cycles64() - Start;
+        };
+    };
+    const double DecodeStart = FPlatformTime::Seconds();
+
+    Geo.FaceFirstCorner.SetNumUninitialized(NumFaces);
+    Geo.FaceNumCorners.SetNumZeroed(NumFaces);
+    Geo.FaceTexture.SetNumZeroed(NumFaces);
+    Geo.FaceFlags.SetNumZeroed(NumFaces);
+    Geo.FaceTexInfo.SetNumUninitialized(NumFaces);
+    Geo.FacePlane.SetNumUninitialized(NumFaces);
+    Geo.FaceSmoothingGroups.SetNumUninitialized(NumFaces);
+    Geo.FaceLightmapMins.SetNumUninitialized(NumFaces);
+    Geo.FaceLightmapSize.SetNumUninitialized(NumFaces);
+    Geo.FaceLightOfs.SetNumUninitialized(NumFaces);
+    TArray<EBspCullReason> FaceCull; FaceCull.SetNumZeroed(NumFaces);
+
+    // Models: a handful of face ranges, tagged per face before the graph starts. Model 0 is the world.
+    Geo.FaceModel.SetNumZeroed(NumFaces);
+    TConstArrayView<DModel> SrcModels;
+    if (!GetLumpView(BspLump::Models, SrcModels))
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("LUMP_MODELS is out of bounds; all faces are treated as world faces."));
+    }
+    Models.Reserve(SrcModels.Num());
+    for (int32 m = 0; m < SrcModels.Num(); ++m)
+    {
+        const DModel& DM = SrcModels[m];
+        FBspModel& Model = Models.AddDefaulted_GetRef();
+        Model.Mins = FVector3f(DM.Mins[0], DM.Mins[1], DM.Mins[2]);
+        Model.Maxs = FVector3f(DM.Maxs[0], DM.Maxs[1], DM.Maxs[2]);
+        Model.HeadNode = DM.HeadNode;
+        if (DM.FirstFace < 0 || DM.NumFaces < 0 || (int64)DM.FirstFace + DM.NumFaces > NumFaces || m > MAX_uint16)
         {
-            const int32 SeIdx = SurfEdges[DF.FirstEdge + i];
-            int32 EdgeIndex = FMath::Abs(SeIdx);
-            if (EdgeIndex < 0 || EdgeIndex >= Edges.Num()) continue;
-            const DEdge& E = Edges[EdgeIndex];
-            const int32 VIdx = (SeIdx >= 0) ? E.V[0] : E.V[1];
-            if (VIdx < 0 || VIdx >= SrcVerts.Num()) continue;
-            FVector P(SrcVerts[VIdx].Pos[0], SrcVerts[VIdx].Pos[1], SrcVerts[VIdx].Pos[2]);
-            FVector2D UV = ComputeUV(P, DF.TexInfo);
-            Vertices.Add({ P, UV });
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("Model %d has an invalid face range (%d, %d); its faces stay in the world."), m, DM.FirstFace, DM.NumFaces);
+            continue;
         }
-        const int32 NumAdded = Vertices.Num() - StartIndex;
-        if (NumAdded >= 3)
+        Model.FirstFace = DM.FirstFace;
+        Model.NumFaces = DM.NumFaces;
+        for (int32 f = Model.FirstFace; m > 0 && f < Model.FirstFace + Model.NumFaces; ++f)
         {
-            FBspFace OutF;
-            OutF.FirstVertex = StartIndex;
-            OutF.NumVertices = NumAdded;
-            OutF.TextureName = GetTexName(DF.TexInfo);
-            Faces.Add(MoveTemp(OutF));
+            Geo.FaceModel[f] = (uint16)m;
         }
     }
 
-    // Displacements (optional)
-    const int32 LUMP_DISPINFO = 26;
-    const int32 LUMP_DISP_VERTS = 33;
-    const FLumpInfo& LDispInfo = H.Lumps[LUMP_DISPINFO];
-    const FLumpInfo& LDispVerts = H.Lumps[LUMP_DISP_VERTS];
-
-#pragma pack(push, 1)
-    struct DDispInfo
-    {
-        FVector StartPosition; // float[3]
-        int32 DispVertStart;
-        int32 DispTriStart;
-        int32 Power;
-        int32 MinTess; float SmoothingAngle; int32 Contents; uint16 MapFace; uint32 Flags; int32 EntityNum;
-        uint8 LightmapAlphaStart; uint8 LightmapSamplePositionStart; uint32 EdgeNeighbors[4]; uint32 CornerNeighbors[4]; uint32 AllowedVerts[10];
-    };
-    struct DDispVert { FVector Vector; float Dist; float Alpha; };
-#pragma pack(pop)
+    // Positions: the vertex lump as-is (float, Source space); face corners index into it
+    UE::Tasks::FTask PositionsTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_Positions, [&]()
+    {
+        static_assert(sizeof(DVertex) == sizeof(FVector3f), "DVertex must alias FVector3f");
+        Geo.Positions.SetNumUninitialized(NumSrcVerts);
+        FMemory::Memcpy(Geo.Positions.GetData(), SrcVerts.GetData(), NumSrcVerts * sizeof(DVertex));
+    }));
 
-    if (LDispInfo.Len >= (int32)sizeof(DDispInfo))
+    // Texture name table: one entry per unique name, index 0 reserved for "no texture". Each texinfo is also
+    // classified against the face filter here, since tool-texture matching needs its name.
+    TArray<uint16> TexInfoTexture; TexInfoTexture.SetNumZeroed(NumTexInfos);
+    TArray<EBspCullReason> TexInfoCull; TexInfoCull.SetNumZeroed(NumTexInfos);
+    UE::Tasks::FTask TexNamesTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_TexNames, [&]()
     {
-        const int32 NumDispInfos = LDispInfo.Len / sizeof(DDispInfo);
-        TArray<DDispInfo> Disp; Disp.SetNum(NumDispInfos);
-        if (ReadArray(Bytes, LDispInfo.Ofs, LDispInfo.Len, Disp.GetData()))
+        TMap<FString, uint16> NameToId;
+        Geo.TextureNames.Add(FString());
+        NameToId.Add(FString(), 0);
+        for (int32 t = 0; t < NumTexInfos; ++t)
         {
-            DispInfos.Reset(); DispInfos.Reserve(NumDispInfos);
-            for (const DDispInfo& D : Disp)
+            FString Name = GetTexName(t);
+            TexInfoCull[t] = ClassifyTexInfo(TexInfos[t].Flags, Name, Filter);
+            if (const uint16* Found = NameToId.Find(Name))
             {
-                FDispInfo O; O.Power = D.Power; O.VertStart = D.DispVertStart; O.MapFace = (int32)D.MapFace; DispInfos.Add(O);
+                TexInfoTexture[t] = *Found;
+            }
+            else if (Geo.TextureNames.Num() <= MAX_uint16)
+            {
+                const uint16 Id = (uint16)Geo.TextureNames.Num();
+                NameToId.Add(Name, Id);
+                Geo.TextureNames.Add(MoveTemp(Name));
+                TexInfoTexture[t] = Id;
+            }
+            else
+            {
+                UE_LOG(LogHL2BSPImporter, Warning, TEXT("More than %d unique texture names; '%s' falls back to the default slot"), MAX_uint16 + 1, *Name);
             }
         }
-    }
-    if (LDispVerts.Len >= (int32)sizeof(DDispVert))
+    }));
+
+    // Faces, pass 1: valid corner count per face (faces with fewer than 3, or rejected by the filter, keep zero corners)
+    const int32 NumFaceChunks = FMath::DivideAndRoundUp(NumFaces, BspFaceChunkSize);
+    TArray<UE::Tasks::FTask> FaceCountTasks;
+    FaceCountTasks.Reserve(NumFaceChunks);
+    for (int32 Chunk = 0; Chunk < NumFaceChunks; ++Chunk)
     {
-        const int32 NumDV = LDispVerts.Len / sizeof(DDispVert);
-        TArray<DDispVert> DV; DV.SetNum(NumDV);
-        if (ReadArray(Bytes, LDispVerts.Ofs, LDispVerts.Len, DV.GetData()))
+        FaceCountTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_FaceCount, [&, Chunk]()
         {
-            DispVerts.Reset(); DispVerts.Reserve(NumDV);
-            for (const DDispVert& V : DV)
+            const int32 End = FMath::Min(NumFaces, (Chunk + 1) * BspFaceChunkSize);
+            for (int32 f = Chunk * BspFaceChunkSize; f < End; ++f)
             {
-                FDispVert Out; Out.Vector[0] = V.Vector.X; Out.Vector[1] = V.Vector.Y; Out.Vector[2] = V.Vector.Z; DispVerts.Add(Out);
+                const DFace& DF = FacesSrc[f];
+                Geo.FaceTexInfo[f] = (DF.TexInfo >= 0 && DF.TexInfo < NumTexInfos) ? DF.TexInfo : -1;
+                Geo.FacePlane[f] = (int32)DF.Planenum * 2 + (DF.Side ? 1 : 0);
+                Geo.FaceSmoothingGroups[f] = DF.SmoothingGroups;
+                const bool bLit = DF.Lightofs >= 0 && DF.LmSize[0] >= 0 && DF.LmSize[1] >= 0
+                    && !(DF.TexInfo >= 0 && DF.TexInfo < NumTexInfos && (TexInfos[DF.TexInfo].Flags & BspSurf::NoLight));
+                Geo.FaceLightmapMins[f] = FIntPoint(DF.LmMins[0], DF.LmMins[1]);
+                Geo.FaceLightmapSize[f] = bLit ? FIntPoint(DF.LmSize[0] + 1, DF.LmSize[1] + 1) : FIntPoint::ZeroValue;
+                Geo.FaceLightOfs[f] = bLit ? DF.Lightofs : -1;
+                const EBspCullReason Cull = (DF.TexInfo >= 0 && DF.TexInfo < NumTexInfos) ? TexInfoCull[DF.TexInfo] : EBspCullReason::None;
+                Geo.FaceFlags[f] = DF.DispInfo >= 0 ? BspFaceFlags::Displacement : 0;
+                if (Cull == EBspCullReason::Sky && Filter.bKeepSky)
+                {
+                    Geo.FaceFlags[f] |= BspFaceFlags::Sky;
+                }
+                else if (Cull != EBspCullReason::None)
+                {
+                    Geo.FaceFlags[f] |= BspFaceFlags::Culled;
+                    FaceCull[f] = Cull;
+                    continue;
+                }
+                if (!FaceEdgesValid(DF)) continue;
+                int32 Count = 0;
+                for (int32 i = 0; i < DF.NumEdges; ++i)
+                {
+                    Count += ResolveCorner(DF.FirstEdge + i) != INDEX_NONE ? 1 : 0;
+                }
+                Geo.FaceNumCorners[f] = Count >= 3 ? (uint16)Count : 0;
             }
-        }
+        }), TexNamesTask));
     }
 
-    // Entities (text lump)
-    const FLumpInfo& LEnts = H.Lumps[0];
-    if (LEnts.Len > 0)
+    // Faces, pass 2: prefix sum into first-corner offsets and size the corner streams once
+    UE::Tasks::FTask FacePrefixTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_FacePrefix, [&]()
     {
-        FString EntText;
-        EntText.Reserve(LEnts.Len);
-        TArray<TCHAR> Buffer; Buffer.SetNumUninitialized(LEnts.Len + 1);
-        for (int32 i = 0; i < LEnts.Len; ++i)
+        uint32 Offset = 0;
+        for (int32 f = 0; f < NumFaces; ++f)
         {
-            Buffer[i] = (TCHAR)Bytes[LEnts.Ofs + i];
+            Geo.FaceFirstCorner[f] = Offset;
+            Offset += Geo.FaceNumCorners[f];
         }
-        Buffer[LEnts.Len] = 0;
-        EntText = FString(Buffer.GetData());
+        Geo.Indices.SetNumUninitialized(Offset);
+        Geo.UVs.SetNumUninitialized(Offset);
+        Geo.LightmapUVs.SetNumUninitialized(Offset);
+    }), FaceCountTasks);
 
-        TArray<FHL2Entity> Out;
-        TMap<FString, FString> KV;
-        auto Flush = [&]()
+    // Faces, pass 3: write each chunk's corners at its prefix-summed offsets
+    TArray<UE::Tasks::FTask> FaceFillTasks;
+    FaceFillTasks.Reserve(NumFaceChunks);
+    for (int32 Chunk = 0; Chunk < NumFaceChunks; ++Chunk)
+    {
+        FaceFillTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_FaceFill, [&, Chunk]()
         {
-            if (KV.Num() == 0) return;
-            FHL2Entity E;
-            KV.RemoveAndCopyValue(TEXT("targetname"), E.Name);
-            KV.RemoveAndCopyValue(TEXT("classname"), E.Class);
-            FString OriginStr; if (KV.RemoveAndCopyValue(TEXT("origin"), OriginStr))
+            const int32 End = FMath::Min(NumFaces, (Chunk + 1) * BspFaceChunkSize);
+            for (int32 f = Chunk * BspFaceChunkSize; f < End; ++f)
             {
-                TArray<FString> Parts; OriginStr.ParseIntoArrayWS(Parts);
-                if (Parts.Num() == 3)
+                if (Geo.FaceNumCorners[f] == 0) continue;
+                const DFace& DF = FacesSrc[f];
+                int32 Out = Geo.FaceFirstCorner[f];
+                for (int32 i = 0; i < DF.NumEdges; ++i)
                 {
-                    E.Origin = FVector(FCString::Atof(*Parts[0]), FCString::Atof(*Parts[1]), FCString::Atof(*Parts[2]));
+                    const int32 VIdx = ResolveCorner(DF.FirstEdge + i);
+                    if (VIdx == INDEX_NONE) continue;
+                    const FVector3f P(SrcVerts[VIdx].Pos[0], SrcVerts[VIdx].Pos[1], SrcVerts[VIdx].Pos[2]);
+                    Geo.Indices[Out] = VIdx;
+                    Geo.UVs[Out] = ComputeUV(P, DF.TexInfo);
+                    Geo.LightmapUVs[Out] = ComputeLightmapUV(P, DF.TexInfo);
+                    ++Out;
                 }
+                Geo.FaceTexture[f] = (DF.TexInfo >= 0 && DF.TexInfo < NumTexInfos) ? TexInfoTexture[DF.TexInfo] : 0;
             }
-            FString Angles; if (KV.RemoveAndCopyValue(TEXT("angles"), Angles))
+        }), UE::Tasks::Prerequisites(FacePrefixTask, TexNamesTask)));
+    }
+
+    // Displacements (optional)
+    UE::Tasks::FTask DispTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_Disp, [&]()
+    {
+        TConstArrayView<DDispInfo> Disp;
+        if (GetLumpView(BspLump::DispInfo, Disp))
+        {
+            DispInfos.Reserve(Disp.Num());
+            for (const DDispInfo& D : Disp)
             {
-                TArray<FString> A; Angles.ParseIntoArrayWS(A);
-                if (A.Num() == 3)
+                FDispInfo O; O.Power = D.Power; O.VertStart = D.DispVertStart; O.MapFace = (int32)D.MapFace;
+                O.StartPosition = FVector3f(D.StartPosition[0], D.StartPosition[1], D.StartPosition[2]);
+                auto AddNeighbor = [&O, NumDisps = Disp.Num()](uint16 Neighbor)
                 {
-                    E.Rotation = FRotator(FCString::Atof(*A[0]), FCString::Atof(*A[1]), FCString::Atof(*A[2]));
+                    if (Neighbor >= NumDisps) return;   // 0xFFFF = none
+                    for (int32 i = 0; i < O.NumNeighbors; ++i)
+                    {
+                        if (O.Neighbors[i] == Neighbor) return;
+                    }
+                    O.Neighbors[O.NumNeighbors++] = Neighbor;
+                };
+                for (const DDispNeighbor& Edge : D.EdgeNeighbors)
+                {
+                    AddNeighbor(Edge.Sub[0].Neighbor);
+                    AddNeighbor(Edge.Sub[1].Neighbor);
                 }
+                for (const DDispCornerNeighbors& Corner : D.CornerNeighbors)
+                {
+                    for (int32 i = 0; i < FMath::Min<int32>(Corner.NumNeighbors, 4); ++i)
+                    {
+                        AddNeighbor(Corner.Neighbors[i]);
+                    }
+                }
+                DispInfos.Add(O);
             }
-            KV.RemoveAndCopyValue(TEXT("model"), E.Model);
-            Out.Add(E);
-            KV.Reset();
-        };
-
-        const TCHAR* S = *EntText;
-        bool InEnt = false;
-        while (*S)
+        }
+        TConstArrayView<DDispVert> DV;
+        if (GetLumpView(BspLump::DispVerts, DV))
         {
-            // Skip whitespace
-            while (*S && (*S == TEXT(' ') || *S == TEXT('\t') || *S == TEXT('\r') || *S == TEXT('\n'))) ++S;
-            if (!*S) break;
-
-            if (!InEnt)
+            DispVerts.Reserve(DV.Num());
+            for (const DDispVert& V : DV)
             {
-                if (*S == TEXT('{')) { InEnt = true; KV.Reset(); ++S; continue; }
-                ++S; continue;
+                FDispVert Out; Out.Vector[0] = V.Vector[0]; Out.Vector[1] = V.Vector[1]; Out.Vector[2] = V.Vector[2];
+                Out.Dist = V.Dist; Out.Alpha = V.Alpha; DispVerts.Add(Out);
             }
-
-            if (*S == TEXT('}')) { Flush(); InEnt = false; ++S; continue; }
-
-            // Expect key
-            if (*S != TEXT('"')) { ++S; continue; }
-            ++S; const TCHAR* K0 = S; while (*S && *S != TEXT('"')) ++S; FString Key(S - K0, K0);
-            if (*S == TEXT('"')) ++S;
-            while (*S && (*S == TEXT(' ') || *S == TEXT('\t'))) ++S;
-            if (*S != TEXT('"')) { continue; }
-            ++S; const TCHAR* V0 = S; while (*S && *S != TEXT('"')) ++S; FString Val(S - V0, V0);
-            if (*S == TEXT('"')) ++S;
-            KV.Add(Key, Val);
         }
+    }));
+
+    UE::Tasks::FTask EntitiesTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_Entities, [&]()
+    {
+        TConstArrayView<uint8> EntBytes;
+        GetLumpView(BspLump::Entities, EntBytes);
+        EntityKeyValues.Parse(EntBytes);
+        BuildEntityRows(EntityKeyValues, Entities);
+    }));
+
+    UE::Tasks::FTask StaticPropsTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_StaticProps, [&]()
+    {
+        ParseStaticProps();
+    }));
 
-        Entities = MoveTemp(Out);
+    UE::Tasks::FTask TreeTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, Timed(DT_Tree, [&]()
+    {
+        Tree.Load(*this);
+    }));
+
+    UE::Tasks::Wait(FaceFillTasks);
+    UE::Tasks::Wait(TArray<UE::Tasks::FTask>{ PositionsTask, TexNamesTask, DispTask, EntitiesTask, StaticPropsTask, TreeTask });
+
+    for (int32 f = 0; f < NumFaces; ++f)
+    {
+        ++CullStats.Faces[(int32)FaceCull[f]];
+        CullStats.SkyFacesKept += (Geo.FaceFlags[f] & BspFaceFlags::Sky) ? 1 : 0;
+    }
+    CullStats.Faces[(int32)EBspCullReason::None] = 0;
+    if (Filter.bCullUnreachable)
+    {
+        CullUnreachableFaces();
     }
 
-    UE_LOG(LogHL2BSPImporter, Log, TEXT("BSP parsed: OutVerts=%d OutFaces=%d DispInfos=%d DispVerts=%d Entities=%d"),
-        Vertices.Num(), Faces.Num(), DispInfos.Num(), DispVerts.Num(), Entities.Num());
+    DecodeStats.WallMs = (FPlatformTime::Seconds() - DecodeStart) * 1000.0;
+    FString Timings;
+    for (int32 t = 0; t < DT_Num; ++t)
+    {
+        const double CpuMs = FPlatformTime::ToMilliseconds64(DecodeCycles[t].load());
+        DecodeStats.TaskCpuMs.Emplace(DecodeTaskNames[t], CpuMs);
+        Timings += FString::Printf(TEXT(" %s=%.2fms"), DecodeTaskNames[t], CpuMs);
+    }
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("BSP decode: Wall=%.2fms FaceChunks=%d Task CPU:%s"), DecodeStats.WallMs, NumFaceChunks, *Timings);
+
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("BSP parsed: Verts=%d Corners=%d Faces=%d Models=%d Textures=%d DispInfos=%d DispVerts=%d Entities=%d StaticProps=%d (models=%d)"),
+        Geometry.Positions.Num(), Geometry.NumCorners(), Geometry.NumFaces(), Models.Num(), Geometry.TextureNames.Num(), DispInfos.Num(), DispVerts.Num(), Entities.Num(),
+        StaticProps.Num(), StaticPropModels.Num());
+    if (CullStats.Total() > 0)
+    {
+        const int32* C = CullStats.Faces;
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("BSP face filter: Removed=%d (NoDraw=%d Sky=%d Skip=%d Hint=%d Trigger=%d ToolTexture=%d Unreachable=%d) SkyKept=%d"),
+            CullStats.Total(), C[(int32)EBspCullReason::NoDraw], C[(int32)EBspCullReason::Sky], C[(int32)EBspCullReason::Skip],
+            C[(int32)EBspCullReason::Hint], C[(int32)EBspCullReason::Trigger], C[(int32)EBspCullReason::ToolTexture], C[(int32)EBspCullReason::Unreachable],
+            CullStats.SkyFacesKept);
+    }
     return true;
 }
@@ -0,0 +1,286 @@
+#include "HL2BSPBatchImportCommandlet.h"
+#include "HL2BSPImporter.h"
+#include "HL2BSPImportPipeline.h"
+#include "HL2BSPImporterSettings.h"
+#include "HL2EntityTable.h"
+#include "HL2MaterialResolver.h"
+#include "HL2ImportReport.h"
+#include "HL2ChunkManifest.h"
+#include "HL2VisibilityData.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "ObjectTools.h"
+#include "Tasks/Task.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "UObject/UObjectGlobals.h"
+
+DECLARE_CYCLE_STAT(TEXT("Save Package"), STAT_HL2_SavePackage, STATGROUP_HL2BSPImporter);
+
+// One input file moving through the batch. Map is filled by a worker task and released once saved.
+struct FHL2BatchJob
+{
+    FString Filename;
+    TUniquePtr<FHL2PreparedMap> Map;
+    UE::Tasks::FTask Task;
+    double LaunchTime = 0.0;
+    bool bParsed = false;
+    bool bSaved = false;
+    int32 NumTris = 0;
+};
+
+static bool SaveAssetPackage(UObject* Asset)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_SavePackage);
+    UPackage* Package = Asset->GetOutermost();
+    const FString& Extension = Asset->IsA<UWorld>() ? FPackageName::GetMapPackageExtension() : FPackageName::GetAssetPackageExtension();
+    const FString PackageFile = FPackageName::LongPackageNameToFilename(Package->GetName(), Extension);
+    FSavePackageArgs SaveArgs;
+    SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+    SaveArgs.SaveFlags = SAVE_NoError;
+    const bool bOk = UPackage::SavePackage(Package, Asset, *PackageFile, SaveArgs);
+    if (!bOk)
+    {
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed to save %s to %s"), *Package->GetName(), *PackageFile);
+    }
+    return bOk;
+}
+
+static void CollectInputFiles(const FString& Input, bool bRecursive, TArray<FString>& OutFiles)
+{
+    if (FPaths::DirectoryExists(Input))
+    {
+        if (bRecursive)
+        {
+            IFileManager::Get().FindFilesRecursive(OutFiles, *Input, TEXT("*.bsp"), true, false);
+        }
+        else
+        {
+            TArray<FString> Names;
+            IFileManager::Get().FindFiles(Names, *(Input / TEXT("*.bsp")), true, false);
+            for (const FString& Name : Names)
+            {
+                OutFiles.Add(Input / Name);
+            }
+        }
+        OutFiles.Sort();
+    }
+    else if (FPaths::FileExists(Input))
+    {
+        OutFiles.Add(Input);
+    }
+}
+
+UHL2BSPBatchImportCommandlet::UHL2BSPBatchImportCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+    ShowErrorCount = true;
+}
+
+int32 UHL2BSPBatchImportCommandlet::Main(const FString& Params)
+{
+    TArray<FString> Tokens;
+    TArray<FString> Switches;
+    TMap<FString, FString> ParamVals;
+    ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+    const FString Input = ParamVals.FindRef(TEXT("input"));
+    FString Output = ParamVals.FindRef(TEXT("output"));
+    if (Output.IsEmpty())
+    {
+        Output = TEXT("/Game/Maps");
+    }
+    Output.RemoveFromEnd(TEXT("/"));
+    const bool bRecursive = Switches.Contains(TEXT("recursive"));
+    const int32 MaxInFlight = ParamVals.Contains(TEXT("jobs"))
+        ? FMath::Max(1, FCString::Atoi(*ParamVals[TEXT("jobs")]))
+        : FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+    if (Input.IsEmpty())
+    {
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("Usage: -run=HL2BSPBatchImport -input=<dir or .bsp> [-output=/Game/Maps] [-jobs=N] [-recursive]"));
+        return 1;
+    }
+    FText Reason;
+    if (!FPackageName::IsValidLongPackageName(Output / TEXT("Probe"), false, &Reason))
+    {
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("Invalid -output package path '%s': %s"), *Output, *Reason.ToString());
+        return 1;
+    }
+
+    TArray<FString> Files;
+    CollectInputFiles(Input, bRecursive, Files);
+    if (Files.Num() == 0)
+    {
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("No .bsp files found at %s"), *Input);
+        return 1;
+    }
+    UE_LOG(LogHL2BSPImporter, Display, TEXT("HL2BSPBatchImport: %d maps -> %s (jobs=%d)"), Files.Num(), *Output, MaxInFlight);
+
+    const double BatchStart = FPlatformTime::Seconds();
+    const UHL2BSPImporterSettings* Sets = GetDefault<UHL2BSPImporterSettings>();
+    // Parsed once for the whole batch; every map shares the same index
+    const TSharedRef<const FHL2MaterialIndex> MaterialIndex = FHL2MaterialResolver::GetIndex(Sets);
+
+    TArray<FHL2BatchJob> Jobs;
+    Jobs.SetNum(Files.Num());
+    auto LaunchJob = [&Jobs, Sets](int32 Index)
+    {
+        FHL2BatchJob& Job = Jobs[Index];
+        Job.Map = MakeUnique<FHL2PreparedMap>();
+        Job.LaunchTime = FPlatformTime::Seconds();
+        Job.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Job, Sets]()
+        {
+            Job.bParsed = ParseBSPMap(Job.Filename, Sets, *Job.Map);
+            if (Job.bParsed)
+            {
+                BuildBSPMapGeometry(*Job.Map, Sets);
+            }
+        });
+    };
+    for (int32 i = 0; i < Files.Num(); ++i)
+    {
+        Jobs[i].Filename = Files[i];
+    }
+
+    // Sliding window: at most MaxInFlight maps are parsed/built ahead of the game thread, which bounds memory
+    int32 NextLaunch = 0;
+    for (; NextLaunch < Jobs.Num() && NextLaunch < MaxInFlight; ++NextLaunch)
+    {
+        LaunchJob(NextLaunch);
+    }
+
+    FHL2ImportTimings Total;
+    double WaitSeconds = 0.0;
+    int32 NumFailed = 0;
+    for (int32 i = 0; i < Jobs.Num(); ++i)
+    {
+        FHL2BatchJob& Job = Jobs[i];
+        const double WaitStart = FPlatformTime::Seconds();
+        Job.Task.Wait();
+        WaitSeconds += FPlatformTime::Seconds() - WaitStart;
+        if (NextLaunch < Jobs.Num())
+        {
+            LaunchJob(NextLaunch++);
+        }
+
+        FHL2PreparedMap& Map = *Job.Map;
+        const FString MapName = ObjectTools::SanitizeObjectName(FPaths::GetBaseFilename(Job.Filename));
+        if (Job.bParsed)
+        {
+            const FString PackageName = Output / MapName;
+            UPackage* Package = CreatePackage(*PackageName);
+            Package->FullyLoad();
+
+            FHL2MaterialResolver Materials(MaterialIndex);
+            TArray<FName> UsedSlots = Map.SlotNames;
+            for (const FName& Slot : Map.SkySlotNames) UsedSlots.AddUnique(Slot);
+            for (const FHL2BrushModelGroup& Group : Map.BrushModels)
+            {
+                for (const FName& Slot : Group.SlotNames) UsedSlots.AddUnique(Slot);
+            }
+            Materials.RequestLoads(UsedSlots);
+            Job.NumTris = Map.BuildStats.Triangles;
+            // A chunked world saves its manifest under the map name and one package per chunk mesh
+            TArray<UStaticMesh*> ChunkMeshes;
+            UObject* Primary = nullptr;
+            if (Map.Chunks.Num() > 0)
+            {
+                Primary = CreateChunkedMeshesFromBSPMap(Map, Package, FName(*MapName), RF_Public | RF_Standalone, Materials, Sets, &ChunkMeshes);
+            }
+            else
+            {
+                Primary = CreateStaticMeshFromBSPMap(Map, Package, FName(*MapName), RF_Public | RF_Standalone, nullptr, Materials, Sets);
+            }
+            if (Primary)
+            {
+                const double SaveStart = FPlatformTime::Seconds();
+                Job.bSaved = SaveAssetPackage(Primary);
+                for (UStaticMesh* ChunkMesh : ChunkMeshes)
+                {
+                    Job.bSaved &= SaveAssetPackage(ChunkMesh);
+                    ChunkMesh->ClearFlags(RF_Standalone);
+                }
+                if (UHL2VisibilityData* Visibility = CreateVisibilityDataFromBSPMap(Map, Cast<UHL2ChunkManifest>(Primary), Sets, PackageName + TEXT("_Visibility")))
+                {
+                    Job.bSaved &= SaveAssetPackage(Visibility);
+                    Visibility->ClearFlags(RF_Standalone);
+                }
+                const FString SkyPackageName = PackageName + TEXT("_Sky");
+                if (UStaticMesh* Sky = CreateSkyMeshFromBSPMap(Map, CreatePackage(*SkyPackageName), FName(*(MapName + TEXT("_Sky"))), RF_Public | RF_Standalone, Materials, Sets))
+                {
+                    Job.bSaved &= SaveAssetPackage(Sky);
+                    Sky->ClearFlags(RF_Standalone);
+                }
+                TArray<UStaticMesh*> BrushMeshes;
+                if (UWorld* Brushes = CreateBrushEntitiesFromBSPMap(Map, PackageName, Materials, Sets, &BrushMeshes))
+                {
+                    Job.bSaved &= SaveAssetPackage(Brushes);
+                    Brushes->DestroyWorld(false);
+                    Brushes->ClearFlags(RF_Standalone);
+                }
+                for (UStaticMesh* BrushMesh : BrushMeshes)
+                {
+                    Job.bSaved &= SaveAssetPackage(BrushMesh);
+                    BrushMesh->ClearFlags(RF_Standalone);
+                }
+                for (UTexture2D* Lightmap : CreateLightmapTexturesFromBSPMap(Map, PackageName))
+                {
+                    Job.bSaved &= SaveAssetPackage(Lightmap);
+                    Lightmap->ClearFlags(RF_Standalone);
+                }
+                if (UWorld* Props = CreatePropWorldFromBSPMap(Map, PackageName + TEXT("_Props")))
+                {
+                    Job.bSaved &= SaveAssetPackage(Props);
+                    Props->DestroyWorld(false);
+                    Props->ClearFlags(RF_Standalone);
+                }
+                if (UHL2EntityTable* Table = CreateEntityTableFromBSPMap(Map, PackageName + TEXT("_Entities")))
+                {
+                    Job.bSaved &= SaveAssetPackage(Table);
+                    Table->ClearFlags(RF_Standalone);
+                }
+                Map.Timings.Save = FPlatformTime::Seconds() - SaveStart;
+                Primary->ClearFlags(RF_Standalone);
+                if (Sets->bWriteImportReport)
+                {
+                    // Wall time includes any wait in the job window, so it is comparable across -jobs settings
+                    WriteImportReport(Map, PackageName, FPlatformTime::Seconds() - Job.LaunchTime);
+                }
+            }
+        }
+        if (!Job.bSaved)
+        {
+            ++NumFailed;
+        }
+
+        UE_LOG(LogHL2BSPImporter, Display, TEXT("[%d/%d] %s: %s Parse=%.1fms Build=%.1fms Normals=%.1fms MeshBuild=%.1fms Save=%.1fms Tris=%d"),
+            i + 1, Jobs.Num(), *MapName, Job.bSaved ? TEXT("OK") : TEXT("FAILED"),
+            Map.Timings.Parse * 1000.0, Map.Timings.Build * 1000.0, Map.Timings.Normals * 1000.0, Map.Timings.MeshBuild * 1000.0, Map.Timings.Save * 1000.0, Job.NumTris);
+
+        Total.Parse += Map.Timings.Parse;
+        Total.Build += Map.Timings.Build;
+        Total.Normals += Map.Timings.Normals;
+        Total.MeshBuild += Map.Timings.MeshBuild;
+        Total.Save += Map.Timings.Save;
+
+        // Saved assets are no longer standalone; drop the prepared data and let GC reclaim the objects
+        Job.Map.Reset();
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+    }
+
+    const double WallSeconds = FPlatformTime::Seconds() - BatchStart;
+    UE_LOG(LogHL2BSPImporter, Display, TEXT("HL2BSPBatchImport summary: Maps=%d OK=%d Failed=%d Wall=%.2fs Jobs=%d"),
+        Jobs.Num(), Jobs.Num() - NumFailed, NumFailed, WallSeconds, MaxInFlight);
+    UE_LOG(LogHL2BSPImporter, Display, TEXT("  Workers (summed): Parse=%.2fs Build=%.2fs Normals=%.2fs"), Total.Parse, Total.Build, Total.Normals);
+    UE_LOG(LogHL2BSPImporter, Display, TEXT("  Game thread:      MeshBuild=%.2fs Save=%.2fs WaitingOnWorkers=%.2fs"), Total.MeshBuild, Total.Save, WaitSeconds);
+    return NumFailed > 0 ? 1 : 0;
+}
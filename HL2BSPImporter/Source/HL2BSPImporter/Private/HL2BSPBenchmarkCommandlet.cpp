@@ -0,0 +1,495 @@
+#include "HL2BSPBenchmarkCommandlet.h"
+#include "HL2BSPImporter.h"
+#include "HL2BSPImportPipeline.h"
+#include "HL2BSPImporterSettings.h"
+#include "HL2SyntheticBsp.h"
+#include "HL2BrushCollision.h"
+#include "HL2BspTree.h"
+#include "HL2CoordTransform.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Components/StaticMeshComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Physics/Experimental/ChaosCooking.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "Math/RandomStream.h"
+#include "Materials/Material.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+// Per-stage samples of one configuration, in milliseconds
+struct FHL2BenchSamples
+{
+    TArray<double> Load, Build, Normals, MeshBuild;
+    TArray<double> BuildHulls, CookComplex, CookHulls, TraceComplex, TraceHulls;
+    TArray<double> TreePoints, TreePointsBatch, TreeTraces, TreeTracesBatch, TreeMeshTraces;
+};
+
+// Result of one collision pass: both modes on the same mesh and rays
+struct FHL2CollisionSample
+{
+    double BuildHullsMs = 0.0;
+    double CookComplexMs = 0.0;
+    double CookHullsMs = 0.0;
+    double TraceComplexMs = 0.0;
+    double TraceHullsMs = 0.0;
+    int32 NumHulls = 0;
+    int32 HitsComplex = 0;
+    int32 HitsHulls = 0;
+};
+
+// Result of one tree pass: FHL2BspTree queries against mesh line traces, on the same rays
+struct FHL2TreeSample
+{
+    double PointsMs = 0.0;
+    double PointsBatchMs = 0.0;
+    double TracesMs = 0.0;
+    double TracesBatchMs = 0.0;
+    double MeshTracesMs = 0.0;
+    int32 SolidPoints = 0;       // ray starts inside a solid leaf
+    int32 HitsTree = 0;
+    int32 HitsMesh = 0;
+};
+
+static TArray<int32> ParseIntList(const TMap<FString, FString>& ParamVals, const TCHAR* Key, int32 Default)
+{
+    TArray<int32> Values;
+    if (const FString* Str = ParamVals.Find(Key))
+    {
+        TArray<FString> Parts;
+        Str->ParseIntoArray(Parts, TEXT(","));
+        for (const FString& Part : Parts)
+        {
+            Values.Add(FCString::Atoi(*Part));
+        }
+    }
+    if (Values.Num() == 0)
+    {
+        Values.Add(Default);
+    }
+    return Values;
+}
+
+static double MedianOf(TArray<double> Samples)
+{
+    if (Samples.Num() == 0) return 0.0;
+    Samples.Sort();
+    const int32 Mid = Samples.Num() / 2;
+    return (Samples.Num() & 1) ? Samples[Mid] : 0.5 * (Samples[Mid - 1] + Samples[Mid]);
+}
+
+static TSharedRef<FJsonObject> MakeStageJson(TArray<double> Samples)
+{
+    TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+    if (Samples.Num() == 0) return Obj;
+    Samples.Sort();
+    double Sum = 0.0;
+    for (double S : Samples) Sum += S;
+    Obj->SetNumberField(TEXT("min_ms"), Samples[0]);
+    Obj->SetNumberField(TEXT("median_ms"), MedianOf(Samples));
+    Obj->SetNumberField(TEXT("mean_ms"), Sum / Samples.Num());
+    Obj->SetNumberField(TEXT("max_ms"), Samples.Last());
+    return Obj;
+}
+
+// Chaos cook of the body setup as it is configured (no DDC, so every sample is a real cook), in milliseconds
+static double TimeCook(UBodySetup* Body)
+{
+    const double Start = FPlatformTime::Seconds();
+    Chaos::FCookHelper Cooker(Body);
+    Cooker.Cook();
+    return (FPlatformTime::Seconds() - Start) * 1000.0;
+}
+
+// NumRays fixed-seed segments starting inside Bounds, each as long as its diagonal, in random directions
+static void MakeBenchRays(const FBox& Bounds, int32 NumRays, TArray<FVector>& OutFrom, TArray<FVector>& OutTo)
+{
+    const double Length = Bounds.GetSize().Size();
+    FRandomStream Rng(1234);
+    OutFrom.SetNumUninitialized(NumRays);
+    OutTo.SetNumUninitialized(NumRays);
+    for (int32 i = 0; i < NumRays; ++i)
+    {
+        OutFrom[i] = FVector(Rng.FRandRange(Bounds.Min.X, Bounds.Max.X), Rng.FRandRange(Bounds.Min.Y, Bounds.Max.Y), Rng.FRandRange(Bounds.Min.Z, Bounds.Max.Z));
+        OutTo[i] = OutFrom[i] + Rng.VRand() * Length;
+    }
+}
+
+// Total time of NumTraces line traces from MakeBenchRays through Mesh's bounds, placed in a throwaway world, in milliseconds
+static double TimeLineTraces(UStaticMesh* Mesh, int32 NumTraces, int32& OutHits)
+{
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    AStaticMeshActor* Actor = World->SpawnActorDeferred<AStaticMeshActor>(AStaticMeshActor::StaticClass(), FTransform::Identity);
+    Actor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+    Actor->FinishSpawning(FTransform::Identity);
+    if (FPhysScene* Scene = World->GetPhysicsScene())
+    {
+        Scene->Flush();
+    }
+
+    TArray<FVector> From, To;
+    MakeBenchRays(Mesh->GetBoundingBox(), NumTraces, From, To);
+    OutHits = 0;
+    const double Start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumTraces; ++i)
+    {
+        FHitResult Hit;
+        OutHits += World->LineTraceSingleByChannel(Hit, From[i], To[i], ECC_WorldStatic) ? 1 : 0;
+    }
+    const double Ms = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+    World->DestroyWorld(false);
+    World->RemoveFromRoot();
+    return Ms;
+}
+
+// The map's node/leaf tree as a spatial index: point-in-leaf and ray queries, one at a time and batched, against
+// complex-as-simple line traces of the built mesh along the same rays. The tree answers against solid brushes, the
+// mesh against rendered faces only, so hit counts are close but not equal.
+static FHL2TreeSample BenchmarkTree(UStaticMesh* Mesh, const FHL2PreparedMap& Map, const UHL2BSPImporterSettings* Sets, int32 NumQueries)
+{
+    FHL2TreeSample Sample;
+    const FHL2BspTree& Tree = Map.Bsp.GetTree();
+
+    // Tree queries are in Source space: bring the Unreal-space rays back through the inverse import transform
+    const FHL2CoordTransform Xform = FHL2CoordTransform::FromSettings(Sets);
+    FMatrix44f ToUnreal = FMatrix44f::Identity;
+    for (int32 r = 0; r < 3; ++r)
+    {
+        ToUnreal.M[0][r] = Xform.Rows[r].X;
+        ToUnreal.M[1][r] = Xform.Rows[r].Y;
+        ToUnreal.M[2][r] = Xform.Rows[r].Z;
+        ToUnreal.M[3][r] = Xform.Rows[r].W;
+    }
+    const FMatrix44f ToSource = ToUnreal.Inverse();
+    TArray<FVector> From, To;
+    MakeBenchRays(Mesh->GetBoundingBox(), NumQueries, From, To);
+    TArray<FVector3f> Points;
+    TArray<FHL2BspRay> Rays;
+    Points.SetNumUninitialized(NumQueries);
+    Rays.SetNumUninitialized(NumQueries);
+    for (int32 i = 0; i < NumQueries; ++i)
+    {
+        Points[i] = Rays[i].Start = FVector3f(ToSource.TransformPosition(FVector3f(From[i])));
+        Rays[i].End = FVector3f(ToSource.TransformPosition(FVector3f(To[i])));
+    }
+
+    TArray<int32> Leaves;
+    Leaves.SetNumUninitialized(NumQueries);
+    double Start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumQueries; ++i)
+    {
+        Leaves[i] = Tree.PointInLeaf(Points[i]);
+    }
+    Sample.PointsMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+    Start = FPlatformTime::Seconds();
+    Tree.PointInLeafBatch(Points, Leaves);
+    Sample.PointsBatchMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+    for (int32 Leaf : Leaves)
+    {
+        Sample.SolidPoints += Leaf != INDEX_NONE && (Tree.Leafs[Leaf].Contents & FHL2BspTree::DefaultContentsMask) ? 1 : 0;
+    }
+
+    TArray<FHL2BspTraceResult> Results;
+    Results.SetNum(NumQueries);
+    Start = FPlatformTime::Seconds();
+    for (int32 i = 0; i < NumQueries; ++i)
+    {
+        Tree.TraceRay(Rays[i].Start, Rays[i].End, Results[i]);
+    }
+    Sample.TracesMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+    Start = FPlatformTime::Seconds();
+    Tree.TraceRayBatch(Rays, Results);
+    Sample.TracesBatchMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+    for (const FHL2BspTraceResult& Result : Results)
+    {
+        Sample.HitsTree += Result.bHit ? 1 : 0;
+    }
+
+    Mesh->CreateBodySetup();
+    UBodySetup* Body = Mesh->GetBodySetup();
+    Body->RemoveSimpleCollision();
+    Body->CollisionTraceFlag = CTF_UseComplexAsSimple;
+    Body->InvalidatePhysicsData();
+    Body->CreatePhysicsMeshes();
+    Sample.MeshTracesMs = TimeLineTraces(Mesh, NumQueries, Sample.HitsMesh);
+    return Sample;
+}
+
+// Brush hulls against complex-as-simple on a built mesh: generation, cook and query cost
+static FHL2CollisionSample BenchmarkCollision(UStaticMesh* Mesh, const FHL2PreparedMap& Map, const UHL2BSPImporterSettings* Sets, int32 NumTraces)
+{
+    FHL2CollisionSample Sample;
+    TArray<FHL2BrushHull> Hulls;
+    FHL2BrushCollisionStats Stats;
+    BuildBrushHulls(Map.Bsp, FHL2CoordTransform::FromSettings(Sets), ~0u, Hulls, Stats);
+    Sample.BuildHullsMs = Stats.Seconds * 1000.0;
+    Sample.NumHulls = Hulls.Num();
+
+    Mesh->CreateBodySetup();
+    UBodySetup* Body = Mesh->GetBodySetup();
+    Body->RemoveSimpleCollision();
+    Body->CollisionTraceFlag = CTF_UseComplexAsSimple;
+    Sample.CookComplexMs = TimeCook(Body);
+    Body->InvalidatePhysicsData();
+    Body->CreatePhysicsMeshes();
+    Sample.TraceComplexMs = TimeLineTraces(Mesh, NumTraces, Sample.HitsComplex);
+
+    if (Hulls.Num() > 0)
+    {
+        ApplyBrushHulls(Body, Hulls);
+        Sample.CookHullsMs = TimeCook(Body);
+        Sample.TraceHullsMs = TimeLineTraces(Mesh, NumTraces, Sample.HitsHulls);
+    }
+    return Sample;
+}
+
+UHL2BSPBenchmarkCommandlet::UHL2BSPBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UHL2BSPBenchmarkCommandlet::Main(const FString& Params)
+{
+    TArray<FString> Tokens;
+    TArray<FString> Switches;
+    TMap<FString, FString> ParamVals;
+    ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+    const FHL2SyntheticBspParams Defaults;
+    const TArray<int32> FaceCounts = ParseIntList(ParamVals, TEXT("faces"), Defaults.NumFaces);
+    const TArray<int32> SideCounts = ParseIntList(ParamVals, TEXT("sides"), Defaults.SidesPerFace);
+    const TArray<int32> DispCounts = ParseIntList(ParamVals, TEXT("disps"), Defaults.NumDisplacements);
+    const TArray<int32> DispPowers = ParseIntList(ParamVals, TEXT("power"), Defaults.DispPower);
+    const TArray<int32> EntityCounts = ParseIntList(ParamVals, TEXT("entities"), Defaults.NumEntities);
+    const TArray<int32> TextureCounts = ParseIntList(ParamVals, TEXT("textures"), Defaults.NumTextures);
+    const int32 Iterations = FMath::Max(1, ParseIntList(ParamVals, TEXT("iterations"), 5)[0]);
+    const int32 Warmup = FMath::Max(0, ParseIntList(ParamVals, TEXT("warmup"), 1)[0]);
+    const bool bSkipMeshBuild = Switches.Contains(TEXT("skipmeshbuild"));
+    // Collision needs the built mesh (render data for the trimesh, bounds for the rays)
+    const bool bCollision = Switches.Contains(TEXT("collision")) && !bSkipMeshBuild;
+    const int32 NumTraces = FMath::Max(1, ParseIntList(ParamVals, TEXT("traces"), 10000)[0]);
+    // Tree queries are compared with traces against the built mesh
+    const bool bTree = Switches.Contains(TEXT("tree")) && !bSkipMeshBuild;
+    const int32 NumQueries = FMath::Max(1, ParseIntList(ParamVals, TEXT("queries"), 10000)[0]);
+
+    const FString WorkDir = FPaths::ProjectSavedDir() / TEXT("HL2BSPBenchmark");
+    const FString JsonPath = ParamVals.Contains(TEXT("json")) ? ParamVals[TEXT("json")] : WorkDir / TEXT("results.json");
+    const UHL2BSPImporterSettings* Sets = GetDefault<UHL2BSPImporterSettings>();
+    UMaterialInterface* DefaultMaterial = UMaterial::GetDefaultMaterial(static_cast<EMaterialDomain>(0));
+
+    TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+    Root->SetNumberField(TEXT("schema"), 1);
+    Root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+    Root->SetStringField(TEXT("engine"), FEngineVersion::Current().ToString());
+    Root->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+    Root->SetStringField(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+    Root->SetNumberField(TEXT("logical_cores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+    Root->SetNumberField(TEXT("iterations"), Iterations);
+    Root->SetNumberField(TEXT("warmup"), Warmup);
+    Root->SetBoolField(TEXT("nanite"), Sets->bBuildNanite);
+    if (bCollision)
+    {
+        Root->SetNumberField(TEXT("traces"), NumTraces);
+    }
+    if (bTree)
+    {
+        Root->SetNumberField(TEXT("queries"), NumQueries);
+    }
+    TArray<TSharedPtr<FJsonValue>> Results;
+
+    int32 NumFailed = 0;
+    for (int32 Faces : FaceCounts)
+    for (int32 Sides : SideCounts)
+    for (int32 Disps : DispCounts)
+    for (int32 Power : DispPowers)
+    for (int32 Entities : EntityCounts)
+    for (int32 Textures : TextureCounts)
+    {
+        FHL2SyntheticBspParams Gen;
+        Gen.NumFaces = Faces;
+        Gen.SidesPerFace = Sides;
+        Gen.NumDisplacements = Disps;
+        Gen.DispPower = Power;
+        Gen.NumEntities = Entities;
+        Gen.NumTextures = Textures;
+
+        const FString Name = FString::Printf(TEXT("synthetic_f%d_s%d_d%d_p%d_e%d_t%d"), Faces, Sides, Disps, Power, Entities, Textures);
+        const FString BspPath = WorkDir / (Name + TEXT(".bsp"));
+        TArray<uint8> Bytes;
+        const double GenStart = FPlatformTime::Seconds();
+        GenerateSyntheticBsp(Gen, Bytes);
+        const double GenMs = (FPlatformTime::Seconds() - GenStart) * 1000.0;
+        if (!FFileHelper::SaveArrayToFile(Bytes, *BspPath))
+        {
+            UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed to write %s"), *BspPath);
+            ++NumFailed;
+            continue;
+        }
+
+        FHL2BenchSamples Samples;
+        int32 NumVerts = 0, NumTris = 0, NumSlots = 0;
+        FHL2CollisionSample Collision;
+        FHL2TreeSample TreeSample;
+        int32 NumNodes = 0, NumLeafs = 0;
+        bool bOk = true;
+        for (int32 It = 0; It < Warmup + Iterations && bOk; ++It)
+        {
+            FHL2PreparedMap Map;
+            bOk = ParseBSPMap(BspPath, Sets, Map);
+            if (!bOk) break;
+            BuildBSPMapGeometry(Map, Sets);
+
+            double MeshBuildSeconds = 0.0;
+            if (!bSkipMeshBuild)
+            {
+                UStaticMesh* Mesh = NewObject<UStaticMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+                for (const FName& Slot : Map.SlotNames)
+                {
+                    Mesh->GetStaticMaterials().Add(FStaticMaterial(DefaultMaterial, Slot));
+                }
+                Mesh->NaniteSettings.bEnabled = Sets->bBuildNanite;
+                TArray<const FMeshDescription*> Descs; Descs.Add(&Map.MeshDescription);
+                for (const FMeshDescription& LOD : Map.LODMeshDescriptions)
+                {
+                    Descs.Add(&LOD);
+                }
+                const double Start = FPlatformTime::Seconds();
+                Mesh->BuildFromMeshDescriptions(Descs);
+                MeshBuildSeconds = FPlatformTime::Seconds() - Start;
+                // Before collision, which leaves brush hulls on the body
+                if (bTree)
+                {
+                    TreeSample = BenchmarkTree(Mesh, Map, Sets, NumQueries);
+                }
+                if (bCollision)
+                {
+                    Collision = BenchmarkCollision(Mesh, Map, Sets, NumTraces);
+                }
+                Mesh->MarkAsGarbage();
+                CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+            }
+
+            NumVerts = Map.MeshDescription.Vertices().Num();
+            NumTris = Map.MeshDescription.Triangles().Num();
+            NumSlots = Map.SlotNames.Num();
+            NumNodes = Map.Bsp.GetTree().Nodes.Num();
+            NumLeafs = Map.Bsp.GetTree().Leafs.Num();
+            if (It < Warmup) continue;
+            Samples.Load.Add(Map.Timings.Parse * 1000.0);
+            Samples.Build.Add(Map.Timings.Build * 1000.0);
+            Samples.Normals.Add(Map.Timings.Normals * 1000.0);
+            if (!bSkipMeshBuild) Samples.MeshBuild.Add(MeshBuildSeconds * 1000.0);
+            if (bCollision)
+            {
+                Samples.BuildHulls.Add(Collision.BuildHullsMs);
+                Samples.CookComplex.Add(Collision.CookComplexMs);
+                Samples.CookHulls.Add(Collision.CookHullsMs);
+                Samples.TraceComplex.Add(Collision.TraceComplexMs);
+                Samples.TraceHulls.Add(Collision.TraceHullsMs);
+            }
+            if (bTree)
+            {
+                Samples.TreePoints.Add(TreeSample.PointsMs);
+                Samples.TreePointsBatch.Add(TreeSample.PointsBatchMs);
+                Samples.TreeTraces.Add(TreeSample.TracesMs);
+                Samples.TreeTracesBatch.Add(TreeSample.TracesBatchMs);
+                Samples.TreeMeshTraces.Add(TreeSample.MeshTracesMs);
+            }
+        }
+        if (!bOk)
+        {
+            UE_LOG(LogHL2BSPImporter, Error, TEXT("Benchmark %s: generated file failed to load"), *Name);
+            ++NumFailed;
+            continue;
+        }
+
+        TSharedRef<FJsonObject> Config = MakeShared<FJsonObject>();
+        Config->SetNumberField(TEXT("faces"), Faces);
+        Config->SetNumberField(TEXT("sides"), Sides);
+        Config->SetNumberField(TEXT("displacements"), Disps);
+        Config->SetNumberField(TEXT("disp_power"), Power);
+        Config->SetNumberField(TEXT("entities"), Entities);
+        Config->SetNumberField(TEXT("textures"), Textures);
+
+        TSharedRef<FJsonObject> Stages = MakeShared<FJsonObject>();
+        Stages->SetObjectField(TEXT("load"), MakeStageJson(Samples.Load));
+        Stages->SetObjectField(TEXT("build_mesh_description"), MakeStageJson(Samples.Build));
+        Stages->SetObjectField(TEXT("normals_tangents"), MakeStageJson(Samples.Normals));
+        if (!bSkipMeshBuild)
+        {
+            Stages->SetObjectField(TEXT("build_from_mesh_descriptions"), MakeStageJson(Samples.MeshBuild));
+        }
+
+        TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+        Result->SetStringField(TEXT("name"), Name);
+        Result->SetObjectField(TEXT("config"), Config);
+        Result->SetNumberField(TEXT("file_bytes"), Bytes.Num());
+        Result->SetNumberField(TEXT("generate_ms"), GenMs);
+        Result->SetNumberField(TEXT("mesh_vertices"), NumVerts);
+        Result->SetNumberField(TEXT("mesh_triangles"), NumTris);
+        Result->SetNumberField(TEXT("material_slots"), NumSlots);
+        Result->SetObjectField(TEXT("stages"), Stages);
+        if (bCollision)
+        {
+            TSharedRef<FJsonObject> CollisionObj = MakeShared<FJsonObject>();
+            CollisionObj->SetNumberField(TEXT("brush_hulls"), Collision.NumHulls);
+            CollisionObj->SetObjectField(TEXT("build_brush_hulls"), MakeStageJson(Samples.BuildHulls));
+            CollisionObj->SetObjectField(TEXT("cook_complex_as_simple"), MakeStageJson(Samples.CookComplex));
+            CollisionObj->SetObjectField(TEXT("cook_brush_hulls"), MakeStageJson(Samples.CookHulls));
+            CollisionObj->SetObjectField(TEXT("traces_complex_as_simple"), MakeStageJson(Samples.TraceComplex));
+            CollisionObj->SetObjectField(TEXT("traces_brush_hulls"), MakeStageJson(Samples.TraceHulls));
+            CollisionObj->SetNumberField(TEXT("hits_complex_as_simple"), Collision.HitsComplex);
+            CollisionObj->SetNumberField(TEXT("hits_brush_hulls"), Collision.HitsHulls);
+            Result->SetObjectField(TEXT("collision"), CollisionObj);
+            UE_LOG(LogHL2BSPImporter, Display, TEXT("%s collision: Hulls=%d build=%.2fms cook complex=%.2fms hulls=%.2fms, %d traces complex=%.2fms hulls=%.2fms (median)"),
+                *Name, Collision.NumHulls, MedianOf(Samples.BuildHulls), MedianOf(Samples.CookComplex), MedianOf(Samples.CookHulls),
+                NumTraces, MedianOf(Samples.TraceComplex), MedianOf(Samples.TraceHulls));
+        }
+        if (bTree)
+        {
+            TSharedRef<FJsonObject> TreeObj = MakeShared<FJsonObject>();
+            TreeObj->SetNumberField(TEXT("nodes"), NumNodes);
+            TreeObj->SetNumberField(TEXT("leafs"), NumLeafs);
+            TreeObj->SetObjectField(TEXT("point_in_leaf"), MakeStageJson(Samples.TreePoints));
+            TreeObj->SetObjectField(TEXT("point_in_leaf_batch"), MakeStageJson(Samples.TreePointsBatch));
+            TreeObj->SetObjectField(TEXT("trace_ray"), MakeStageJson(Samples.TreeTraces));
+            TreeObj->SetObjectField(TEXT("trace_ray_batch"), MakeStageJson(Samples.TreeTracesBatch));
+            TreeObj->SetObjectField(TEXT("traces_complex_as_simple"), MakeStageJson(Samples.TreeMeshTraces));
+            TreeObj->SetNumberField(TEXT("solid_points"), TreeSample.SolidPoints);
+            TreeObj->SetNumberField(TEXT("hits_tree"), TreeSample.HitsTree);
+            TreeObj->SetNumberField(TEXT("hits_complex_as_simple"), TreeSample.HitsMesh);
+            Result->SetObjectField(TEXT("tree"), TreeObj);
+            UE_LOG(LogHL2BSPImporter, Display, TEXT("%s tree: Nodes=%d Leafs=%d, %d queries point=%.2fms batch=%.2fms trace=%.2fms batch=%.2fms mesh traces=%.2fms (median), hits tree=%d mesh=%d"),
+                *Name, NumNodes, NumLeafs, NumQueries, MedianOf(Samples.TreePoints), MedianOf(Samples.TreePointsBatch), MedianOf(Samples.TreeTraces),
+                MedianOf(Samples.TreeTracesBatch), MedianOf(Samples.TreeMeshTraces), TreeSample.HitsTree, TreeSample.HitsMesh);
+        }
+        Results.Add(MakeShared<FJsonValueObject>(Result));
+
+        UE_LOG(LogHL2BSPImporter, Display, TEXT("%s: Load=%.2fms Build=%.2fms Normals=%.2fms MeshBuild=%.2fms (median of %d) Tris=%d"),
+            *Name, MedianOf(Samples.Load), MedianOf(Samples.Build), MedianOf(Samples.Normals), MedianOf(Samples.MeshBuild), Iterations, NumTris);
+    }
+    Root->SetArrayField(TEXT("results"), Results);
+
+    FString JsonText;
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonText);
+    FJsonSerializer::Serialize(Root, Writer);
+    if (!FFileHelper::SaveStringToFile(JsonText, *JsonPath))
+    {
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed to write benchmark results: %s"), *JsonPath);
+        return 1;
+    }
+    UE_LOG(LogHL2BSPImporter, Display, TEXT("HL2BSPBenchmark: %d configurations, results written to %s"), Results.Num(), *JsonPath);
+    return NumFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,703 @@
+#include "HL2BSPImportPipeline.h"
+#include "HL2BSPImporter.h"
+#include "HL2BSPMeshBuilder.h"
+#include "HL2BSPImporterSettings.h"
+#include "HL2EntityTable.h"
+#include "HL2MaterialResolver.h"
+#include "HL2CoordTransform.h"
+#include "HL2ChunkManifest.h"
+#include "HL2MaterialSlots.h"
+#include "HL2VisibilityData.h"
+#include "Async/ParallelFor.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "Engine/Texture2D.h"
+#include "StaticMeshAttributes.h"
+#include "Materials/Material.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "UObject/Package.h"
+#include "Misc/PackageName.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformMemory.h"
+
+// Import stages shared by the editor factory and the batch commandlet.
+
+DECLARE_CYCLE_STAT(TEXT("Parse Map"), STAT_HL2_ParseMap, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Build MeshDescription"), STAT_HL2_BuildMesh, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Build Static Mesh"), STAT_HL2_MeshBuild, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Entity Table"), STAT_HL2_EntityTable, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Brush Model Meshes"), STAT_HL2_BrushModelMeshes, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Static Props"), STAT_HL2_StaticProps, STATGROUP_HL2BSPImporter);
+
+static uint64 SampleUsedPhysical()
+{
+    return FPlatformMemory::GetStats().UsedPhysical;
+}
+
+FBspFaceFilter MakeBSPFaceFilter(const UHL2BSPImporterSettings* Sets)
+{
+    FBspFaceFilter Filter;
+    if (!Sets) return Filter;
+    Filter.CullSurfaceFlags = (Sets->bCullNoDraw ? BspSurf::NoDraw : 0)
+        | (Sets->bCullSky ? (BspSurf::Sky | BspSurf::Sky2D) : 0)
+        | (Sets->bCullSkip ? BspSurf::Skip : 0)
+        | (Sets->bCullHint ? BspSurf::Hint : 0)
+        | (Sets->bCullTrigger ? BspSurf::Trigger : 0);
+    Filter.bKeepSky = Sets->bCullSky && Sets->bImportSkyAsSeparateMesh;
+    Filter.bCullUnreachable = Sets->bCullUnreachableFaces;
+    for (const FString& Prefix : Sets->CulledTexturePrefixes)
+    {
+        FString Key = Prefix.TrimStartAndEnd().ToLower();
+        Key.ReplaceCharInline(TEXT('\\'), TEXT('/'));
+        if (!Key.IsEmpty())
+        {
+            Filter.CullTexturePrefixes.AddUnique(MoveTemp(Key));
+        }
+    }
+    return Filter;
+}
+
+bool ParseBSPMap(const FString& Filename, const UHL2BSPImporterSettings* Sets, FHL2PreparedMap& Map)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_ParseMap);
+    const double Start = FPlatformTime::Seconds();
+    Map.Filename = Filename;
+    const bool bOpened = Map.Bsp.Open(Filename);
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Probe open: %s (bytes=%d mapped=%s)"), bOpened ? TEXT("OK") : TEXT("FAILED"), Map.Bsp.GetRawData().Num(), Map.Bsp.IsMapped() ? TEXT("true") : TEXT("false"));
+    const bool bOk = bOpened && Map.Bsp.Parse(MakeBSPFaceFilter(Sets));
+    Map.Timings.Parse = FPlatformTime::Seconds() - Start;
+    Map.Memory.AfterParse = SampleUsedPhysical();
+    if (!bOk)
+    {
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("Failed to load BSP from file: %s"), *Filename);
+    }
+    return bOk;
+}
+
+uint32 MakeCollisionGroupMask(const UHL2BSPImporterSettings* Sets)
+{
+    uint32 Mask = 1u << (uint32)EHL2CollisionGroup::Solid;
+    if (Sets->bCollideWindows) Mask |= 1u << (uint32)EHL2CollisionGroup::Window;
+    if (Sets->bCollideGrates) Mask |= 1u << (uint32)EHL2CollisionGroup::Grate;
+    if (Sets->bCollidePlayerClip) Mask |= 1u << (uint32)EHL2CollisionGroup::PlayerClip;
+    if (Sets->bCollideMonsterClip) Mask |= 1u << (uint32)EHL2CollisionGroup::MonsterClip;
+    return Mask;
+}
+
+static FIntPoint GetChunkCell(const FVector3f& P, float CellSize)
+{
+    return FIntPoint(FMath::FloorToInt(P.X / CellSize), FMath::FloorToInt(P.Y / CellSize));
+}
+
+// Number of displacement LODs a mesh with DispsBuilt displacements gets: none with Nanite, otherwise one per configured
+// screen size, but no more than the highest displacement power (past that every grid is a single cell)
+// Grid chunks get none: each chunk switches LOD on its own screen size, so a displacement stitched across a chunk
+// seam would crack wherever its two sides show different powers.
+static int32 GetNumDisplacementLODs(const FBspFile& Bsp, const UHL2BSPImporterSettings* Sets, int32 DispsBuilt)
+{
+    if (Sets->bBuildNanite || Sets->ChunkMode == EHL2ChunkMode::Grid || DispsBuilt == 0)
+    {
+        return 0;
+    }
+    int32 MaxPower = 0;
+    for (const FDispInfo& Info : Bsp.GetDispInfos())
+    {
+        MaxPower = FMath::Max(MaxPower, Info.Power);
+    }
+    return FMath::Min3(Sets->DisplacementLODScreenSizes.Num(), MaxPower, MAX_STATIC_MESH_LODS - 1);
+}
+
+// Grid chunking: faces go to the cell of their centroid (in Unreal space), then every occupied cell is built as
+// its own MeshDescription, cells in parallel. Brush hulls follow their centre,
+// or the nearest occupied cell if theirs has no faces. WorldFaces, when given, limits the faces considered.
+static void BuildChunkedGeometry(FHL2PreparedMap& Map, const UHL2BSPImporterSettings* Sets, const TBitArray<>* WorldFaces)
+{
+    const FBspGeometry& Geo = Map.Bsp.GetGeometry();
+    const FHL2CoordTransform Xform = FHL2CoordTransform::FromSettings(Sets);
+    const float CellSize = FMath::Max(100.f, Sets->ChunkCellSize);
+
+    TMap<FIntPoint, int32> CellToChunk;
+    TArray<int32> FaceChunk;
+    FaceChunk.Init(INDEX_NONE, Geo.NumFaces());
+    for (int32 f = 0; f < Geo.NumFaces(); ++f)
+    {
+        const int32 NumCorners = Geo.FaceNumCorners[f];
+        if (NumCorners < 3 || (Geo.FaceFlags[f] & (BspFaceFlags::Culled | BspFaceFlags::Sky))) continue;
+        if (WorldFaces && !(*WorldFaces)[f]) continue;
+        FVector3f Centroid = FVector3f::ZeroVector;
+        for (int32 c = 0; c < NumCorners; ++c)
+        {
+            Centroid += Geo.Positions[Geo.Indices[Geo.FaceFirstCorner[f] + c]];
+        }
+        const FIntPoint Cell = GetChunkCell(Xform.TransformPosition(Centroid / (float)NumCorners), CellSize);
+        int32& Chunk = CellToChunk.FindOrAdd(Cell, INDEX_NONE);
+        if (Chunk == INDEX_NONE)
+        {
+            Chunk = Map.Chunks.Num();
+            Map.Chunks.AddDefaulted_GetRef().Cell = Cell;
+        }
+        FaceChunk[f] = Chunk;
+    }
+
+    TArray<TBitArray<>> ChunkFaces;
+    ChunkFaces.SetNum(Map.Chunks.Num());
+    for (TBitArray<>& Mask : ChunkFaces)
+    {
+        Mask.Init(false, Geo.NumFaces());
+    }
+    for (int32 f = 0; f < Geo.NumFaces(); ++f)
+    {
+        if (FaceChunk[f] != INDEX_NONE) ChunkFaces[FaceChunk[f]][f] = true;
+    }
+    if (Sets->bImportVisibility)
+    {
+        TArray<TArray<int32>> ChunkClusters, ChunkAreas;
+        GatherSectionClusters(Map.Bsp, FaceChunk, Map.Chunks.Num(), ChunkClusters, ChunkAreas);
+        for (int32 c = 0; c < Map.Chunks.Num(); ++c)
+        {
+            Map.Chunks[c].Clusters = MoveTemp(ChunkClusters[c]);
+            Map.Chunks[c].Areas = MoveTemp(ChunkAreas[c]);
+        }
+    }
+
+    ParallelFor(TEXT("HL2BSP.BuildChunks"), Map.Chunks.Num(), 1, [&](int32 c)
+    {
+        FHL2MeshChunk& Chunk = Map.Chunks[c];
+        {
+            HL2_STAGE_SCOPE(STAT_HL2_BuildMesh);
+            Chunk.MeshDescription = BuildMeshDescriptionFromBSP(Map.Bsp, Sets, Chunk.SlotNames, &Chunk.BuildStats, EHL2BuildPart::World, &ChunkFaces[c], &Chunk.Lightmap);
+            Chunk.LODs.SetNum(GetNumDisplacementLODs(Map.Bsp, Sets, Chunk.BuildStats.DispsBuilt));
+            for (int32 l = 0; l < Chunk.LODs.Num(); ++l)
+            {
+                TArray<FName> LODSlotNames;
+                Chunk.LODs[l] = BuildMeshDescriptionFromBSP(Map.Bsp, Sets, LODSlotNames, nullptr, EHL2BuildPart::World, &ChunkFaces[c], nullptr, l + 1);
+            }
+        }
+        if (Sets->bImportLightmapUVs && Sets->bImportBakedLighting)
+        {
+            BakeLightmapAtlas(Map.Bsp, Chunk.Lightmap);
+        }
+        Chunk.Bounds = FBox(ForceInit);
+        for (const FVector3f& P : Chunk.MeshDescription.GetVertexPositions().GetRawArray())
+        {
+            Chunk.Bounds += FVector(P);
+        }
+    });
+
+    // Totals over all chunks, with per-slot triangles folded into the union of the chunks' slots
+    Map.BuildStats = FHL2MeshBuildStats();
+    for (const FHL2MeshChunk& Chunk : Map.Chunks)
+    {
+        const FHL2MeshBuildStats& S = Chunk.BuildStats;
+        Map.BuildStats.FacesBuilt += S.FacesBuilt;
+        Map.BuildStats.FacesSkipped += S.FacesSkipped;
+        Map.BuildStats.FacesMerged += S.FacesMerged;
+        Map.BuildStats.CollinearCornersRemoved += S.CollinearCornersRemoved;
+        Map.BuildStats.DispsBuilt += S.DispsBuilt;
+        Map.BuildStats.DispsSkipped += S.DispsSkipped;
+        Map.BuildStats.DispNodesStitched += S.DispNodesStitched;
+        Map.BuildStats.Vertices += S.Vertices;
+        Map.BuildStats.VertexInstances += S.VertexInstances;
+        Map.BuildStats.Triangles += S.Triangles;
+        Map.BuildStats.DegenerateTriangles += S.DegenerateTriangles;
+        Map.BuildStats.CollapsedTriangles += S.CollapsedTriangles;
+        Map.BuildStats.NormalsSeconds += S.NormalsSeconds;
+        Map.BuildStats.LightmapCharts += S.LightmapCharts;
+        for (int32 i = 0; i < Chunk.SlotNames.Num(); ++i)
+        {
+            const int32 Slot = Map.SlotNames.AddUnique(Chunk.SlotNames[i]);
+            Map.BuildStats.TrianglesPerSlot.SetNumZeroed(Map.SlotNames.Num());
+            Map.BuildStats.TrianglesPerSlot[Slot] += S.TrianglesPerSlot.IsValidIndex(i) ? S.TrianglesPerSlot[i] : 0;
+        }
+    }
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Chunked world: %d chunks of %.0f units, %d triangles"), Map.Chunks.Num(), CellSize, Map.BuildStats.Triangles);
+}
+
+// With brush entities split out, the world keeps the hulls of model 0's brushes and each group takes those of its first
+// model, around its pivot. Brushes are told apart by the model subtree whose leaves list them; hulls of models no group
+// builds (unreferenced, or every face culled) are dropped.
+static void SplitBrushModelHulls(FHL2PreparedMap& Map)
+{
+    const TArray<FBspModel>& Models = Map.Bsp.GetModels();
+    TArray<int32> Brushes;
+    GetModelBrushes(Map.Bsp, Models[0].HeadNode, Brushes);
+    if (Brushes.Num() == 0)
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("Brush collision: no BSP tree to tell world brushes from brush entity ones; the world keeps every hull."));
+        return;
+    }
+
+    TMap<int32, int32> BrushGroup;   // LUMP_BRUSHES index -> group, INDEX_NONE for the world
+    for (int32 Brush : Brushes)
+    {
+        BrushGroup.Add(Brush, INDEX_NONE);
+    }
+    for (int32 g = 0; g < Map.BrushModels.Num(); ++g)
+    {
+        GetModelBrushes(Map.Bsp, Models[Map.BrushModels[g].Models[0]].HeadNode, Brushes);
+        for (int32 Brush : Brushes)
+        {
+            BrushGroup.FindOrAdd(Brush, g);
+        }
+    }
+
+    TArray<FHL2BrushHull> WorldHulls;
+    int32 Moved = 0;
+    int32 Dropped = 0;
+    for (FHL2BrushHull& Hull : Map.CollisionHulls)
+    {
+        const int32* Group = BrushGroup.Find(Hull.Brush);
+        if (!Group)
+        {
+            ++Dropped;
+        }
+        else if (*Group == INDEX_NONE)
+        {
+            WorldHulls.Add(MoveTemp(Hull));
+        }
+        else
+        {
+            FHL2BrushModelGroup& Model = Map.BrushModels[*Group];
+            for (FVector3f& P : Hull.Points)
+            {
+                P -= Model.Pivot;
+            }
+            Model.CollisionHulls.Add(MoveTemp(Hull));
+            ++Moved;
+        }
+    }
+    Map.CollisionHulls = MoveTemp(WorldHulls);
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Brush collision: %d world hulls, %d on brush entity meshes, %d of unbuilt brush models dropped"),
+        Map.CollisionHulls.Num(), Moved, Dropped);
+}
+
+// Brush hulls of the chunked world, moved to the chunk of the cell holding their centre
+static void AssignHullsToChunks(FHL2PreparedMap& Map, float CellSize)
+{
+    if (Map.Chunks.Num() == 0)
+    {
+        return;
+    }
+    for (FHL2BrushHull& Hull : Map.CollisionHulls)
+    {
+        FVector3f Centre = FVector3f::ZeroVector;
+        for (const FVector3f& P : Hull.Points) Centre += P;
+        const FIntPoint Cell = GetChunkCell(Centre / (float)FMath::Max(1, Hull.Points.Num()), CellSize);
+        int32 Best = 0;
+        int64 BestDist = MAX_int64;
+        for (int32 c = 0; c < Map.Chunks.Num() && BestDist > 0; ++c)
+        {
+            const FIntPoint D = Map.Chunks[c].Cell - Cell;
+            const int64 Dist = (int64)D.X * D.X + (int64)D.Y * D.Y;
+            if (Dist < BestDist) { BestDist = Dist; Best = c; }
+        }
+        Map.Chunks[Best].CollisionHulls.Add(MoveTemp(Hull));
+    }
+    Map.CollisionHulls.Reset();
+}
+
+// Meshes of the distinct brush entity models, built around their pivot, models in parallel
+static void BuildBrushModelGeometry(FHL2PreparedMap& Map, const UHL2BSPImporterSettings* Sets)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_BrushModelMeshes);
+    GroupBrushModels(Map.Bsp, FHL2CoordTransform::FromSettings(Sets), Map.BrushModels, Map.BrushEntities, Map.BrushModelStats);
+    TArray<int32> GroupTriangles;
+    GroupTriangles.SetNumZeroed(Map.BrushModels.Num());
+    ParallelFor(TEXT("HL2BSP.BuildBrushModels"), Map.BrushModels.Num(), 1, [&](int32 g)
+    {
+        FHL2BrushModelGroup& Group = Map.BrushModels[g];
+        FHL2MeshBuildStats Stats;
+        Group.MeshDescription = BuildMeshDescriptionFromBSP(Map.Bsp, Sets, Group.SlotNames, &Stats, EHL2BuildPart::World, &Group.Faces, &Group.Lightmap);
+        for (FVector3f& P : Group.MeshDescription.GetVertexPositions().GetRawArray())
+        {
+            P -= Group.Pivot;
+        }
+        GroupTriangles[g] = Stats.Triangles;
+    });
+    for (int32 Triangles : GroupTriangles)
+    {
+        Map.BrushModelStats.Triangles += Triangles;
+    }
+}
+
+void BuildBSPMapGeometry(FHL2PreparedMap& Map, const UHL2BSPImporterSettings* Sets)
+{
+    double Start = FPlatformTime::Seconds();
+
+    // Brush entity faces leave the world; faces outside every model stay with it
+    TBitArray<> WorldFaceBits;
+    const TBitArray<>* WorldFaces = nullptr;
+    if (Sets->bSplitBrushEntities && Map.Bsp.GetModels().Num() > 1)
+    {
+        const FBspGeometry& Geo = Map.Bsp.GetGeometry();
+        WorldFaceBits.Init(false, Geo.NumFaces());
+        for (int32 f = 0; f < Geo.NumFaces(); ++f)
+        {
+            WorldFaceBits[f] = Geo.FaceModel[f] == 0;
+        }
+        WorldFaces = &WorldFaceBits;
+    }
+
+    if (Sets->ChunkMode == EHL2ChunkMode::Grid)
+    {
+        // Chunks build inside one parallel loop; their wall time is reported as Build, the summed normal passes as Normals
+        BuildChunkedGeometry(Map, Sets, WorldFaces);
+        Map.Timings.Build = FPlatformTime::Seconds() - Start;
+        Map.Timings.Normals = Map.BuildStats.NormalsSeconds;
+        Map.Memory.AfterBuild = SampleUsedPhysical();
+    }
+    else
+    {
+        {
+            HL2_STAGE_SCOPE(STAT_HL2_BuildMesh);
+            Map.MeshDescription = BuildMeshDescriptionFromBSP(Map.Bsp, Sets, Map.SlotNames, &Map.BuildStats, EHL2BuildPart::World, WorldFaces, &Map.Lightmap);
+            // Each LOD replans the same faces, so slots and polygon groups come out in LOD 0's order
+            Map.LODMeshDescriptions.SetNum(GetNumDisplacementLODs(Map.Bsp, Sets, Map.BuildStats.DispsBuilt));
+            ParallelFor(TEXT("HL2BSP.BuildLODs"), Map.LODMeshDescriptions.Num(), 1, [&](int32 l)
+            {
+                TArray<FName> LODSlotNames;
+                Map.LODMeshDescriptions[l] = BuildMeshDescriptionFromBSP(Map.Bsp, Sets, LODSlotNames, nullptr, EHL2BuildPart::World, WorldFaces, nullptr, l + 1);
+            });
+        }
+        if (Sets->bImportLightmapUVs && Sets->bImportBakedLighting)
+        {
+            BakeLightmapAtlas(Map.Bsp, Map.Lightmap);
+        }
+        FMeshDescription& MD = Map.MeshDescription;
+        Map.Timings.Build = FPlatformTime::Seconds() - Start;
+        Map.Timings.Normals = Map.BuildStats.NormalsSeconds;
+        Map.Memory.AfterBuild = SampleUsedPhysical();
+
+        // Log MeshDescription array sizes (UE5.6 has no CompactMeshDescription helper)
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("MeshDesc sizes: Tri=%d/%d Vert=%d/%d VI=%d/%d"), MD.Triangles().Num(), MD.Triangles().GetArraySize(),
+            MD.Vertices().Num(), MD.Vertices().GetArraySize(), MD.VertexInstances().Num(), MD.VertexInstances().GetArraySize());
+    }
+
+    if (Map.Bsp.GetCullStats().SkyFacesKept > 0)
+    {
+        Map.SkyMeshDescription = BuildMeshDescriptionFromBSP(Map.Bsp, Sets, Map.SkySlotNames, nullptr, EHL2BuildPart::Sky, WorldFaces);
+    }
+
+    if (WorldFaces)
+    {
+        BuildBrushModelGeometry(Map, Sets);
+    }
+    if (Sets->bImportCollision && Sets->CollisionMode == EHL2CollisionMode::BrushHulls)
+    {
+        BuildBrushHulls(Map.Bsp, FHL2CoordTransform::FromSettings(Sets), MakeCollisionGroupMask(Sets), Map.CollisionHulls, Map.CollisionStats);
+        Map.Timings.Collision = Map.CollisionStats.Seconds;
+        if (WorldFaces)
+        {
+            SplitBrushModelHulls(Map);
+        }
+        AssignHullsToChunks(Map, FMath::Max(100.f, Sets->ChunkCellSize));
+    }
+    if (Sets->bImportPropsAsInstances)
+    {
+        BuildStaticPropBatches(Map.Bsp, FHL2CoordTransform::FromSettings(Sets), Sets->PropMeshRoot, Map.PropBatches);
+    }
+    Map.Memory.AfterNormals = SampleUsedPhysical();
+}
+
+// Points the mesh at the imported UV channel 1, with a lightmap resolution matching the packed page
+static void ApplyLightmapSettings(UStaticMesh* Mesh, const FHL2LightmapAtlas& Lightmap)
+{
+    if (!Mesh || Lightmap.Charts.Num() == 0)
+    {
+        return;
+    }
+    Mesh->SetLightMapCoordinateIndex(1);
+    Mesh->SetLightMapResolution(FMath::Clamp(Align(FMath::Max(Lightmap.Size.X, Lightmap.Size.Y), 4), 4, 4096));
+}
+
+// Creates the asset, assigns one material per slot and builds render data from MD, plus LODs 1.. when given. With
+// bCompactMaterialSlots, slots resolving to a material an earlier slot already has are merged into that slot first
+// (MD and LODs are changed in place). With bCollision, Hulls become the simple collision; without hulls the render
+// triangles (of LOD 0) are used.
+static UStaticMesh* CreateStaticMesh(FMeshDescription& MD, const TArray<FName>& SlotNames, UObject* Parent, FName Name, EObjectFlags Flags,
+                                     UClass* MeshClass, FHL2MaterialResolver& Materials, const UHL2BSPImporterSettings* Sets,
+                                     FHL2SlotCompactionStats& SlotStats, bool bCollision,
+                                     TConstArrayView<FHL2BrushHull> Hulls = {}, TArrayView<FMeshDescription> LODs = {})
+{
+    // Create the asset in the provided parent package with provided flags
+    UStaticMesh* Mesh = NewObject<UStaticMesh>(Parent, MeshClass ? MeshClass : UStaticMesh::StaticClass(), Name, Flags);
+    if (!Mesh)
+    {
+        UE_LOG(LogHL2BSPImporter, Error, TEXT("NewObject<UStaticMesh> returned null (parent=%s, name=%s)."), *GetNameSafe(Parent), *Name.ToString());
+        return nullptr;
+    }
+
+    // Create material slots matching polygon groups; use map when available
+    Mesh->GetStaticMaterials().Reset();
+    TMap<UMaterialInterface*, FName> MaterialSlots;
+    TMap<FName, FName> SlotRedirects;
+    for (const FName& Slot : SlotNames)
+    {
+        UMaterialInterface* Mat = Materials.Resolve(Slot);
+        // Avoid needing the full EMaterialDomain definition here
+        if (!Mat)
+        {
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("No material mapped for slot '%s'; using default."), *Slot.ToString());
+            Mat = UMaterial::GetDefaultMaterial(static_cast<EMaterialDomain>(0));
+        }
+        if (Sets->bCompactMaterialSlots)
+        {
+            if (const FName* Into = MaterialSlots.Find(Mat))
+            {
+                SlotRedirects.Add(Slot, *Into);
+                continue;
+            }
+            MaterialSlots.Add(Mat, Slot);
+        }
+        Mesh->GetStaticMaterials().Add(FStaticMaterial(Mat, Slot));
+    }
+
+    // One polygon group, and so one section and draw call, per material rather than per texture name
+    if (SlotRedirects.Num() > 0)
+    {
+        const double CompactStart = FPlatformTime::Seconds();
+        CompactMaterialSlots(MD, SlotRedirects);
+        for (FMeshDescription& LOD : LODs)
+        {
+            CompactMaterialSlots(LOD, SlotRedirects);
+        }
+        SlotStats.Seconds += FPlatformTime::Seconds() - CompactStart;
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("%s: %d material slots merged into %d"), *Name.ToString(), SlotNames.Num(), Mesh->GetStaticMaterials().Num());
+    }
+    ++SlotStats.Meshes;
+    SlotStats.SlotsBefore += SlotNames.Num();
+    SlotStats.SlotsAfter += Mesh->GetStaticMaterials().Num();
+
+    // Configure Nanite before build
+    Mesh->NaniteSettings.bEnabled = Sets->bBuildNanite;
+
+    // Displacement LODs switch at the configured screen sizes rather than auto-computed ones. The source models are
+    // sized first so BuildFromMeshDescriptions keeps them.
+    if (LODs.Num() > 0)
+    {
+        Mesh->SetNumSourceModels(LODs.Num() + 1);
+        Mesh->bAutoComputeLODScreenSize = false;
+        for (int32 l = 1; l <= LODs.Num(); ++l)
+        {
+            Mesh->GetSourceModel(l).ScreenSize.Default = Sets->DisplacementLODScreenSizes[l - 1];
+        }
+    }
+
+    // Build from MeshDescription (UE5 path)
+    {
+        HL2_STAGE_SCOPE(STAT_HL2_MeshBuild);
+        TArray<const FMeshDescription*> Descs; Descs.Add(&MD);
+        for (const FMeshDescription& LOD : LODs)
+        {
+            Descs.Add(&LOD);
+        }
+        Mesh->BuildFromMeshDescriptions(Descs);
+    }
+    if (FStaticMeshRenderData* RenderData = Mesh->GetRenderData())
+    {
+        for (int32 l = 1; l <= LODs.Num() && l < MAX_STATIC_MESH_LODS; ++l)
+        {
+            RenderData->ScreenSize[l].Default = Sets->DisplacementLODScreenSizes[l - 1];
+        }
+    }
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("StaticMesh built from MeshDescription. LODs=%d Materials=%d"), Mesh->GetNumLODs(), Mesh->GetStaticMaterials().Num());
+
+    // Collision settings
+    if (bCollision)
+    {
+        Mesh->CreateBodySetup();
+        if (Mesh->GetBodySetup() && Hulls.Num() > 0)
+        {
+            ApplyBrushHulls(Mesh->GetBodySetup(), Hulls);
+            UE_LOG(LogHL2BSPImporter, Log, TEXT("Collision: %d brush hulls, UseSimpleAsComplex."), Hulls.Num());
+        }
+        else if (Mesh->GetBodySetup())
+        {
+            Mesh->GetBodySetup()->CollisionTraceFlag = CTF_UseComplexAsSimple;
+            UE_LOG(LogHL2BSPImporter, Log, TEXT("Collision: Set to UseComplexAsSimple."));
+        }
+    }
+
+    FAssetRegistryModule::AssetCreated(Mesh);
+    Mesh->MarkPackageDirty();
+    return Mesh;
+}
+
+UStaticMesh* CreateStaticMeshFromBSPMap(FHL2PreparedMap& Map, UObject* Parent, FName Name, EObjectFlags Flags, UClass* MeshClass,
+                                        FHL2MaterialResolver& Materials, const UHL2BSPImporterSettings* Sets)
+{
+    check(IsInGameThread());
+    const double Start = FPlatformTime::Seconds();
+    UStaticMesh* Mesh = CreateStaticMesh(Map.MeshDescription, Map.SlotNames, Parent, Name, Flags, MeshClass, Materials, Sets, Map.SlotCompaction, Sets->bImportCollision, Map.CollisionHulls, Map.LODMeshDescriptions);
+    ApplyLightmapSettings(Mesh, Map.Lightmap);
+    Map.Timings.MeshBuild = FPlatformTime::Seconds() - Start;
+    Map.Memory.AfterMeshBuild = SampleUsedPhysical();
+    return Mesh;
+}
+
+UHL2ChunkManifest* CreateChunkedMeshesFromBSPMap(FHL2PreparedMap& Map, UObject* Parent, FName Name, EObjectFlags Flags,
+                                                FHL2MaterialResolver& Materials, const UHL2BSPImporterSettings* Sets,
+                                                TArray<UStaticMesh*>* OutMeshes)
+{
+    check(IsInGameThread());
+    const double Start = FPlatformTime::Seconds();
+    UHL2ChunkManifest* Manifest = NewObject<UHL2ChunkManifest>(Parent, Name, Flags);
+    Manifest->SourceFile = Map.Filename;
+    Manifest->CellSize = FMath::Max(100.f, Sets->ChunkCellSize);
+
+    const FString BaseName = Parent->GetOutermost()->GetName();
+    for (FHL2MeshChunk& Chunk : Map.Chunks)
+    {
+        const FString ChunkPackageName = FString::Printf(TEXT("%s_Chunk_%d_%d"), *BaseName, Chunk.Cell.X, Chunk.Cell.Y);
+        UStaticMesh* Mesh = CreateStaticMesh(Chunk.MeshDescription, Chunk.SlotNames, CreatePackage(*ChunkPackageName), FName(*FPackageName::GetShortName(ChunkPackageName)),
+                                             Flags, nullptr, Materials, Sets, Map.SlotCompaction, Sets->bImportCollision, Chunk.CollisionHulls, Chunk.LODs);
+        if (!Mesh)
+        {
+            continue;
+        }
+        ApplyLightmapSettings(Mesh, Chunk.Lightmap);
+        FHL2ChunkEntry& Entry = Manifest->Chunks.AddDefaulted_GetRef();
+        Entry.Mesh = Mesh;
+        Entry.Cell = Chunk.Cell;
+        Entry.Bounds = Chunk.Bounds;
+        Entry.Triangles = Chunk.MeshDescription.Triangles().Num();
+        Entry.Clusters = Chunk.Clusters;
+        Entry.Areas = Chunk.Areas;
+        Manifest->Bounds += Chunk.Bounds;
+        if (OutMeshes)
+        {
+            OutMeshes->Add(Mesh);
+        }
+    }
+
+    FAssetRegistryModule::AssetCreated(Manifest);
+    Manifest->MarkPackageDirty();
+    Map.Timings.MeshBuild = FPlatformTime::Seconds() - Start;
+    Map.Memory.AfterMeshBuild = SampleUsedPhysical();
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Created chunk manifest %s: %d chunk meshes"), *Manifest->GetName(), Manifest->Chunks.Num());
+    return Manifest;
+}
+
+UHL2VisibilityData* CreateVisibilityDataFromBSPMap(FHL2PreparedMap& Map, const UHL2ChunkManifest* Manifest, const UHL2BSPImporterSettings* Sets,
+                                                   const FString& PackageName)
+{
+    check(IsInGameThread());
+    if (!Sets->bImportVisibility || !Manifest)
+    {
+        return nullptr;
+    }
+    return CreateVisibilityData(Map.Bsp, FHL2CoordTransform::FromSettings(Sets), *Manifest, CreatePackage(*PackageName),
+                                FName(*FPackageName::GetShortName(PackageName)), RF_Public | RF_Standalone, Map.VisibilityStats);
+}
+
+UStaticMesh* CreateSkyMeshFromBSPMap(FHL2PreparedMap& Map, UObject* Parent, FName Name, EObjectFlags Flags,
+                                     FHL2MaterialResolver& Materials, const UHL2BSPImporterSettings* Sets)
+{
+    check(IsInGameThread());
+    if (Map.SkyMeshDescription.Triangles().Num() == 0)
+    {
+        return nullptr;
+    }
+    UStaticMesh* Mesh = CreateStaticMesh(Map.SkyMeshDescription, Map.SkySlotNames, Parent, Name, Flags, nullptr, Materials, Sets, Map.SlotCompaction, false);
+    if (Mesh)
+    {
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("Created sky mesh %s (%d triangles)"), *Mesh->GetName(), Map.SkyMeshDescription.Triangles().Num());
+    }
+    return Mesh;
+}
+
+UWorld* CreateBrushEntitiesFromBSPMap(FHL2PreparedMap& Map, const FString& BasePackageName, FHL2MaterialResolver& Materials,
+                                      const UHL2BSPImporterSettings* Sets, TArray<UStaticMesh*>* OutMeshes)
+{
+    check(IsInGameThread());
+    if (Map.BrushEntities.Num() == 0)
+    {
+        return nullptr;
+    }
+    const double Start = FPlatformTime::Seconds();
+    TArray<UStaticMesh*> GroupMeshes;
+    GroupMeshes.Init(nullptr, Map.BrushModels.Num());
+    for (int32 g = 0; g < Map.BrushModels.Num(); ++g)
+    {
+        FHL2BrushModelGroup& Group = Map.BrushModels[g];
+        if (Group.MeshDescription.Triangles().Num() == 0)
+        {
+            continue;
+        }
+        const FString MeshPackageName = FString::Printf(TEXT("%s_Model_%d"), *BasePackageName, Group.Models[0]);
+        GroupMeshes[g] = CreateStaticMesh(Group.MeshDescription, Group.SlotNames, CreatePackage(*MeshPackageName), FName(*FPackageName::GetShortName(MeshPackageName)),
+                                          RF_Public | RF_Standalone, nullptr, Materials, Sets, Map.SlotCompaction, Sets->bImportCollision, Group.CollisionHulls);
+        ApplyLightmapSettings(GroupMeshes[g], Group.Lightmap);
+        if (GroupMeshes[g] && OutMeshes)
+        {
+            OutMeshes->Add(GroupMeshes[g]);
+        }
+    }
+    const FString WorldPackageName = BasePackageName + TEXT("_Brushes");
+    UWorld* World = CreateBrushEntityWorld(Map.BrushEntities, GroupMeshes, CreatePackage(*WorldPackageName), FName(*FPackageName::GetShortName(WorldPackageName)), RF_Public | RF_Standalone);
+    Map.Timings.MeshBuild += FPlatformTime::Seconds() - Start;
+    return World;
+}
+
+TArray<UTexture2D*> CreateLightmapTexturesFromBSPMap(const FHL2PreparedMap& Map, const FString& BasePackageName)
+{
+    check(IsInGameThread());
+    TArray<UTexture2D*> Textures;
+    auto CreateTexture = [&Textures](const FHL2LightmapAtlas& Lightmap, const FString& PackageName)
+    {
+        if (Lightmap.Texels.Num() == 0)
+        {
+            return;
+        }
+        if (UTexture2D* Texture = CreateLightmapTexture(Lightmap, CreatePackage(*PackageName), FName(*FPackageName::GetShortName(PackageName)), RF_Public | RF_Standalone))
+        {
+            Textures.Add(Texture);
+        }
+    };
+    CreateTexture(Map.Lightmap, BasePackageName + TEXT("_Lightmap"));
+    for (const FHL2MeshChunk& Chunk : Map.Chunks)
+    {
+        CreateTexture(Chunk.Lightmap, FString::Printf(TEXT("%s_Chunk_%d_%d_Lightmap"), *BasePackageName, Chunk.Cell.X, Chunk.Cell.Y));
+    }
+    return Textures;
+}
+
+UWorld* CreatePropWorldFromBSPMap(const FHL2PreparedMap& Map, const FString& PackageName)
+{
+    check(IsInGameThread());
+    HL2_STAGE_SCOPE(STAT_HL2_StaticProps);
+    if (Map.PropBatches.Num() == 0)
+    {
+        return nullptr;
+    }
+    return CreateStaticPropWorld(Map.PropBatches, CreatePackage(*PackageName), FName(*FPackageName::GetShortName(PackageName)), RF_Public | RF_Standalone);
+}
+
+UHL2EntityTable* CreateEntityTableFromBSPMap(const FHL2PreparedMap& Map, const FString& PackageName)
+{
+    check(IsInGameThread());
+    HL2_STAGE_SCOPE(STAT_HL2_EntityTable);
+
+    // Create Entities DataTable asset from BSP entities if available
+    const TArray<FHL2Entity>& Entities = Map.Bsp.GetEntities();
+    if (Entities.Num() == 0)
+    {
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("No entities found in BSP."));
+        return nullptr;
+    }
+
+    UPackage* EntPkg = CreatePackage(*PackageName);
+    UHL2EntityTable* Table = UHL2EntityTable::CreateFromEntities(EntPkg, Entities);
+    if (Table)
+    {
+        FAssetRegistryModule::AssetCreated(Table);
+        Table->MarkPackageDirty();
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("Created Entities DataTable: %s"), *Table->GetName());
+    }
+    else
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("Failed to create Entities DataTable for %d entities."), Entities.Num());
+    }
+    return Table;
+}
@@ -0,0 +1,528 @@
+#include "HL2BSPMeshBuilder.h"
+#include "HL2BSPImporter.h"
+#include "BspFile.h"
+#include "HL2BSPImporterSettings.h"
+#include "HL2CoordTransform.h"
+#include "HL2Displacements.h"
+#include "HL2FaceMerge.h"
+#include "HL2LightmapAtlas.h"
+#include "HL2MeshNormals.h"
+#include "StaticMeshAttributes.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+// Two-phase MeshDescription builder: a serial planning pass counts and reserves every element, then
+// positions/UVs/attributes are filled in parallel and elements are linked in a final serial pass.
+
+static constexpr int32 HL2BuildBatchSize = 1024;
+// Hammer smoothing groups use bits 0-23; displacements also get this one, so neighbouring displacements always
+// share normals along their edges as VBSP does
+static constexpr uint32 HL2DispSmoothingGroup = 1u << 31;
+// PointSources marker for displacement interior nodes: always a vertex of their own, never hashed
+static constexpr int32 HL2UnsharedPoint = -2;
+
+DECLARE_CYCLE_STAT(TEXT("Build Plan"), STAT_HL2_BuildPlan, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Build Merge Faces"), STAT_HL2_BuildMerge, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Build Points"), STAT_HL2_BuildPoints, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Build Lightmap UVs"), STAT_HL2_BuildLightmapUVs, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Build Transform"), STAT_HL2_BuildTransform, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Build Weld"), STAT_HL2_BuildWeld, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Build Elements"), STAT_HL2_BuildElements, STATGROUP_HL2BSPImporter);
+
+// Assigns welded vertex indices. BSP vertex indices hit a direct table first; anything else (or a second
+// BSP index at the same spot) goes through a hash of positions quantized to the weld tolerance.
+struct FHL2VertexWelder
+{
+    FHL2VertexWelder(int32 NumSourceVerts, float Tolerance)
+        : InvCellSize(1.f / FMath::Max(Tolerance, UE_KINDA_SMALL_NUMBER))
+    {
+        BySourceIndex.Init(INDEX_NONE, NumSourceVerts);
+    }
+
+    int32 WeldSource(int32 SourceIndex, const FVector3f& P)
+    {
+        if (!BySourceIndex.IsValidIndex(SourceIndex))
+        {
+            return WeldPosition(P);
+        }
+        int32& Slot = BySourceIndex[SourceIndex];
+        if (Slot == INDEX_NONE)
+        {
+            Slot = WeldPosition(P);
+        }
+        return Slot;
+    }
+
+    int32 AddUnshared(const FVector3f& P)
+    {
+        return Positions.Add(P);
+    }
+
+    int32 WeldPosition(const FVector3f& P)
+    {
+        const FIntVector Key(FMath::RoundToInt(P.X * InvCellSize), FMath::RoundToInt(P.Y * InvCellSize), FMath::RoundToInt(P.Z * InvCellSize));
+        if (const int32* Found = ByCell.Find(Key))
+        {
+            return *Found;
+        }
+        const int32 Index = Positions.Add(P);
+        ByCell.Add(Key, Index);
+        return Index;
+    }
+
+    TArray<FVector3f> Positions;
+    TArray<int32> BySourceIndex;
+    TMap<FIntVector, int32> ByCell;
+    float InvCellSize;
+};
+
+struct FHL2FacePlan
+{
+    int32 Face = INDEX_NONE;
+    int32 Polygon = INDEX_NONE;   // merged polygon, or INDEX_NONE to take Face as-is with a fan
+    int32 NumCorners = 0;
+    int32 FirstPoint = 0;
+    int32 FirstTri = 0;
+    FPolygonGroupID PolygonGroup;
+};
+
+struct FHL2DispPlan
+{
+    int32 DispInfo = INDEX_NONE;
+    int32 BaseFace = INDEX_NONE;
+    int32 Side = 0;
+    int32 Step = 1;               // grid samples skipped per node at this LOD (1 << power drop)
+    bool bTriangle = false;
+    int32 FirstPoint = 0;
+    int32 FirstTri = 0;
+    int32 NumTris = 0;
+    FPolygonGroupID PolygonGroup;
+};
+
+static FName GetSlotName(const FString& TextureName)
+{
+    return TextureName.IsEmpty() ? FName(TEXT("Default")) : FName(*TextureName);
+}
+
+TArray<FName> GatherMaterialSlotNames(const FBspFile& Bsp)
+{
+    // Mirrors the group creation order of the planning pass below: brush faces in file order, then displacements
+    // in LUMP_DISPINFO order with their base face's texture (base faces themselves are not planned). Culled faces
+    // have no corners; sky faces kept for a sky mesh are included so their materials load with the rest.
+    const FBspGeometry& Geo = Bsp.GetGeometry();
+    TBitArray<> Seen(false, Geo.TextureNames.Num());
+    TArray<FName> Names;
+    auto AddFace = [&](int32 Face)
+    {
+        if (Geo.FaceNumCorners[Face] < 3) return;
+        const uint16 TextureId = Geo.FaceTexture[Face];
+        if (Seen[TextureId]) return;
+        Seen[TextureId] = true;
+        Names.AddUnique(GetSlotName(Geo.TextureNames[TextureId]));
+    };
+    for (int32 f = 0; f < Geo.NumFaces(); ++f)
+    {
+        if (!(Geo.FaceFlags[f] & BspFaceFlags::Displacement)) AddFace(f);
+    }
+    for (const FDispInfo& DI : Bsp.GetDispInfos())
+    {
+        if (DI.MapFace >= 0 && DI.MapFace < Geo.NumFaces()) AddFace(DI.MapFace);
+    }
+    return Names;
+}
+
+FMeshDescription BuildMeshDescriptionFromBSP(const FBspFile& Bsp, const UHL2BSPImporterSettings* Sets, TArray<FName>& OutMaterialSlotNames,
+                                             FHL2MeshBuildStats* OutStats, EHL2BuildPart Part, const TBitArray<>* FaceMask,
+                                             FHL2LightmapAtlas* OutLightmap, int32 DispLODShift)
+{
+    FMeshDescription MD;
+    FStaticMeshAttributes Attrs(MD);
+    Attrs.Register();
+
+    TVertexAttributesRef<FVector3f> VertexPositions = MD.GetVertexPositions();
+    TVertexInstanceAttributesRef<FVector3f> InstanceNormals = Attrs.GetVertexInstanceNormals();
+    TVertexInstanceAttributesRef<FVector3f> InstanceTangents = Attrs.GetVertexInstanceTangents();
+    TVertexInstanceAttributesRef<float> InstanceBinormalSigns = Attrs.GetVertexInstanceBinormalSigns();
+    TVertexInstanceAttributesRef<FVector4f> InstanceColors = Attrs.GetVertexInstanceColors();
+    TVertexInstanceAttributesRef<FVector2f> InstanceUVs = Attrs.GetVertexInstanceUVs();
+    const bool bLightmapUVs = Sets && Sets->bImportLightmapUVs && Part == EHL2BuildPart::World;
+    InstanceUVs.SetNumChannels(bLightmapUVs ? 2 : 1);
+
+    TPolygonGroupAttributesRef<FName> PolyGroupMaterialNames = Attrs.GetPolygonGroupMaterialSlotNames();
+
+    const FBspGeometry& Geo = Bsp.GetGeometry();
+    const auto& Disps = Bsp.GetDispInfos();
+    const auto& DV = Bsp.GetDispVerts();
+
+    // Map texture ID -> polygon group, created on first use; PolygonGroupSlot maps group -> slot index
+    TArray<FPolygonGroupID> TexturePG;
+    TexturePG.Init(FPolygonGroupID::Invalid, Geo.TextureNames.Num());
+    TArray<int32> PolygonGroupSlot;
+    auto GetOrCreatePG = [&](uint16 TextureId) -> FPolygonGroupID
+    {
+        FPolygonGroupID& PG = TexturePG[TextureId];
+        if (PG == FPolygonGroupID::Invalid)
+        {
+            const FName SlotName = GetSlotName(Geo.TextureNames[TextureId]);
+            PG = MD.CreatePolygonGroup();
+            PolyGroupMaterialNames[PG] = SlotName;
+            PolygonGroupSlot.SetNum(FMath::Max(PolygonGroupSlot.Num(), PG.GetValue() + 1));
+            PolygonGroupSlot[PG.GetValue()] = OutMaterialSlotNames.AddUnique(SlotName);
+        }
+        return PG;
+    };
+
+    // Phase 1: plan. Every face corner and displacement grid point becomes one "point" (= one vertex instance).
+    int32 NumPoints = 0;
+    int32 NumTris = 0;
+    int32 FacesSkipped = 0;
+    int32 DispsSkipped = 0;
+    TArray<int32> PartFaces;
+    FHL2MergedPolygons Merged;
+    const bool bMerge = Sets && Sets->bMergeCoplanarFaces;
+    TArray<FHL2FacePlan> FacePlans;
+    TArray<FHL2DispPlan> DispPlans;
+    {
+        HL2_STAGE_SCOPE(STAT_HL2_BuildPlan);
+        PartFaces.Reserve(Geo.NumFaces());
+        const uint8 WantSky = Part == EHL2BuildPart::Sky ? BspFaceFlags::Sky : 0;
+        for (int32 f = 0; f < Geo.NumFaces(); ++f)
+        {
+            if ((Geo.FaceFlags[f] & BspFaceFlags::Culled) || (Geo.FaceFlags[f] & BspFaceFlags::Sky) != WantSky) continue;
+            if (FaceMask && !(*FaceMask)[f]) continue;
+            // Source never draws a displacement's base face; it only anchors the grid planned below
+            if (Geo.FaceFlags[f] & BspFaceFlags::Displacement) continue;
+            if (Geo.FaceNumCorners[f] < 3) { ++FacesSkipped; continue; }
+            PartFaces.Add(f);
+        }
+        if (bMerge)
+        {
+            HL2_STAGE_SCOPE(STAT_HL2_BuildMerge);
+            MergeCoplanarFaces(Geo, PartFaces, Merged);
+        }
+
+        // Face plans come first, so a merged polygon's triangles start at its plan's FirstTri in Merged.TriCorners too
+        const int32 NumFacePlans = bMerge ? Merged.Num() : PartFaces.Num();
+        FacePlans.Reserve(NumFacePlans);
+        for (int32 p = 0; p < NumFacePlans; ++p)
+        {
+            FHL2FacePlan& Plan = FacePlans.AddDefaulted_GetRef();
+            Plan.Face = bMerge ? Merged.PolyFace[p] : PartFaces[p];
+            Plan.Polygon = bMerge ? p : INDEX_NONE;
+            Plan.NumCorners = bMerge ? Merged.PolyNumCorners[p] : Geo.FaceNumCorners[Plan.Face];
+            Plan.FirstPoint = NumPoints;
+            Plan.FirstTri = NumTris;
+            Plan.PolygonGroup = GetOrCreatePG(Geo.FaceTexture[Plan.Face]);
+            NumPoints += Plan.NumCorners;
+            NumTris += Plan.NumCorners - 2;
+        }
+
+        // Displacements belong to the world part only
+        const TConstArrayView<FDispInfo> PartDisps = Part == EHL2BuildPart::World ? TConstArrayView<FDispInfo>(Disps) : TConstArrayView<FDispInfo>();
+        DispPlans.Reserve(PartDisps.Num());
+        for (int32 d = 0; d < PartDisps.Num(); ++d)
+        {
+            const FDispInfo& DI = PartDisps[d];
+            if (DI.MapFace < 0 || DI.MapFace >= Geo.NumFaces()) { ++DispsSkipped; continue; }
+            if (FaceMask && !(*FaceMask)[DI.MapFace]) continue;
+            // A base face the reader's filter dropped takes its displacement with it, like any culled face
+            if (Geo.FaceFlags[DI.MapFace] & BspFaceFlags::Culled) continue;
+            const int32 NumCorners = Geo.FaceNumCorners[DI.MapFace];
+            if (NumCorners != 3 && NumCorners != 4) { ++DispsSkipped; continue; }
+
+            const int32 FullSide = GetDispSide(DI.Power);
+            if (DI.Power < 1 || DI.Power > 4 || DI.VertStart < 0 || DI.VertStart + FullSide * FullSide > DV.Num()) { ++DispsSkipped; continue; }
+            const int32 Power = FMath::Max(0, DI.Power - DispLODShift);
+            const int32 Side = GetDispSide(Power);
+            const int32 Total = Side * Side;
+
+            FHL2DispPlan& Plan = DispPlans.AddDefaulted_GetRef();
+            Plan.DispInfo = d;
+            Plan.BaseFace = DI.MapFace;
+            Plan.Side = Side;
+            Plan.Step = 1 << (DI.Power - Power);
+            Plan.bTriangle = NumCorners == 3;
+            Plan.FirstPoint = NumPoints;
+            Plan.FirstTri = NumTris;
+            Plan.NumTris = GetDispNumTriangles(Side, Plan.bTriangle);
+            Plan.PolygonGroup = GetOrCreatePG(Geo.FaceTexture[DI.MapFace]);
+            NumPoints += Total;
+            NumTris += Plan.NumTris;
+        }
+    }
+
+    // Phase 2: Source-space positions and UVs for every point, in parallel over face and displacement ranges.
+    // Positions are transformed afterwards as one bulk stream.
+    TArray<FVector3f> PointPositions; PointPositions.SetNumUninitialized(NumPoints);
+    TArray<FVector2f> PointUVs; PointUVs.SetNumUninitialized(NumPoints);
+    // Luxel coordinates first, replaced by atlas UVs once the charts are packed
+    TArray<FVector2f> PointLightmapUVs; PointLightmapUVs.SetNumUninitialized(bLightmapUVs ? NumPoints : 0);
+    TArray<float> PointAlphas; PointAlphas.SetNumUninitialized(NumPoints);   // vertex colour alpha: displacement blend
+    TArray<int32> PointSources; PointSources.SetNumUninitialized(NumPoints);
+    TArray<int32> TriPoints; TriPoints.SetNumUninitialized(NumTris * 3);
+    TArray<FPolygonGroupID> TriGroups; TriGroups.SetNumUninitialized(NumTris);
+    int32 DispNodesStitched = 0;
+
+    {
+        HL2_STAGE_SCOPE(STAT_HL2_BuildPoints);
+        ParallelFor(TEXT("HL2BSP.FacePoints"), FacePlans.Num(), HL2BuildBatchSize, [&](int32 PlanIndex)
+        {
+            const FHL2FacePlan& Plan = FacePlans[PlanIndex];
+            const int32 NumCorners = Plan.NumCorners;
+            if (Plan.Polygon != INDEX_NONE)
+            {
+                const int32 FirstCorner = Merged.PolyFirstCorner[Plan.Polygon];
+                for (int32 c = 0; c < NumCorners; ++c)
+                {
+                    const int32 Corner = Merged.Corners[FirstCorner + c];
+                    const int32 Index = Geo.Indices[Corner];
+                    PointPositions[Plan.FirstPoint + c] = Geo.Positions[Index];
+                    PointUVs[Plan.FirstPoint + c] = Geo.UVs[Corner];
+                    if (bLightmapUVs) PointLightmapUVs[Plan.FirstPoint + c] = Geo.LightmapUVs[Corner];
+                    PointAlphas[Plan.FirstPoint + c] = 1.f;
+                    PointSources[Plan.FirstPoint + c] = Index;
+                }
+                for (int32 t = 0; t < NumCorners - 2; ++t)
+                {
+                    const int32 Tri = Plan.FirstTri + t;
+                    TriPoints[Tri * 3 + 0] = Plan.FirstPoint + Merged.TriCorners[Tri * 3 + 0];
+                    TriPoints[Tri * 3 + 1] = Plan.FirstPoint + Merged.TriCorners[Tri * 3 + 1];
+                    TriPoints[Tri * 3 + 2] = Plan.FirstPoint + Merged.TriCorners[Tri * 3 + 2];
+                    TriGroups[Tri] = Plan.PolygonGroup;
+                }
+                return;
+            }
+
+            const int32 FirstCorner = Geo.FaceFirstCorner[Plan.Face];
+            for (int32 c = 0; c < NumCorners; ++c)
+            {
+                const int32 Index = Geo.Indices[FirstCorner + c];
+                PointPositions[Plan.FirstPoint + c] = Geo.Positions[Index];
+                PointUVs[Plan.FirstPoint + c] = Geo.UVs[FirstCorner + c];
+                if (bLightmapUVs) PointLightmapUVs[Plan.FirstPoint + c] = Geo.LightmapUVs[FirstCorner + c];
+                PointAlphas[Plan.FirstPoint + c] = 1.f;
+                PointSources[Plan.FirstPoint + c] = Index;
+            }
+            // Fan triangulation over the face's corners
+            for (int32 t = 0; t < NumCorners - 2; ++t)
+            {
+                const int32 Tri = Plan.FirstTri + t;
+                TriPoints[Tri * 3 + 0] = Plan.FirstPoint;
+                TriPoints[Tri * 3 + 1] = Plan.FirstPoint + t + 1;
+                TriPoints[Tri * 3 + 2] = Plan.FirstPoint + t + 2;
+                TriGroups[Tri] = Plan.PolygonGroup;
+            }
+        });
+
+        // Displacements: one grid per plan, tessellated in parallel; interior nodes never need the welder's hash
+        ParallelFor(TEXT("HL2BSP.DispPoints"), DispPlans.Num(), 1, [&](int32 PlanIndex)
+        {
+            const FHL2DispPlan& Plan = DispPlans[PlanIndex];
+            const int32 Total = Plan.Side * Plan.Side;
+            const int32 FullSide = (Plan.Side - 1) * Plan.Step + 1;
+            FHL2DispBase Base;
+            verify(GetDispBase(Geo, Disps[Plan.DispInfo], Base));
+            TessellateDisplacement(Base, Plan.Side, Plan.Step, MakeArrayView(DV.GetData() + Disps[Plan.DispInfo].VertStart, FullSide * FullSide),
+                                   MakeArrayView(PointPositions.GetData() + Plan.FirstPoint, Total), MakeArrayView(PointUVs.GetData() + Plan.FirstPoint, Total),
+                                   bLightmapUVs ? MakeArrayView(PointLightmapUVs.GetData() + Plan.FirstPoint, Total) : TArrayView<FVector2f>(),
+                                   MakeArrayView(PointAlphas.GetData() + Plan.FirstPoint, Total));
+            for (int32 Node = 0; Node < Total; ++Node)
+            {
+                PointSources[Plan.FirstPoint + Node] = IsDispBorderNode(Plan.Side, Node) ? INDEX_NONE : HL2UnsharedPoint;
+            }
+            TriangulateDisplacement(Plan.Side, Plan.bTriangle, Plan.FirstPoint, MakeArrayView(TriPoints.GetData() + Plan.FirstTri * 3, Plan.NumTris * 3));
+            for (int32 t = Plan.FirstTri; t < Plan.FirstTri + Plan.NumTris; ++t)
+            {
+                TriGroups[t] = Plan.PolygonGroup;
+            }
+        });
+
+        // Snap the shared borders of neighbouring displacements together, still in Source space
+        TArray<FHL2DispStitchInput> StitchInputs;
+        StitchInputs.Reserve(DispPlans.Num());
+        for (const FHL2DispPlan& Plan : DispPlans)
+        {
+            StitchInputs.Add({ Plan.DispInfo, Plan.Side, Plan.FirstPoint, Plan.bTriangle });
+        }
+        DispNodesStitched = StitchDisplacements(Disps, StitchInputs, PointPositions);
+    }
+
+    // Lightmap charts: the luxel bounds of each plan's points, in plan order (faces, then displacements), packed
+    // into one page; each point's luxel coordinate then becomes its atlas UV
+    FHL2LightmapAtlas Lightmap;
+    if (bLightmapUVs)
+    {
+        HL2_STAGE_SCOPE(STAT_HL2_BuildLightmapUVs);
+        auto AddPlanChart = [&](int32 FirstPoint, int32 Count, TConstArrayView<int32> Faces)
+        {
+            FVector2f Min(MAX_flt, MAX_flt);
+            FVector2f Max(-MAX_flt, -MAX_flt);
+            for (int32 p = FirstPoint; p < FirstPoint + Count; ++p)
+            {
+                Min = FVector2f::Min(Min, PointLightmapUVs[p]);
+                Max = FVector2f::Max(Max, PointLightmapUVs[p]);
+            }
+            return Lightmap.AddChart(Min, Max, Faces);
+        };
+        Lightmap.Charts.Reserve(FacePlans.Num() + DispPlans.Num());
+        for (const FHL2FacePlan& Plan : FacePlans)
+        {
+            AddPlanChart(Plan.FirstPoint, Plan.NumCorners, Plan.Polygon != INDEX_NONE ? Merged.GetMembers(Plan.Polygon) : MakeArrayView(&Plan.Face, 1));
+        }
+        for (const FHL2DispPlan& Plan : DispPlans)
+        {
+            AddPlanChart(Plan.FirstPoint, Plan.Side * Plan.Side, MakeArrayView(&Plan.BaseFace, 1));
+        }
+        PackLightmapAtlas(Lightmap);
+
+        ParallelFor(TEXT("HL2BSP.LightmapUVs"), FacePlans.Num() + DispPlans.Num(), HL2BuildBatchSize, [&](int32 Chart)
+        {
+            // A plan's points run up to the next plan's first point, or to the end of the stream
+            const int32 FirstPoint = Chart < FacePlans.Num() ? FacePlans[Chart].FirstPoint : DispPlans[Chart - FacePlans.Num()].FirstPoint;
+            const int32 Next = Chart + 1;
+            const int32 EndPoint = Next < FacePlans.Num() ? FacePlans[Next].FirstPoint
+                : (Next - FacePlans.Num() < DispPlans.Num() ? DispPlans[Next - FacePlans.Num()].FirstPoint : NumPoints);
+            for (int32 p = FirstPoint; p < EndPoint; ++p)
+            {
+                PointLightmapUVs[p] = Lightmap.GetUV(Chart, PointLightmapUVs[p]);
+            }
+        });
+    }
+
+    // Source -> Unreal for the whole point stream (brush corners and displacement grids) in one SIMD pass
+    {
+        HL2_STAGE_SCOPE(STAT_HL2_BuildTransform);
+        const FHL2CoordTransform Xform = FHL2CoordTransform::FromSettings(Sets);
+        const int32 NumTransformChunks = FMath::DivideAndRoundUp(NumPoints, HL2BuildBatchSize * 16);
+        ParallelFor(TEXT("HL2BSP.Transform"), NumTransformChunks, 1, [&](int32 Chunk)
+        {
+            const int32 First = Chunk * HL2BuildBatchSize * 16;
+            const int32 Count = FMath::Min(HL2BuildBatchSize * 16, NumPoints - First);
+            TArrayView<FVector3f> Stream(PointPositions.GetData() + First, Count);
+            Xform.TransformPositions(Stream, Stream);
+        });
+    }
+
+    // Weld points onto shared vertices (serial; hash insertion order keeps the result deterministic)
+    const int32 NumSourceVerts = Geo.Positions.Num();
+    FHL2VertexWelder Welder(NumSourceVerts, Sets ? Sets->VertexWeldTolerance : 0.05f);
+    Welder.Positions.Reserve(NumSourceVerts);
+    TArray<int32> PointVertex; PointVertex.SetNumUninitialized(NumPoints);
+    {
+        HL2_STAGE_SCOPE(STAT_HL2_BuildWeld);
+        for (int32 p = 0; p < NumPoints; ++p)
+        {
+            PointVertex[p] = PointSources[p] == HL2UnsharedPoint ? Welder.AddUnshared(PointPositions[p]) : Welder.WeldSource(PointSources[p], PointPositions[p]);
+        }
+    }
+    PointSources.Empty();
+
+    // Tangent frames: one region per plan, in plan order, so region points and triangles are the plans' ranges
+    FHL2TangentFrames Frames;
+    double NormalsSeconds = 0.0;
+    {
+        const double NormalsStart = FPlatformTime::Seconds();
+        const FHL2CoordTransform Xform = FHL2CoordTransform::FromSettings(Sets);
+        TConstArrayView<DPlane> Planes;
+        Bsp.GetLumpView(BspLump::Planes, Planes);
+        TArray<FHL2NormalRegion> Regions;
+        Regions.Reserve(FacePlans.Num() + DispPlans.Num());
+        for (const FHL2FacePlan& Plan : FacePlans)
+        {
+            FHL2NormalRegion& Region = Regions.AddDefaulted_GetRef();
+            Region.FirstPoint = Plan.FirstPoint;
+            Region.FirstTri = Plan.FirstTri;
+            Region.NumTris = Plan.NumCorners - 2;
+            Region.SmoothingGroups = Geo.FaceSmoothingGroups[Plan.Face];
+            const int32 PlaneIndex = Geo.FacePlane[Plan.Face] >> 1;
+            if (Planes.IsValidIndex(PlaneIndex))
+            {
+                const DPlane& Plane = Planes[PlaneIndex];
+                const FVector3f Normal(Plane.Normal[0], Plane.Normal[1], Plane.Normal[2]);
+                Region.PlaneNormal = Xform.TransformVector((Geo.FacePlane[Plan.Face] & 1) ? -Normal : Normal).GetSafeNormal();
+            }
+        }
+        for (const FHL2DispPlan& Plan : DispPlans)
+        {
+            FHL2NormalRegion& Region = Regions.AddDefaulted_GetRef();
+            Region.FirstPoint = Plan.FirstPoint;
+            Region.FirstTri = Plan.FirstTri;
+            Region.NumTris = Plan.NumTris;
+            Region.SmoothingGroups = Geo.FaceSmoothingGroups[Plan.BaseFace] | HL2DispSmoothingGroup;
+        }
+        ComputeTangentFrames(Regions, PointPositions, PointUVs, PointVertex, Welder.Positions.Num(), TriPoints, Frames);
+        NormalsSeconds = FPlatformTime::Seconds() - NormalsStart;
+    }
+
+    // Phase 3: reserve, create elements, fill attributes in parallel, then link triangles
+    HL2_STAGE_SCOPE(STAT_HL2_BuildElements);
+    const int32 NumVertices = Welder.Positions.Num();
+    MD.ReserveNewVertices(NumVertices);
+    MD.ReserveNewVertexInstances(NumPoints);
+    MD.ReserveNewTriangles(NumTris);
+
+    TArray<FVertexID> VertexIDs; VertexIDs.SetNumUninitialized(NumVertices);
+    for (int32 v = 0; v < NumVertices; ++v)
+    {
+        VertexIDs[v] = MD.CreateVertex();
+    }
+    ParallelFor(TEXT("HL2BSP.Positions"), NumVertices, HL2BuildBatchSize * 4, [&](int32 v)
+    {
+        VertexPositions[VertexIDs[v]] = Welder.Positions[v];
+    });
+
+    TArray<FVertexInstanceID> InstanceIDs; InstanceIDs.SetNumUninitialized(NumPoints);
+    for (int32 p = 0; p < NumPoints; ++p)
+    {
+        InstanceIDs[p] = MD.CreateVertexInstance(VertexIDs[PointVertex[p]]);
+    }
+    ParallelFor(TEXT("HL2BSP.Instances"), NumPoints, HL2BuildBatchSize * 4, [&](int32 p)
+    {
+        const FVertexInstanceID J = InstanceIDs[p];
+        InstanceUVs.Set(J, 0, PointUVs[p]);
+        if (bLightmapUVs) InstanceUVs.Set(J, 1, PointLightmapUVs[p]);
+        InstanceNormals[J] = Frames.Normals[p];
+        InstanceTangents[J] = Frames.Tangents[p];
+        InstanceBinormalSigns[J] = Frames.BinormalSigns[p];
+        InstanceColors[J] = FVector4f(1.f, 1.f, 1.f, PointAlphas[p]);
+    });
+
+    for (int32 t = 0; t < NumTris; ++t)
+    {
+        const FVertexInstanceID Tri[3] = { InstanceIDs[TriPoints[t * 3 + 0]], InstanceIDs[TriPoints[t * 3 + 1]], InstanceIDs[TriPoints[t * 3 + 2]] };
+        MD.CreateTriangle(TriGroups[t], MakeArrayView(Tri, 3));
+    }
+
+    if (OutStats)
+    {
+        OutStats->FacesBuilt = PartFaces.Num();
+        OutStats->FacesMerged = Merged.FacesMerged;
+        OutStats->CollinearCornersRemoved = Merged.CollinearRemoved;
+        OutStats->FacesSkipped = FacesSkipped;
+        OutStats->DispsBuilt = DispPlans.Num();
+        OutStats->DispsSkipped = DispsSkipped;
+        OutStats->DispNodesStitched = DispNodesStitched;
+        OutStats->Vertices = NumVertices;
+        OutStats->VertexInstances = NumPoints;
+        OutStats->Triangles = NumTris;
+        OutStats->DegenerateTriangles = Frames.DegenerateTriangles;
+        OutStats->CollapsedTriangles = Frames.CollapsedTriangles;
+        OutStats->NormalsSeconds = NormalsSeconds;
+        OutStats->LightmapCharts = Lightmap.Charts.Num();
+        OutStats->LightmapSize = Lightmap.Size;
+        OutStats->TrianglesPerSlot.Init(0, OutMaterialSlotNames.Num());
+        for (const FPolygonGroupID PG : TriGroups)
+        {
+            ++OutStats->TrianglesPerSlot[PolygonGroupSlot[PG.GetValue()]];
+        }
+    }
+
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("BSP build: DispLODShift=%d Faces=%d Polygons=%d MergedAway=%d CollinearRemoved=%d Disps=%d SkippedFaces=%d SkippedDisps=%d StitchedNodes=%d V=%d VI=%d T=%d DegenerateT=%d CollapsedT=%d PG=%d Slots=%d"),
+        DispLODShift, PartFaces.Num(), FacePlans.Num(), Merged.FacesMerged, Merged.CollinearRemoved, DispPlans.Num(), FacesSkipped, DispsSkipped, DispNodesStitched, MD.Vertices().Num(), MD.VertexInstances().Num(), MD.Triangles().Num(),
+        Frames.DegenerateTriangles, Frames.CollapsedTriangles, MD.PolygonGroups().Num(), OutMaterialSlotNames.Num());
+    if (OutLightmap)
+    {
+        *OutLightmap = MoveTemp(Lightmap);
+    }
+    return MD;
+}
@@ -0,0 +1,319 @@
+#include "HL2BrushCollision.h"
+#include "HL2BSPImporter.h"
+#include "BspFile.h"
+#include "HL2CoordTransform.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+// Brush collision: each brush is the intersection of the back half-spaces of its side planes (Dot(N, P) <= Dist).
+// Clipping a large winding on every side plane by all the others yields the brush faces; their corners are the hull.
+// Runs in Source units and double precision; only the finished points are moved to Unreal space.
+
+DECLARE_CYCLE_STAT(TEXT("Brush Hulls"), STAT_HL2_BrushHulls, STATGROUP_HL2BSPImporter);
+
+static constexpr double HL2HullWindingExtent = 131072.0;  // larger than any VBSP coordinate (MAX_COORD_INTEGER is 16384)
+static constexpr double HL2HullClipEpsilon = 0.01;        // ON_EPSILON in Source's tools
+static constexpr double HL2HullWeldEpsilon = 0.01;        // points closer than this are one hull vertex
+static constexpr double HL2HullMinThickness = 0.1;        // thinner brushes cannot be cooked into a convex
+
+struct FHL2HullPlane
+{
+    FVector3d Normal;
+    double Dist;
+};
+
+const TCHAR* GetCollisionGroupName(EHL2CollisionGroup Group)
+{
+    switch (Group)
+    {
+    case EHL2CollisionGroup::Solid: return TEXT("Solid");
+    case EHL2CollisionGroup::Window: return TEXT("Window");
+    case EHL2CollisionGroup::Grate: return TEXT("Grate");
+    case EHL2CollisionGroup::PlayerClip: return TEXT("PlayerClip");
+    case EHL2CollisionGroup::MonsterClip: return TEXT("MonsterClip");
+    default: return TEXT("Unknown");
+    }
+}
+
+static bool ClassifyContents(int32 Contents, EHL2CollisionGroup& OutGroup)
+{
+    if (Contents & BspContents::Solid) { OutGroup = EHL2CollisionGroup::Solid; return true; }
+    if (Contents & BspContents::Window) { OutGroup = EHL2CollisionGroup::Window; return true; }
+    if (Contents & BspContents::Grate) { OutGroup = EHL2CollisionGroup::Grate; return true; }
+    if (Contents & BspContents::PlayerClip) { OutGroup = EHL2CollisionGroup::PlayerClip; return true; }
+    if (Contents & BspContents::MonsterClip) { OutGroup = EHL2CollisionGroup::MonsterClip; return true; }
+    return false;
+}
+
+// Square on Plane, centred on the point closest to the origin and larger than the map
+static void BaseWindingForPlane(const FHL2HullPlane& Plane, TArray<FVector3d>& Out)
+{
+    const FVector3d& N = Plane.Normal;
+    FVector3d Up = FMath::Abs(N.Z) >= FMath::Abs(N.X) && FMath::Abs(N.Z) >= FMath::Abs(N.Y) ? FVector3d(1, 0, 0) : FVector3d(0, 0, 1);
+    Up = (Up - N * Up.Dot(N)).GetSafeNormal() * HL2HullWindingExtent;
+    const FVector3d Right = Up.Cross(N);
+    const FVector3d Org = N * Plane.Dist;
+
+    Out.Reset();
+    Out.Add(Org - Right + Up);
+    Out.Add(Org + Right + Up);
+    Out.Add(Org + Right - Up);
+    Out.Add(Org - Right - Up);
+}
+
+// Keeps the part of In behind Plane (points within the epsilon count as on the plane and stay)
+static void ClipWinding(const TArray<FVector3d>& In, const FHL2HullPlane& Plane, TArray<FVector3d>& Out)
+{
+    Out.Reset();
+    const int32 N = In.Num();
+    for (int32 i = 0; i < N; ++i)
+    {
+        const FVector3d& A = In[i];
+        const FVector3d& B = In[(i + 1) % N];
+        const double DA = A.Dot(Plane.Normal) - Plane.Dist;
+        const double DB = B.Dot(Plane.Normal) - Plane.Dist;
+        if (DA <= HL2HullClipEpsilon)
+        {
+            Out.Add(A);
+        }
+        if ((DA > HL2HullClipEpsilon && DB < -HL2HullClipEpsilon) || (DA < -HL2HullClipEpsilon && DB > HL2HullClipEpsilon))
+        {
+            Out.Add(A + (B - A) * (DA / (DA - DB)));
+        }
+    }
+}
+
+// True if Points span a volume: a base triangle plus one point clearly off its plane
+static bool HasVolume(const TArray<FVector3d>& Points)
+{
+    if (Points.Num() < 4)
+    {
+        return false;
+    }
+    const FVector3d P0 = Points[0];
+    int32 I1 = 1;
+    for (int32 i = 2; i < Points.Num(); ++i)
+    {
+        if (FVector3d::DistSquared(Points[i], P0) > FVector3d::DistSquared(Points[I1], P0)) I1 = i;
+    }
+    const FVector3d Axis = Points[I1] - P0;
+    FVector3d Normal = FVector3d::ZeroVector;
+    for (const FVector3d& P : Points)
+    {
+        const FVector3d Candidate = Axis.Cross(P - P0);
+        if (Candidate.SizeSquared() > Normal.SizeSquared()) Normal = Candidate;
+    }
+    if (!Normal.Normalize())
+    {
+        return false;
+    }
+    for (const FVector3d& P : Points)
+    {
+        if (FMath::Abs((P - P0).Dot(Normal)) > HL2HullMinThickness)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Corners of one brush in Source space; false if the planes do not close a volume
+static bool BuildHullPoints(TConstArrayView<FHL2HullPlane> Planes, TArray<FVector3d>& OutPoints)
+{
+    TArray<FVector3d> Winding;
+    TArray<FVector3d> Clipped;
+    OutPoints.Reset();
+    for (int32 i = 0; i < Planes.Num(); ++i)
+    {
+        BaseWindingForPlane(Planes[i], Winding);
+        for (int32 j = 0; j < Planes.Num() && Winding.Num() >= 3; ++j)
+        {
+            if (j == i) continue;
+            ClipWinding(Winding, Planes[j], Clipped);
+            Swap(Winding, Clipped);
+        }
+        if (Winding.Num() < 3)
+        {
+            continue;
+        }
+        for (const FVector3d& P : Winding)
+        {
+            const bool bKnown = OutPoints.ContainsByPredicate([&P](const FVector3d& Q) { return FVector3d::DistSquared(P, Q) <= HL2HullWeldEpsilon * HL2HullWeldEpsilon; });
+            if (!bKnown)
+            {
+                OutPoints.Add(P);
+            }
+        }
+    }
+    return HasVolume(OutPoints);
+}
+
+void BuildBrushHulls(const FBspFile& Bsp, const FHL2CoordTransform& Xform, uint32 GroupMask,
+                     TArray<FHL2BrushHull>& OutHulls, FHL2BrushCollisionStats& OutStats)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_BrushHulls);
+    const double Start = FPlatformTime::Seconds();
+    OutHulls.Reset();
+    OutStats = FHL2BrushCollisionStats();
+
+    TConstArrayView<DPlane> Planes;
+    TConstArrayView<DBrush> Brushes;
+    TConstArrayView<DBrushSide> Sides;
+    if (!Bsp.GetLumpView(BspLump::Planes, Planes) || !Bsp.GetLumpView(BspLump::Brushes, Brushes) || !Bsp.GetLumpView(BspLump::BrushSides, Sides))
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("Brush collision: plane/brush lumps are out of bounds; no hulls built."));
+        return;
+    }
+
+    enum class EHullResult : uint8 { Skipped, Degenerate, Built };
+    TArray<FHL2BrushHull> BrushHulls;
+    TArray<EHullResult> Results;
+    BrushHulls.SetNum(Brushes.Num());
+    Results.SetNumZeroed(Brushes.Num());
+
+    ParallelFor(TEXT("HL2BSP.BrushHulls"), Brushes.Num(), 32, [&](int32 b)
+    {
+        const DBrush& Brush = Brushes[b];
+        EHL2CollisionGroup Group;
+        if (!ClassifyContents(Brush.Contents, Group) || !(GroupMask & (1u << (uint32)Group)))
+        {
+            Results[b] = EHullResult::Skipped;
+            return;
+        }
+        if (Brush.FirstSide < 0 || Brush.NumSides < 4 || Brush.FirstSide + Brush.NumSides > Sides.Num())
+        {
+            Results[b] = EHullResult::Degenerate;
+            return;
+        }
+
+        TArray<FHL2HullPlane, TInlineAllocator<32>> HullPlanes;
+        for (int32 s = 0; s < Brush.NumSides; ++s)
+        {
+            const int32 PlaneIndex = Sides[Brush.FirstSide + s].Planenum;
+            if (PlaneIndex >= Planes.Num())
+            {
+                Results[b] = EHullResult::Degenerate;
+                return;
+            }
+            const DPlane& P = Planes[PlaneIndex];
+            HullPlanes.Add({ FVector3d(P.Normal[0], P.Normal[1], P.Normal[2]), (double)P.Dist });
+        }
+
+        TArray<FVector3d> Points;
+        if (!BuildHullPoints(HullPlanes, Points))
+        {
+            Results[b] = EHullResult::Degenerate;
+            return;
+        }
+
+        FHL2BrushHull& Hull = BrushHulls[b];
+        Hull.Brush = b;
+        Hull.Group = Group;
+        Hull.Points.SetNumUninitialized(Points.Num());
+        for (int32 i = 0; i < Points.Num(); ++i)
+        {
+            Hull.Points[i] = FVector3f(Points[i]);
+        }
+        Xform.TransformPositions(Hull.Points, Hull.Points);
+        Results[b] = EHullResult::Built;
+    });
+
+    // Group order, then brush order, so element indices are stable between imports
+    for (int32 g = 0; g < (int32)EHL2CollisionGroup::Num; ++g)
+    {
+        for (int32 b = 0; b < Brushes.Num(); ++b)
+        {
+            if (Results[b] == EHullResult::Built && BrushHulls[b].Group == (EHL2CollisionGroup)g)
+            {
+                OutStats.Hulls[g]++;
+                OutStats.Points += BrushHulls[b].Points.Num();
+                OutHulls.Add(MoveTemp(BrushHulls[b]));
+            }
+        }
+    }
+    for (EHullResult Result : Results)
+    {
+        OutStats.BrushesSkipped += Result == EHullResult::Skipped ? 1 : 0;
+        OutStats.BrushesDegenerate += Result == EHullResult::Degenerate ? 1 : 0;
+    }
+    OutStats.Seconds = FPlatformTime::Seconds() - Start;
+
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Brush collision: %d hulls (Solid=%d Window=%d Grate=%d PlayerClip=%d MonsterClip=%d) from %d brushes, skipped=%d degenerate=%d points=%d in %.1f ms"),
+        OutStats.TotalHulls(), OutStats.Hulls[0], OutStats.Hulls[1], OutStats.Hulls[2], OutStats.Hulls[3], OutStats.Hulls[4],
+        Brushes.Num(), OutStats.BrushesSkipped, OutStats.BrushesDegenerate, OutStats.Points, OutStats.Seconds * 1000.0);
+}
+
+void GetModelBrushes(const FBspFile& Bsp, int32 HeadNode, TArray<int32>& OutBrushes)
+{
+    OutBrushes.Reset();
+    TConstArrayView<DNode> Nodes;
+    TConstArrayView<uint8> LeafBytes;
+    TConstArrayView<uint16> LeafBrushes;
+    const FBspHeader* Header = Bsp.GetHeader();
+    if (!Header || !Bsp.GetLumpView(BspLump::Nodes, Nodes) || !Bsp.GetLumpView(BspLump::Leafs, LeafBytes)
+        || !Bsp.GetLumpView(BspLump::LeafBrushes, LeafBrushes) || !Nodes.IsValidIndex(HeadNode))
+    {
+        return;
+    }
+    // Both leaf versions share the dleaf_t prefix holding the brush range
+    const int32 LeafSize = Header->Lumps[BspLump::Leafs].Version == 0 ? (int32)sizeof(DLeaf) + 24 : (int32)sizeof(DLeaf);
+    const int32 NumLeafs = LeafBytes.Num() / LeafSize;
+
+    TBitArray<> Listed;
+    TArray<int32, TInlineAllocator<64>> Stack;
+    Stack.Add(HeadNode);
+    while (Stack.Num() > 0)
+    {
+        const int32 Node = Stack.Pop(EAllowShrinking::No);
+        for (int32 c = 0; c < 2; ++c)
+        {
+            const int32 Child = Nodes[Node].Children[c];
+            if (Child >= 0)
+            {
+                // vbsp writes children after their parent; requiring that keeps the walk finite on a corrupt lump
+                if (Child > Node && Child < Nodes.Num()) Stack.Add(Child);
+                continue;
+            }
+            if (-1 - Child >= NumLeafs) continue;
+            DLeaf Leaf;
+            FMemory::Memcpy(&Leaf, LeafBytes.GetData() + (int64)(-1 - Child) * LeafSize, sizeof(DLeaf) - sizeof(int16));
+            if (Leaf.FirstLeafBrush + Leaf.NumLeafBrushes > LeafBrushes.Num()) continue;
+            for (int32 i = Leaf.FirstLeafBrush; i < Leaf.FirstLeafBrush + Leaf.NumLeafBrushes; ++i)
+            {
+                const int32 Brush = LeafBrushes[i];
+                if (Brush >= Listed.Num())
+                {
+                    Listed.Add(false, Brush + 1 - Listed.Num());
+                }
+                if (!Listed[Brush])
+                {
+                    Listed[Brush] = true;
+                    OutBrushes.Add(Brush);
+                }
+            }
+        }
+    }
+    OutBrushes.Sort();
+}
+
+void ApplyBrushHulls(UBodySetup* BodySetup, TConstArrayView<FHL2BrushHull> Hulls)
+{
+    check(IsInGameThread());
+    BodySetup->Modify();
+    BodySetup->AggGeom.ConvexElems.Reset(Hulls.Num());
+    for (const FHL2BrushHull& Hull : Hulls)
+    {
+        FKConvexElem& Elem = BodySetup->AggGeom.ConvexElems.AddDefaulted_GetRef();
+        Elem.VertexData.Reserve(Hull.Points.Num());
+        for (const FVector3f& P : Hull.Points)
+        {
+            Elem.VertexData.Add(FVector(P));
+        }
+        Elem.UpdateElemBox();
+        Elem.SetName(FName(GetCollisionGroupName(Hull.Group)));
+    }
+    BodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+    BodySetup->InvalidatePhysicsData();
+    BodySetup->CreatePhysicsMeshes();
+}
@@ -0,0 +1,235 @@
+#include "HL2BrushModels.h"
+#include "HL2BSPImporter.h"
+#include "BspFile.h"
+#include "HL2CoordTransform.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "Hash/xxhash.h"
+#include "UObject/Package.h"
+
+// Brush entity models -> one mesh per distinct geometry, one static mesh actor per entity in a companion level.
+
+DECLARE_CYCLE_STAT(TEXT("Brush Models"), STAT_HL2_BrushModels, STATGROUP_HL2BSPImporter);
+
+static constexpr float HL2BrushKeyPositionScale = 32.f;   // key positions quantized to 1/32 Source unit
+static constexpr float HL2BrushKeyUVScale = 1024.f;
+
+// Brush entity classes that move (or break) at runtime; their actors are Movable, everything else Static
+static const TCHAR* HL2MovableBrushClasses[] =
+{
+    TEXT("func_door"), TEXT("func_door_rotating"), TEXT("func_rotating"), TEXT("func_movelinear"), TEXT("func_tracktrain"),
+    TEXT("func_train"), TEXT("func_button"), TEXT("func_rot_button"), TEXT("func_physbox"), TEXT("func_breakable"),
+    TEXT("func_breakable_surf"), TEXT("func_platrot"), TEXT("func_pushable"), TEXT("func_water_analog"), TEXT("func_conveyor"),
+};
+
+static bool IsMovableBrushClass(const FString& Class)
+{
+    for (const TCHAR* Movable : HL2MovableBrushClasses)
+    {
+        if (Class.Equals(Movable, ESearchCase::IgnoreCase))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// "*12" -> 12; INDEX_NONE for anything else (studio models, world, malformed values)
+static int32 ParseBrushModelIndex(const FString& Model)
+{
+    if (Model.Len() < 2 || Model[0] != TEXT('*') || !FCString::IsNumeric(*Model + 1))
+    {
+        return INDEX_NONE;
+    }
+    return FCString::Atoi(*Model + 1);
+}
+
+// Kept faces of one model and its geometry key: per face the texture and corner count, per corner the position
+// relative to the centre of the faces' bounds and the UV relative to the face's first integer texture offset.
+// Models with equal keys render the same once moved onto each other.
+struct FHL2BrushModelKey
+{
+    TArray<int32> Faces;
+    TArray<int32> Key;
+    FVector3f Centre = FVector3f::ZeroVector;   // Source space
+    uint64 Hash = 0;
+};
+
+static void BuildBrushModelKey(const FBspGeometry& Geo, const FBspModel& Model, FHL2BrushModelKey& Out)
+{
+    FBox3f Bounds(ForceInit);
+    for (int32 f = Model.FirstFace; f < Model.FirstFace + Model.NumFaces; ++f)
+    {
+        if ((Geo.FaceFlags[f] & (BspFaceFlags::Culled | BspFaceFlags::Sky)) || Geo.FaceNumCorners[f] < 3) continue;
+        Out.Faces.Add(f);
+        for (int32 c = 0; c < Geo.FaceNumCorners[f]; ++c)
+        {
+            Bounds += Geo.Positions[Geo.Indices[Geo.FaceFirstCorner[f] + c]];
+        }
+    }
+    if (Out.Faces.Num() == 0)
+    {
+        return;
+    }
+    Out.Centre = Bounds.GetCenter();
+    for (int32 f : Out.Faces)
+    {
+        const int32 First = Geo.FaceFirstCorner[f];
+        const FVector2f UVBase(FMath::FloorToFloat(Geo.UVs[First].X), FMath::FloorToFloat(Geo.UVs[First].Y));
+        Out.Key.Add(Geo.FaceTexture[f]);
+        Out.Key.Add(Geo.FaceNumCorners[f]);
+        for (int32 c = 0; c < Geo.FaceNumCorners[f]; ++c)
+        {
+            const FVector3f P = (Geo.Positions[Geo.Indices[First + c]] - Out.Centre) * HL2BrushKeyPositionScale;
+            const FVector2f UV = (Geo.UVs[First + c] - UVBase) * HL2BrushKeyUVScale;
+            Out.Key.Add(FMath::RoundToInt(P.X));
+            Out.Key.Add(FMath::RoundToInt(P.Y));
+            Out.Key.Add(FMath::RoundToInt(P.Z));
+            Out.Key.Add(FMath::RoundToInt(UV.X));
+            Out.Key.Add(FMath::RoundToInt(UV.Y));
+        }
+    }
+    Out.Hash = FXxHash64::HashBuffer(Out.Key.GetData(), Out.Key.Num() * sizeof(int32)).Hash;
+}
+
+void GroupBrushModels(const FBspFile& Bsp, const FHL2CoordTransform& Xform, TArray<FHL2BrushModelGroup>& OutGroups,
+                      TArray<FHL2BrushEntityPlacement>& OutPlacements, FHL2BrushModelStats& OutStats)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_BrushModels);
+    const FBspGeometry& Geo = Bsp.GetGeometry();
+    const TArray<FBspModel>& Models = Bsp.GetModels();
+    const TArray<FHL2Entity>& Entities = Bsp.GetEntities();
+    OutGroups.Reset();
+    OutPlacements.Reset();
+    OutStats = FHL2BrushModelStats();
+    OutStats.Models = FMath::Max(0, Models.Num() - 1);
+
+    // Entity -> model, and the models anything refers to
+    TArray<int32> EntityModel;
+    EntityModel.Init(INDEX_NONE, Entities.Num());
+    TArray<int32> Referenced;
+    for (int32 e = 0; e < Entities.Num(); ++e)
+    {
+        const int32 Model = ParseBrushModelIndex(Entities[e].Model);
+        if (Model > 0 && Model < Models.Num())
+        {
+            EntityModel[e] = Model;
+            Referenced.AddUnique(Model);
+        }
+    }
+    Referenced.Sort();
+    OutStats.Referenced = Referenced.Num();
+
+    TArray<FHL2BrushModelKey> Keys;
+    Keys.SetNum(Referenced.Num());
+    ParallelFor(TEXT("HL2BSP.BrushModelKeys"), Referenced.Num(), 16, [&](int32 i)
+    {
+        BuildBrushModelKey(Geo, Models[Referenced[i]], Keys[i]);
+    });
+
+    // Model -> group; equal hashes are confirmed on the full key
+    TArray<int32> ModelGroup;
+    ModelGroup.Init(INDEX_NONE, Models.Num());
+    TArray<FVector3f> ModelPivot;
+    ModelPivot.Init(FVector3f::ZeroVector, Models.Num());
+    TMultiMap<uint64, int32> GroupsByHash;
+    TArray<int32> GroupKey;
+    for (int32 i = 0; i < Referenced.Num(); ++i)
+    {
+        const FHL2BrushModelKey& Key = Keys[i];
+        if (Key.Faces.Num() == 0)
+        {
+            ++OutStats.Empty;
+            continue;
+        }
+        const int32 Model = Referenced[i];
+        ModelPivot[Model] = Xform.TransformVector(Key.Centre);
+        int32 Group = INDEX_NONE;
+        for (auto It = GroupsByHash.CreateConstKeyIterator(Key.Hash); It && Group == INDEX_NONE; ++It)
+        {
+            Group = Keys[GroupKey[It.Value()]].Key == Key.Key ? It.Value() : INDEX_NONE;
+        }
+        if (Group == INDEX_NONE)
+        {
+            Group = OutGroups.Num();
+            FHL2BrushModelGroup& NewGroup = OutGroups.AddDefaulted_GetRef();
+            NewGroup.Faces.Init(false, Geo.NumFaces());
+            for (int32 f : Key.Faces)
+            {
+                NewGroup.Faces[f] = true;
+            }
+            NewGroup.Pivot = ModelPivot[Model];
+            GroupKey.Add(i);
+            GroupsByHash.Add(Key.Hash, Group);
+        }
+        OutGroups[Group].Models.Add(Model);
+        ModelGroup[Model] = Group;
+    }
+
+    for (int32 e = 0; e < Entities.Num(); ++e)
+    {
+        const int32 Model = EntityModel[e];
+        if (Model == INDEX_NONE || ModelGroup[Model] == INDEX_NONE)
+        {
+            continue;
+        }
+        const FHL2Entity& Entity = Entities[e];
+        const FQuat Rotation = Xform.TransformAngles(FVector3f(Entity.Rotation.Pitch, Entity.Rotation.Yaw, Entity.Rotation.Roll));
+        const FVector Origin = FVector(Xform.TransformPosition(FVector3f(Entity.Origin)));
+
+        FHL2BrushEntityPlacement& Placement = OutPlacements.AddDefaulted_GetRef();
+        Placement.Entity = e;
+        Placement.Group = ModelGroup[Model];
+        Placement.Transform = FTransform(Rotation, Origin + Rotation.RotateVector(FVector(ModelPivot[Model])));
+        Placement.Label = !Entity.Name.IsEmpty() ? Entity.Name : FString::Printf(TEXT("%s_%d"), *Entity.Class, e);
+        Placement.bMovable = IsMovableBrushClass(Entity.Class);
+    }
+    OutStats.Groups = OutGroups.Num();
+    OutStats.Placements = OutPlacements.Num();
+
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Brush models: %d submodels, %d referenced (%d empty) -> %d distinct meshes for %d entities"),
+        OutStats.Models, OutStats.Referenced, OutStats.Empty, OutStats.Groups, OutStats.Placements);
+}
+
+UWorld* CreateBrushEntityWorld(TConstArrayView<FHL2BrushEntityPlacement> Placements, TConstArrayView<UStaticMesh*> GroupMeshes,
+                               UPackage* Package, FName Name, EObjectFlags Flags)
+{
+    check(IsInGameThread());
+    HL2_STAGE_SCOPE(STAT_HL2_BrushModels);
+    if (Placements.Num() == 0)
+    {
+        return nullptr;
+    }
+
+    UWorld* World = UWorld::CreateWorld(EWorldType::Inactive, false, Name, Package, false);
+    World->SetFlags(Flags);
+    int32 NumActors = 0;
+    for (const FHL2BrushEntityPlacement& Placement : Placements)
+    {
+        UStaticMesh* Mesh = GroupMeshes.IsValidIndex(Placement.Group) ? GroupMeshes[Placement.Group] : nullptr;
+        if (!Mesh)
+        {
+            continue;
+        }
+        AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Placement.Transform.GetLocation(), Placement.Transform.Rotator());
+        Actor->SetActorLabel(Placement.Label);
+        UStaticMeshComponent* Component = Actor->GetStaticMeshComponent();
+        Component->SetMobility(Placement.bMovable ? EComponentMobility::Movable : EComponentMobility::Static);
+        Component->SetStaticMesh(Mesh);
+        ++NumActors;
+    }
+    if (NumActors == 0)
+    {
+        World->DestroyWorld(false);
+        return nullptr;
+    }
+
+    FAssetRegistryModule::AssetCreated(World);
+    World->MarkPackageDirty();
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Created brush entity level %s: %d actors sharing %d meshes"), *World->GetName(), NumActors, GroupMeshes.Num());
+    return World;
+}
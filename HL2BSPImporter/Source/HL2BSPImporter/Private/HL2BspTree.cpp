@@ -0,0 +1,302 @@
+#include "HL2BspTree.h"
+#include "HL2BSPImporter.h"
+#include "BspFile.h"
+#include "Async/ParallelFor.h"
+
+// World node/leaf tree: spatial queries and PVS decoding.
+
+static constexpr int32 HL2LeafSizeV0 = 56;   // dleaf_version_0_t: dleaf_t + CompressedLightCube
+static constexpr int32 HL2LeafSizeV1 = 32;
+
+void FHL2BspTree::Reset()
+{
+    Nodes.Reset();
+    Leafs.Reset();
+    LeafFaces.Reset();
+    Visibility.Reset();
+    NumClusters = 0;
+    Areas.Reset();
+    AreaPortals.Reset();
+}
+
+bool FHL2BspTree::Load(const FBspFile& Bsp)
+{
+    Reset();
+    TConstArrayView<DPlane> Planes;
+    TConstArrayView<DNode> SrcNodes;
+    TConstArrayView<uint8> LeafBytes;
+    TConstArrayView<uint16> SrcLeafFaces;
+    TConstArrayView<uint8> Vis;
+    TConstArrayView<DArea> SrcAreas;
+    TConstArrayView<DAreaPortal> SrcAreaPortals;
+    if (!Bsp.GetLumpView(BspLump::Planes, Planes) || !Bsp.GetLumpView(BspLump::Nodes, SrcNodes) || !Bsp.GetLumpView(BspLump::Leafs, LeafBytes)
+        || !Bsp.GetLumpView(BspLump::LeafFaces, SrcLeafFaces) || !Bsp.GetLumpView(BspLump::Visibility, Vis)
+        || !Bsp.GetLumpView(BspLump::Areas, SrcAreas) || !Bsp.GetLumpView(BspLump::AreaPortals, SrcAreaPortals))
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("BSP tree lumps are out of bounds; tree skipped"));
+        return false;
+    }
+
+    const int32 LeafVersion = Bsp.GetHeader()->Lumps[BspLump::Leafs].Version;
+    const int32 LeafSize = LeafVersion == 0 ? HL2LeafSizeV0 : HL2LeafSizeV1;
+    const int32 NumLeafs = LeafBytes.Num() / LeafSize;
+    if (NumLeafs == 0)
+    {
+        return false;
+    }
+    if (LeafVersion > 1)
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("LUMP_LEAFS version %d is not supported (0-1); tree skipped"), LeafVersion);
+        return false;
+    }
+
+    Leafs.SetNumUninitialized(NumLeafs);
+    for (int32 l = 0; l < NumLeafs; ++l)
+    {
+        // Both versions share the dleaf_t prefix; copy it out so unaligned lumps are fine
+        DLeaf Src;
+        FMemory::Memcpy(&Src, LeafBytes.GetData() + (int64)l * LeafSize, sizeof(DLeaf) - sizeof(int16));
+        FHL2BspLeaf& Leaf = Leafs[l];
+        Leaf.Contents = Src.Contents;
+        Leaf.Cluster = Src.Cluster;
+        Leaf.Area = Src.AreaFlags & 0x1FF;
+        Leaf.FirstLeafFace = Src.FirstLeafFace;
+        Leaf.NumLeafFaces = Src.FirstLeafFace + Src.NumLeafFaces <= SrcLeafFaces.Num() ? Src.NumLeafFaces : 0;
+    }
+
+    Nodes.SetNumUninitialized(SrcNodes.Num());
+    for (int32 n = 0; n < SrcNodes.Num(); ++n)
+    {
+        const DNode& Src = SrcNodes[n];
+        FHL2BspNode& Node = Nodes[n];
+        for (int32 c = 0; c < 2; ++c)
+        {
+            const int32 Child = Src.Children[c];
+            // Out-of-range children become leaf 0, the solid leaf every VBSP map starts with. vbsp writes children
+            // after their parent; requiring that keeps walks finite on a corrupt lump.
+            Node.Children[c] = (Child >= 0 ? Child > n && Child < SrcNodes.Num() : -1 - Child < NumLeafs) ? Child : -1;
+        }
+        if (Planes.IsValidIndex(Src.PlaneNum))
+        {
+            const DPlane& Plane = Planes[Src.PlaneNum];
+            Node.Normal = FVector3f(Plane.Normal[0], Plane.Normal[1], Plane.Normal[2]);
+            Node.Dist = Plane.Dist;
+        }
+    }
+    LeafFaces.Append(SrcLeafFaces);
+
+    // Areas whose portal range does not fit the lump get no portals; portals to a missing area are dropped
+    Areas.SetNum(SrcAreas.Num());
+    for (int32 a = 0; a < SrcAreas.Num(); ++a)
+    {
+        const DArea& Src = SrcAreas[a];
+        if (Src.FirstAreaPortal < 0 || Src.NumAreaPortals < 0 || (int64)Src.FirstAreaPortal + Src.NumAreaPortals > SrcAreaPortals.Num()) continue;
+        Areas[a].FirstAreaPortal = AreaPortals.Num();
+        for (int32 p = Src.FirstAreaPortal; p < Src.FirstAreaPortal + Src.NumAreaPortals; ++p)
+        {
+            if (SrcAreaPortals[p].OtherArea < SrcAreas.Num())
+            {
+                AreaPortals.Add({ SrcAreaPortals[p].PortalKey, SrcAreaPortals[p].OtherArea });
+            }
+        }
+        Areas[a].NumAreaPortals = AreaPortals.Num() - Areas[a].FirstAreaPortal;
+    }
+
+    if (Vis.Num() >= (int32)sizeof(int32))
+    {
+        int32 Count = 0;
+        FMemory::Memcpy(&Count, Vis.GetData(), sizeof(int32));
+        if (Count > 0 && (int64)sizeof(int32) + (int64)Count * 2 * sizeof(int32) <= Vis.Num())
+        {
+            NumClusters = Count;
+            Visibility.Append(Vis);
+        }
+        else
+        {
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("LUMP_VISIBILITY header is invalid (clusters=%d bytes=%d); PVS ignored"), Count, Vis.Num());
+        }
+    }
+    return true;
+}
+
+int32 FHL2BspTree::PointInLeaf(const FVector3f& Point) const
+{
+    if (Nodes.Num() == 0)
+    {
+        return Leafs.Num() > 0 ? 0 : INDEX_NONE;
+    }
+    int32 Child = 0;
+    while (Child >= 0)
+    {
+        const FHL2BspNode& Node = Nodes[Child];
+        Child = Node.Children[FVector3f::DotProduct(Node.Normal, Point) - Node.Dist >= 0.f ? 0 : 1];
+    }
+    return -1 - Child;
+}
+
+bool FHL2BspTree::IsPointSolid(const FVector3f& Point, int32 ContentsMask) const
+{
+    const int32 Leaf = PointInLeaf(Point);
+    return Leaf != INDEX_NONE && (Leafs[Leaf].Contents & ContentsMask) != 0;
+}
+
+bool FHL2BspTree::TraceRay(const FVector3f& Start, const FVector3f& End, FHL2BspTraceResult& Out, int32 ContentsMask) const
+{
+    Out = FHL2BspTraceResult();
+    if (Leafs.Num() == 0)
+    {
+        return false;
+    }
+    // A piece of the segment still to walk: [T0, T1] in Child, entered through a plane facing Start with Normal
+    struct FSegment
+    {
+        int32 Child;
+        float T0;
+        float T1;
+        FVector3f Normal;
+    };
+    const FVector3f Delta = End - Start;
+    TArray<FSegment, TInlineAllocator<64>> Stack;
+    Stack.Add({ Nodes.Num() > 0 ? 0 : -1, 0.f, 1.f, FVector3f::ZeroVector });
+    while (Stack.Num() > 0)
+    {
+        const FSegment Seg = Stack.Pop(EAllowShrinking::No);
+        if (Seg.Child < 0)
+        {
+            const int32 Leaf = -1 - Seg.Child;
+            if ((Leafs[Leaf].Contents & ContentsMask) == 0) continue;
+            // Pieces are popped nearest first, so this is the first matching leaf along the segment
+            Out.bHit = true;
+            Out.bStartSolid = Seg.T0 <= 0.f;
+            Out.Fraction = Seg.T0;
+            Out.Position = Start + Delta * Seg.T0;
+            Out.Normal = Out.bStartSolid ? FVector3f::ZeroVector : Seg.Normal;
+            Out.Leaf = Leaf;
+            return true;
+        }
+        const FHL2BspNode& Node = Nodes[Seg.Child];
+        const float D0 = FVector3f::DotProduct(Node.Normal, Start + Delta * Seg.T0) - Node.Dist;
+        const float D1 = FVector3f::DotProduct(Node.Normal, Start + Delta * Seg.T1) - Node.Dist;
+        if (D0 >= 0.f && D1 >= 0.f)
+        {
+            Stack.Add({ Node.Children[0], Seg.T0, Seg.T1, Seg.Normal });
+            continue;
+        }
+        if (D0 < 0.f && D1 < 0.f)
+        {
+            Stack.Add({ Node.Children[1], Seg.T0, Seg.T1, Seg.Normal });
+            continue;
+        }
+        // Crosses the plane: the far piece goes on the stack first so the near one is walked first. Leaving the
+        // front side, the entered plane faces Start along +Normal; leaving the back side, along -Normal.
+        const int32 Near = D0 >= 0.f ? 0 : 1;
+        const float TMid = FMath::Clamp(Seg.T0 + (Seg.T1 - Seg.T0) * (D0 / (D0 - D1)), Seg.T0, Seg.T1);
+        Stack.Add({ Node.Children[Near ^ 1], TMid, Seg.T1, Near == 0 ? Node.Normal : -Node.Normal });
+        Stack.Add({ Node.Children[Near], Seg.T0, TMid, Seg.Normal });
+    }
+    return false;
+}
+
+void FHL2BspTree::BoxLeaves(const FBox3f& Box, TArray<int32>& OutLeaves) const
+{
+    // One bit per leaf instead of AddUnique, which is quadratic in the leaves a large box touches
+    TBitArray<> Listed(false, Leafs.Num());
+    for (int32 Leaf : OutLeaves)
+    {
+        if (Listed.IsValidIndex(Leaf)) Listed[Leaf] = true;
+    }
+    if (Nodes.Num() == 0)
+    {
+        if (Leafs.Num() > 0 && !Listed[0]) OutLeaves.Add(0);
+        return;
+    }
+    const FVector3f Center = Box.GetCenter();
+    const FVector3f Extent = Box.GetExtent();
+    TArray<int32, TInlineAllocator<64>> Stack;
+    Stack.Add(0);
+    while (Stack.Num() > 0)
+    {
+        const int32 Child = Stack.Pop(EAllowShrinking::No);
+        if (Child < 0)
+        {
+            const int32 Leaf = -1 - Child;
+            if (!Listed[Leaf])
+            {
+                Listed[Leaf] = true;
+                OutLeaves.Add(Leaf);
+            }
+            continue;
+        }
+        // Signed distance of the box centre against the box's projected radius on the plane normal
+        const FHL2BspNode& Node = Nodes[Child];
+        const float D = FVector3f::DotProduct(Node.Normal, Center) - Node.Dist;
+        const float R = FMath::Abs(Node.Normal.X) * Extent.X + FMath::Abs(Node.Normal.Y) * Extent.Y + FMath::Abs(Node.Normal.Z) * Extent.Z;
+        if (D >= -R) Stack.Add(Node.Children[0]);
+        if (D < R) Stack.Add(Node.Children[1]);
+    }
+}
+
+void FHL2BspTree::PointInLeafBatch(TConstArrayView<FVector3f> Points, TArrayView<int32> OutLeaves) const
+{
+    check(OutLeaves.Num() == Points.Num());
+    ParallelFor(TEXT("HL2BSP.PointInLeaf"), Points.Num(), BatchQueryBlock, [&](int32 i)
+    {
+        OutLeaves[i] = PointInLeaf(Points[i]);
+    });
+}
+
+void FHL2BspTree::TraceRayBatch(TConstArrayView<FHL2BspRay> Rays, TArrayView<FHL2BspTraceResult> OutResults, int32 ContentsMask) const
+{
+    check(OutResults.Num() == Rays.Num());
+    ParallelFor(TEXT("HL2BSP.TraceRay"), Rays.Num(), BatchQueryBlock, [&](int32 i)
+    {
+        TraceRay(Rays[i].Start, Rays[i].End, OutResults[i], ContentsMask);
+    });
+}
+
+bool FHL2BspTree::GetClusterPVS(int32 Cluster, TBitArray<>& OutVisible) const
+{
+    if (!HasVisibility())
+    {
+        OutVisible.Init(true, FMath::Max(NumClusters, 1));
+        return true;
+    }
+    if (Cluster < 0 || Cluster >= NumClusters)
+    {
+        return false;
+    }
+    int32 Offset = 0;
+    FMemory::Memcpy(&Offset, Visibility.GetData() + sizeof(int32) + (int64)Cluster * 2 * sizeof(int32), sizeof(int32));
+    OutVisible.Init(false, NumClusters);
+
+    // Non-zero bytes are 8 literal cluster bits; a zero byte is followed by how many zero bytes it stands for
+    const int32 NumBytes = (NumClusters + 7) / 8;
+    int32 Pos = Offset;
+    for (int32 Byte = 0; Byte < NumBytes; )
+    {
+        if (Pos < 0 || Pos >= Visibility.Num())
+        {
+            return false;
+        }
+        const uint8 Bits = Visibility[Pos++];
+        if (Bits == 0)
+        {
+            if (Pos >= Visibility.Num())
+            {
+                return false;
+            }
+            Byte += Visibility[Pos++];
+            continue;
+        }
+        for (int32 b = 0; b < 8; ++b)
+        {
+            const int32 Index = Byte * 8 + b;
+            if ((Bits & (1 << b)) && Index < NumClusters)
+            {
+                OutVisible[Index] = true;
+            }
+        }
+        ++Byte;
+    }
+    return true;
+}
@@ -0,0 +1,146 @@
+#include "HL2CoordTransform.h"
+#include "HL2BSPImporter.h"
+#include "HL2BSPImporterSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Math/VectorRegister.h"
+
+FHL2CoordTransform FHL2CoordTransform::FromSettings(const UHL2BSPImporterSettings* Sets)
+{
+    const float Scale = Sets ? Sets->WorldScale : 1.f;
+    const bool bFlipYZ = Sets && Sets->bFlipYZ;
+
+    // Optional Y/Z swap, then flip Y sign for Source->UE forward axis, then scale
+    FHL2CoordTransform X;
+    X.Rows[0] = FVector4f(Scale, 0.f, 0.f, 0.f);
+    X.Rows[1] = bFlipYZ ? FVector4f(0.f, 0.f, -Scale, 0.f) : FVector4f(0.f, -Scale, 0.f, 0.f);
+    X.Rows[2] = bFlipYZ ? FVector4f(0.f, Scale, 0.f, 0.f) : FVector4f(0.f, 0.f, Scale, 0.f);
+    return X;
+}
+
+// Meshes imported from Source carry the same axis conversion as the map, so a Source rotation is conjugated by it:
+// R' = A * R * A^T, with A the unit-scale linear part of the transform.
+FQuat FHL2CoordTransform::TransformAngles(const FVector3f& Angles) const
+{
+    float SP, CP, SY, CY, SR, CR;
+    FMath::SinCos(&SP, &CP, FMath::DegreesToRadians(Angles.X));
+    FMath::SinCos(&SY, &CY, FMath::DegreesToRadians(Angles.Y));
+    FMath::SinCos(&SR, &CR, FMath::DegreesToRadians(Angles.Z));
+    // Columns of Source's AngleMatrix: forward, left, up
+    const FVector3f Forward(CP * CY, CP * SY, -SP);
+    const FVector3f Left(SR * SP * CY - CR * SY, SR * SP * SY + CR * CY, SR * CP);
+    const FVector3f Up(CR * SP * CY + SR * SY, CR * SP * SY - SR * CY, CR * CP);
+
+    const float Scale = FVector3f(Rows[0].X, Rows[0].Y, Rows[0].Z).Size();
+    const float InvScale2 = Scale > 0.f ? 1.f / (Scale * Scale) : 1.f;
+    FVector3f Axes[3];
+    for (int32 i = 0; i < 3; ++i)
+    {
+        // Unreal axis i in Source space is row i of A, then rotate and bring back
+        const FVector3f U(Rows[i].X, Rows[i].Y, Rows[i].Z);
+        const FVector3f Rotated = Forward * U.X + Left * U.Y + Up * U.Z;
+        Axes[i] = TransformVector(Rotated) * InvScale2;
+    }
+    return FMatrix(FVector(Axes[0]), FVector(Axes[1]), FVector(Axes[2]), FVector::ZeroVector).ToQuat();
+}
+
+template <bool bTranslate>
+static void TransformStream(const FHL2CoordTransform& X, TConstArrayView<FVector3f> In, TArrayView<FVector3f> Out)
+{
+    check(In.Num() == Out.Num());
+    const int32 Num = In.Num();
+    if (Num == 0) return;
+
+    const VectorRegister4Float C0 = MakeVectorRegisterFloat(X.Rows[0].X, X.Rows[1].X, X.Rows[2].X, 0.f);
+    const VectorRegister4Float C1 = MakeVectorRegisterFloat(X.Rows[0].Y, X.Rows[1].Y, X.Rows[2].Y, 0.f);
+    const VectorRegister4Float C2 = MakeVectorRegisterFloat(X.Rows[0].Z, X.Rows[1].Z, X.Rows[2].Z, 0.f);
+    const VectorRegister4Float T = bTranslate ? MakeVectorRegisterFloat(X.Rows[0].W, X.Rows[1].W, X.Rows[2].W, 0.f) : VectorZeroFloat();
+
+    const float* Src = &In.GetData()->X;
+    float* Dst = &Out.GetData()->X;
+
+    // Every point but the last takes a 4-wide unaligned load (the 4th lane is the next point's X, never
+    // past the stream). Each store writes exactly 3 floats, so in-place streams stay correct.
+    int32 i = 0;
+    for (; i + 1 < Num; ++i)
+    {
+        const VectorRegister4Float P = VectorLoad(Src + i * 3);
+        VectorRegister4Float R = VectorMultiplyAdd(VectorReplicate(P, 0), C0, T);
+        R = VectorMultiplyAdd(VectorReplicate(P, 1), C1, R);
+        R = VectorMultiplyAdd(VectorReplicate(P, 2), C2, R);
+        VectorStoreFloat3(R, Dst + i * 3);
+    }
+    const VectorRegister4Float P = VectorLoadFloat3(Src + i * 3);
+    VectorRegister4Float R = VectorMultiplyAdd(VectorReplicate(P, 0), C0, T);
+    R = VectorMultiplyAdd(VectorReplicate(P, 1), C1, R);
+    R = VectorMultiplyAdd(VectorReplicate(P, 2), C2, R);
+    VectorStoreFloat3(R, Dst + i * 3);
+}
+
+void FHL2CoordTransform::TransformPositions(TConstArrayView<FVector3f> In, TArrayView<FVector3f> Out) const
+{
+    TransformStream<true>(*this, In, Out);
+}
+
+void FHL2CoordTransform::TransformVectors(TConstArrayView<FVector3f> In, TArrayView<FVector3f> Out) const
+{
+    TransformStream<false>(*this, In, Out);
+}
+
+// Previous per-vertex path (double precision, settings re-read per call), kept for the benchmark below.
+static FVector LegacyTransformPos(const FVector& In, const UHL2BSPImporterSettings* Sets)
+{
+    FVector P = In;
+    if (Sets && Sets->bFlipYZ)
+    {
+        P = FVector(In.X, In.Z, In.Y);
+    }
+    P.Y *= -1.f;
+    const float Scale = Sets ? Sets->WorldScale : 1.f;
+    P *= Scale;
+    return P;
+}
+
+static void BenchTransform(const TArray<FString>& Args)
+{
+    const int32 Num = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 4 * 1024 * 1024;
+    const UHL2BSPImporterSettings* Sets = GetDefault<UHL2BSPImporterSettings>();
+    const FHL2CoordTransform X = FHL2CoordTransform::FromSettings(Sets);
+
+    FRandomStream Rng(1234);
+    TArray<FVector3f> Src; Src.SetNumUninitialized(Num);
+    for (FVector3f& P : Src)
+    {
+        P = FVector3f(Rng.FRandRange(-16384.f, 16384.f), Rng.FRandRange(-16384.f, 16384.f), Rng.FRandRange(-16384.f, 16384.f));
+    }
+    TArray<FVector3f> OutLegacy; OutLegacy.SetNumUninitialized(Num);
+    TArray<FVector3f> OutScalar; OutScalar.SetNumUninitialized(Num);
+    TArray<FVector3f> OutSimd; OutSimd.SetNumUninitialized(Num);
+
+    double T0 = FPlatformTime::Seconds();
+    for (int32 i = 0; i < Num; ++i)
+    {
+        OutLegacy[i] = (FVector3f)LegacyTransformPos((FVector)Src[i], Sets);
+    }
+    double T1 = FPlatformTime::Seconds();
+    for (int32 i = 0; i < Num; ++i)
+    {
+        OutScalar[i] = X.TransformPosition(Src[i]);
+    }
+    double T2 = FPlatformTime::Seconds();
+    X.TransformPositions(Src, OutSimd);
+    double T3 = FPlatformTime::Seconds();
+
+    float MaxErr = 0.f;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        MaxErr = FMath::Max(MaxErr, (OutSimd[i] - OutLegacy[i]).GetAbsMax());
+    }
+    UE_LOG(LogHL2BSPImporter, Display, TEXT("hl2.bench_transform: N=%d Legacy=%.2fms Scalar3x4=%.2fms Simd=%.2fms Speedup(vs legacy)=%.2fx MaxErr=%g"),
+        Num, (T1 - T0) * 1000.0, (T2 - T1) * 1000.0, (T3 - T2) * 1000.0, (T1 - T0) / FMath::Max(T3 - T2, 1e-9), MaxErr);
+}
+
+static FAutoConsoleCommand CmdHL2BenchTransform(
+    TEXT("hl2.bench_transform"), TEXT("Microbenchmark: per-vertex legacy transform vs baked 3x4 scalar vs SIMD stream. Usage: hl2.bench_transform [NumPoints]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchTransform));
@@ -0,0 +1,256 @@
+#include "HL2Displacements.h"
+#include "HL2BSPImporter.h"
+#include "BspFile.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Unique.h"
+#include "Async/ParallelFor.h"
+
+// Displacement grids: base orientation, tessellation, triangulation and stitching between neighbours.
+
+DECLARE_CYCLE_STAT(TEXT("Displacement Stitch"), STAT_HL2_DispStitch, STATGROUP_HL2BSPImporter);
+
+static constexpr float HL2DispStitchTolerance = 0.5f;   // Source units; VBSP snaps shared edges well inside this
+
+bool GetDispBase(const FBspGeometry& Geo, const FDispInfo& Info, FHL2DispBase& Out)
+{
+    if (Info.MapFace < 0 || Info.MapFace >= Geo.NumFaces())
+    {
+        return false;
+    }
+    const int32 NumCorners = Geo.FaceNumCorners[Info.MapFace];
+    if (NumCorners != 3 && NumCorners != 4)
+    {
+        return false;
+    }
+    const int32 FirstCorner = Geo.FaceFirstCorner[Info.MapFace];
+    int32 Start = 0;
+    float BestDist = MAX_flt;
+    for (int32 c = 0; c < NumCorners; ++c)
+    {
+        const float Dist = FVector3f::DistSquared(Geo.Positions[Geo.Indices[FirstCorner + c]], Info.StartPosition);
+        if (Dist < BestDist)
+        {
+            BestDist = Dist;
+            Start = c;
+        }
+    }
+    for (int32 k = 0; k < 4; ++k)
+    {
+        const int32 Corner = FirstCorner + (Start + FMath::Min(k, NumCorners - 1)) % NumCorners;
+        Out.Corners[k] = Geo.Positions[Geo.Indices[Corner]];
+        Out.UVs[k] = Geo.UVs[Corner];
+        Out.LightmapUVs[k] = Geo.LightmapUVs.IsValidIndex(Corner) ? Geo.LightmapUVs[Corner] : FVector2f::ZeroVector;
+    }
+    Out.bTriangle = NumCorners == 3;
+    return true;
+}
+
+template <typename T>
+static T DispBilinear(const T (&Corners)[4], float Row, float Col)
+{
+    return FMath::Lerp(FMath::Lerp(Corners[0], Corners[1], Row), FMath::Lerp(Corners[3], Corners[2], Row), Col);
+}
+
+void TessellateDisplacement(const FHL2DispBase& Base, int32 Side, int32 Step, TConstArrayView<FDispVert> Verts, TArrayView<FVector3f> OutPositions,
+                            TArrayView<FVector2f> OutUVs, TArrayView<FVector2f> OutLightmapUVs, TArrayView<float> OutAlphas)
+{
+    const int32 FullSide = (Side - 1) * Step + 1;
+    check(Verts.Num() == FullSide * FullSide);
+    const float InvSegments = 1.f / (float)(Side - 1);
+    const bool bLightmapUVs = OutLightmapUVs.Num() > 0;
+    for (int32 Row = 0; Row < Side; ++Row)
+    {
+        const float R = Row * InvSegments;
+        for (int32 Col = 0; Col < Side; ++Col)
+        {
+            const float C = Col * InvSegments;
+            const int32 Node = Row * Side + Col;
+            const FDispVert& Vert = Verts[(Row * FullSide + Col) * Step];
+            const FVector3f Offset(Vert.Vector[0], Vert.Vector[1], Vert.Vector[2]);
+            OutPositions[Node] = DispBilinear(Base.Corners, R, C) + Offset * Vert.Dist;
+            OutUVs[Node] = DispBilinear(Base.UVs, R, C);
+            if (bLightmapUVs) OutLightmapUVs[Node] = DispBilinear(Base.LightmapUVs, R, C);
+            OutAlphas[Node] = FMath::Clamp(Vert.Alpha / 255.f, 0.f, 1.f);
+        }
+    }
+
+    // A triangle base's last column is the apex: its samples carry their own offsets, so weld them onto their average
+    // or the triangles TriangulateDisplacement keeps there would open gaps where the collapsed halves were dropped
+    if (Base.bTriangle)
+    {
+        FVector3f Apex = FVector3f::ZeroVector;
+        float Alpha = 0.f;
+        for (int32 Row = 0; Row < Side; ++Row)
+        {
+            Apex += OutPositions[Row * Side + Side - 1];
+            Alpha += OutAlphas[Row * Side + Side - 1];
+        }
+        Apex /= (float)Side;
+        Alpha /= (float)Side;
+        for (int32 Row = 0; Row < Side; ++Row)
+        {
+            OutPositions[Row * Side + Side - 1] = Apex;
+            OutAlphas[Row * Side + Side - 1] = Alpha;
+        }
+    }
+}
+
+void TriangulateDisplacement(int32 Side, bool bTriangle, int32 FirstNode, TArrayView<int32> OutTriNodes)
+{
+    int32 Out = 0;
+    auto Emit = [&](int32 A, int32 B, int32 C)
+    {
+        OutTriNodes[Out++] = FirstNode + A;
+        OutTriNodes[Out++] = FirstNode + B;
+        OutTriNodes[Out++] = FirstNode + C;
+    };
+    for (int32 Row = 0; Row < Side - 1; ++Row)
+    {
+        for (int32 Col = 0; Col < Side - 1; ++Col)
+        {
+            const int32 A = Row * Side + Col;
+            const int32 B = A + Side;
+            const int32 C = B + 1;
+            const int32 D = A + 1;
+            // On a triangle base C and D of the last column are both the apex
+            const bool bCollapsed = bTriangle && Col == Side - 2;
+            if ((Row + Col) & 1)
+            {
+                Emit(A, B, D);
+                if (!bCollapsed) Emit(B, C, D);
+            }
+            else
+            {
+                Emit(A, B, C);
+                if (!bCollapsed) Emit(A, C, D);
+            }
+        }
+    }
+    check(Out == GetDispNumTriangles(Side, bTriangle) * 3);
+}
+
+static int32 FindStitchRoot(TArray<int32>& Parents, int32 Node)
+{
+    while (Parents[Node] != Node)
+    {
+        Parents[Node] = Parents[Parents[Node]];
+        Node = Parents[Node];
+    }
+    return Node;
+}
+
+int32 StitchDisplacements(TConstArrayView<FDispInfo> Infos, TConstArrayView<FHL2DispStitchInput> Disps, TArrayView<FVector3f> NodePositions)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_DispStitch);
+    TArray<int32> InputOfInfo;
+    InputOfInfo.Init(INDEX_NONE, Infos.Num());
+    for (int32 d = 0; d < Disps.Num(); ++d)
+    {
+        InputOfInfo[Disps[d].DispInfo] = d;
+    }
+
+    // Border nodes (grid-local) and their bounds per displacement
+    TArray<TArray<int32>> Borders; Borders.SetNum(Disps.Num());
+    TArray<FBox3f> BorderBounds; BorderBounds.SetNumUninitialized(Disps.Num());
+    ParallelFor(TEXT("HL2BSP.DispBorders"), Disps.Num(), 16, [&](int32 d)
+    {
+        const FHL2DispStitchInput& Disp = Disps[d];
+        FBox3f Bounds(ForceInit);
+        Borders[d].Reserve((Disp.Side - 1) * 4);
+        for (int32 Node = 0; Node < Disp.Side * Disp.Side; ++Node)
+        {
+            if (!IsDispBorderNode(Disp.Side, Node)) continue;
+            if (Disp.bTriangle && Node % Disp.Side == Disp.Side - 1 && Node != Disp.Side - 1) continue;
+            Borders[d].Add(Node);
+            Bounds += NodePositions[Disp.FirstNode + Node];
+        }
+        BorderBounds[d] = Bounds.ExpandBy(HL2DispStitchTolerance);
+    });
+
+    // Each displacement pairs its border nodes with those of higher-numbered neighbours in the build
+    TArray<TArray<TPair<int32, int32>>> Pairs; Pairs.SetNum(Disps.Num());
+    ParallelFor(TEXT("HL2BSP.DispStitch"), Disps.Num(), 4, [&](int32 d)
+    {
+        const FDispInfo& Info = Infos[Disps[d].DispInfo];
+        for (int32 i = 0; i < Info.NumNeighbors; ++i)
+        {
+            const int32 n = InputOfInfo.IsValidIndex(Info.Neighbors[i]) ? InputOfInfo[Info.Neighbors[i]] : INDEX_NONE;
+            if (n == INDEX_NONE || n <= d) continue;
+            for (int32 NodeA : Borders[d])
+            {
+                const FVector3f& PA = NodePositions[Disps[d].FirstNode + NodeA];
+                if (!BorderBounds[n].IsInside(PA)) continue;
+                int32 Best = INDEX_NONE;
+                float BestDist = FMath::Square(HL2DispStitchTolerance);
+                for (int32 NodeB : Borders[n])
+                {
+                    const float Dist = FVector3f::DistSquared(PA, NodePositions[Disps[n].FirstNode + NodeB]);
+                    if (Dist <= BestDist)
+                    {
+                        BestDist = Dist;
+                        Best = Disps[n].FirstNode + NodeB;
+                    }
+                }
+                if (Best != INDEX_NONE)
+                {
+                    Pairs[d].Emplace(Disps[d].FirstNode + NodeA, Best);
+                }
+            }
+        }
+    });
+
+    // Union the pairs (serial, so the result does not depend on scheduling), then move each set onto its average
+    TArray<int32> Nodes;
+    for (const TArray<TPair<int32, int32>>& DispPairs : Pairs)
+    {
+        for (const TPair<int32, int32>& Pair : DispPairs)
+        {
+            Nodes.Add(Pair.Key);
+            Nodes.Add(Pair.Value);
+        }
+    }
+    Nodes.Sort();
+    Nodes.SetNum(Algo::Unique(Nodes));
+    if (Nodes.Num() == 0)
+    {
+        return 0;
+    }
+    TArray<int32> SetParents; SetParents.SetNumUninitialized(Nodes.Num());
+    for (int32 i = 0; i < Nodes.Num(); ++i)
+    {
+        SetParents[i] = i;
+    }
+    auto Slot = [&Nodes](int32 Node) { return Algo::BinarySearch(Nodes, Node); };
+    for (const TArray<TPair<int32, int32>>& DispPairs : Pairs)
+    {
+        for (const TPair<int32, int32>& Pair : DispPairs)
+        {
+            const int32 A = FindStitchRoot(SetParents, Slot(Pair.Key));
+            const int32 B = FindStitchRoot(SetParents, Slot(Pair.Value));
+            if (A != B) SetParents[FMath::Max(A, B)] = FMath::Min(A, B);
+        }
+    }
+    TArray<FVector3f> Sums; Sums.SetNumZeroed(Nodes.Num());
+    TArray<int32> Counts; Counts.SetNumZeroed(Nodes.Num());
+    for (int32 i = 0; i < Nodes.Num(); ++i)
+    {
+        const int32 Root = FindStitchRoot(SetParents, i);
+        Sums[Root] += NodePositions[Nodes[i]];
+        ++Counts[Root];
+    }
+    for (int32 i = 0; i < Nodes.Num(); ++i)
+    {
+        const int32 Root = FindStitchRoot(SetParents, i);
+        NodePositions[Nodes[i]] = Sums[Root] / (float)Counts[Root];
+    }
+    // Apex columns were stitched through their row-0 node; keep the rest of the column on it
+    for (const FHL2DispStitchInput& Disp : Disps)
+    {
+        if (!Disp.bTriangle) continue;
+        for (int32 Row = 1; Row < Disp.Side; ++Row)
+        {
+            NodePositions[Disp.FirstNode + Row * Disp.Side + Disp.Side - 1] = NodePositions[Disp.FirstNode + Disp.Side - 1];
+        }
+    }
+    return Nodes.Num();
+}
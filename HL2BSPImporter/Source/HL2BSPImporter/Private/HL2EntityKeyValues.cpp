@@ -0,0 +1,215 @@
+#include "HL2EntityKeyValues.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#endif
+
+// Entity lump tokenizer: { "key" "value" ... } blocks, scanned in place over the ANSI bytes.
+
+// Returns the first byte in [P, End) equal to A, B or C, or End
+static const uint8* ScanFor3(const uint8* P, const uint8* End, uint8 A, uint8 B, uint8 C)
+{
+#if PLATFORM_CPU_X86_FAMILY
+    const __m128i VA = _mm_set1_epi8((char)A);
+    const __m128i VB = _mm_set1_epi8((char)B);
+    const __m128i VC = _mm_set1_epi8((char)C);
+    for (; End - P >= 16; P += 16)
+    {
+        const __m128i Bytes = _mm_loadu_si128((const __m128i*)P);
+        const __m128i Hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Bytes, VA), _mm_cmpeq_epi8(Bytes, VB)), _mm_cmpeq_epi8(Bytes, VC));
+        const uint32 Mask = (uint32)_mm_movemask_epi8(Hit);
+        if (Mask)
+        {
+            return P + FMath::CountTrailingZeros(Mask);
+        }
+    }
+#endif
+    for (; P < End; ++P)
+    {
+        if (*P == A || *P == B || *P == C) return P;
+    }
+    return End;
+}
+
+static const uint8* ScanForQuote(const uint8* P, const uint8* End)
+{
+    return ScanFor3(P, End, '"', '"', '"');
+}
+
+static bool IsEntitySpace(uint8 C)
+{
+    return C == ' ' || C == '\t' || C == '\r' || C == '\n';
+}
+
+FHL2EntityKeyValues::FSpan FHL2EntityKeyValues::Store(const uint8* Begin, const uint8* End)
+{
+    FSpan S;
+    S.Ofs = Arena.Num();
+    S.Len = (int32)(End - Begin);
+    // Arena was reserved for the whole lump plus terminators, so this never reallocates
+    Arena.Append(reinterpret_cast<const ANSICHAR*>(Begin), S.Len);
+    Arena.Add('\0');
+    return S;
+}
+
+void FHL2EntityKeyValues::Reset()
+{
+    Arena.Reset();
+    Pairs.Reset();
+    EntityFirstPair.Reset();
+}
+
+void FHL2EntityKeyValues::Parse(TConstArrayView<uint8> Lump)
+{
+    Reset();
+    if (Lump.Num() == 0) return;
+
+    // Upper bounds from the raw text: every pair needs four quotes, every entity an opening brace, and the
+    // arena holds at most the lump bytes plus one terminator per string.
+    int32 NumQuotes = 0, NumOpen = 0;
+    const uint8* const Begin = Lump.GetData();
+    const uint8* const End = Begin + Lump.Num();
+    for (const uint8* P = ScanFor3(Begin, End, '"', '{', '{'); P < End; P = ScanFor3(P + 1, End, '"', '{', '{'))
+    {
+        if (*P == '"') ++NumQuotes; else ++NumOpen;
+    }
+    Arena.Reserve(Lump.Num() + NumQuotes / 2 + 1);
+    Pairs.Reserve(NumQuotes / 4 + 1);
+    EntityFirstPair.Reserve(NumOpen);
+
+    bool bInEntity = false;
+    const uint8* P = Begin;
+    while (P < End)
+    {
+        P = ScanFor3(P, End, '"', '{', '}');
+        if (P == End) break;
+
+        if (*P == '{')
+        {
+            if (!bInEntity)
+            {
+                bInEntity = true;
+                EntityFirstPair.Add(Pairs.Num());
+            }
+            ++P;
+            continue;
+        }
+        if (*P == '}')
+        {
+            // Drop empty blocks so entity indices match the populated entities only
+            if (bInEntity && EntityFirstPair.Last() == Pairs.Num())
+            {
+                EntityFirstPair.Pop(EAllowShrinking::No);
+            }
+            bInEntity = false;
+            ++P;
+            continue;
+        }
+
+        // Quoted string: a key inside an entity, stray text outside one
+        const uint8* K0 = P + 1;
+        const uint8* K1 = ScanForQuote(K0, End);
+        P = K1 < End ? K1 + 1 : End;
+        if (!bInEntity) continue;
+
+        // The value must follow on the same line, separated only by blanks
+        while (P < End && (*P == ' ' || *P == '\t')) ++P;
+        if (P == End || *P != '"') continue;
+        const uint8* V0 = P + 1;
+        const uint8* V1 = ScanForQuote(V0, End);
+        P = V1 < End ? V1 + 1 : End;
+
+        FPair& Pair = Pairs.AddDefaulted_GetRef();
+        Pair.Key = Store(K0, K1);
+        Pair.Value = Store(V0, V1);
+    }
+    if (bInEntity && EntityFirstPair.Last() == Pairs.Num())
+    {
+        EntityFirstPair.Pop(EAllowShrinking::No);
+    }
+}
+
+FAnsiStringView FHL2EntityKeyValues::FindValue(int32 Entity, FAnsiStringView Key) const
+{
+    const int32 PairEnd = GetPairEnd(Entity);
+    for (int32 i = EntityFirstPair[Entity]; i < PairEnd; ++i)
+    {
+        if (View(Pairs[i].Key).Equals(Key, ESearchCase::IgnoreCase))
+        {
+            return View(Pairs[i].Value);
+        }
+    }
+    return FAnsiStringView();
+}
+
+bool FHL2EntityKeyValues::HasKey(int32 Entity, FAnsiStringView Key) const
+{
+    const int32 PairEnd = GetPairEnd(Entity);
+    for (int32 i = EntityFirstPair[Entity]; i < PairEnd; ++i)
+    {
+        if (View(Pairs[i].Key).Equals(Key, ESearchCase::IgnoreCase)) return true;
+    }
+    return false;
+}
+
+int32 FHL2EntityKeyValues::ParseFloats(FAnsiStringView Value, float* Out, int32 Count)
+{
+    static const double Pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+
+    const ANSICHAR* P = Value.GetData();
+    const ANSICHAR* const End = P + Value.Len();
+    int32 NumRead = 0;
+    while (NumRead < Count)
+    {
+        while (P < End && IsEntitySpace((uint8)*P)) ++P;
+        if (P == End) break;
+
+        bool bNegative = false;
+        if (*P == '-' || *P == '+') { bNegative = (*P == '-'); ++P; }
+
+        // Mantissa accumulated as an integer (up to 18 significant digits), scaled once at the end
+        uint64 Mantissa = 0;
+        int32 NumDigits = 0, Exponent = 0;
+        bool bAnyDigit = false;
+        for (; P < End && *P >= '0' && *P <= '9'; ++P)
+        {
+            bAnyDigit = true;
+            if (NumDigits < 18) { Mantissa = Mantissa * 10 + (*P - '0'); if (Mantissa) ++NumDigits; }
+            else { ++Exponent; }
+        }
+        if (P < End && *P == '.')
+        {
+            for (++P; P < End && *P >= '0' && *P <= '9'; ++P)
+            {
+                bAnyDigit = true;
+                if (NumDigits < 18) { Mantissa = Mantissa * 10 + (*P - '0'); if (Mantissa) ++NumDigits; --Exponent; }
+            }
+        }
+        if (!bAnyDigit) break;
+        if (P < End && (*P == 'e' || *P == 'E'))
+        {
+            const ANSICHAR* ExpStart = P++;
+            bool bExpNegative = false;
+            if (P < End && (*P == '-' || *P == '+')) { bExpNegative = (*P == '-'); ++P; }
+            if (P < End && *P >= '0' && *P <= '9')
+            {
+                int32 E = 0;
+                for (; P < End && *P >= '0' && *P <= '9'; ++P) E = FMath::Min(E * 10 + (*P - '0'), 999);
+                Exponent += bExpNegative ? -E : E;
+            }
+            else
+            {
+                P = ExpStart;
+            }
+        }
+
+        double Result = (double)Mantissa;
+        const int32 AbsExp = FMath::Abs(Exponent);
+        const double Scale = AbsExp < (int32)UE_ARRAY_COUNT(Pow10) ? Pow10[AbsExp] : FMath::Pow(10.0, (double)AbsExp);
+        Result = Exponent < 0 ? Result / Scale : Result * Scale;
+        // A value must end at whitespace; anything else means the token is not a number and is not stored
+        if (P < End && !IsEntitySpace((uint8)*P)) break;
+        Out[NumRead++] = (float)(bNegative ? -Result : Result);
+    }
+    return NumRead;
+}
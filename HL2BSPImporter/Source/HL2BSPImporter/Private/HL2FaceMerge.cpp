@@ -0,0 +1,393 @@
+#include "HL2FaceMerge.h"
+#include "BspFile.h"
+#include "Async/ParallelFor.h"
+
+// Coplanar face merging, T-junction-aware collinear cleanup and ear clipping for brush faces. Adjacency works on
+// BSP vertex indices, so faces only merge across edges the compiler actually shared.
+
+static constexpr int32 HL2MaxMergedCorners = 256;
+static constexpr float HL2CollinearSine = 1e-3f;
+
+// One output polygon: corners into the reader's corner streams plus its local triangulation
+struct FHL2MergeResult
+{
+    TArray<int32> Corners;
+    TArray<uint16> Tris;
+    TArray<int32> Members;
+    int32 Face = INDEX_NONE;
+    int32 NumRemoved = 0;
+};
+
+static uint64 EdgeKey(int32 A, int32 B)
+{
+    return ((uint64)(uint32)A << 32) | (uint32)B;
+}
+
+// Appends Face to the polygon Loop if they share exactly one contiguous run of edges and the result is still a
+// simple polygon (no repeated vertex, so no holes or pinches). Both loops have the same winding since they
+// share a plane side.
+static bool TryMergeFace(const FBspGeometry& Geo, TArray<int32>& Loop, int32 Face, TArray<int32>& Scratch)
+{
+    const int32 First = Geo.FaceFirstCorner[Face];
+    const int32 N = Geo.FaceNumCorners[Face];
+    const int32 L = Loop.Num();
+    auto LoopVertex = [&](int32 i) { return Geo.Indices[Loop[i % L]]; };
+    auto FaceVertex = [&](int32 i) { return Geo.Indices[First + i % N]; };
+    auto FindInLoop = [&](int32 V)
+    {
+        for (int32 j = 0; j < L; ++j)
+        {
+            if (LoopVertex(j) == V) return j;
+        }
+        return (int32)INDEX_NONE;
+    };
+
+    // Face edge i (FaceVertex(i) -> FaceVertex(i + 1)) is shared if the loop runs the other way along it
+    TArray<bool, TInlineAllocator<64>> Shared;
+    Shared.SetNumZeroed(N);
+    int32 NumShared = 0;
+    for (int32 i = 0; i < N; ++i)
+    {
+        const int32 j = FindInLoop(FaceVertex(i + 1));
+        Shared[i] = j != INDEX_NONE && LoopVertex(j + 1) == FaceVertex(i);
+        NumShared += Shared[i] ? 1 : 0;
+    }
+    if (NumShared == 0 || NumShared == N) return false;
+
+    int32 RunStart = INDEX_NONE;
+    int32 NumRuns = 0;
+    for (int32 i = 0; i < N; ++i)
+    {
+        if (Shared[i] && !Shared[(i + N - 1) % N])
+        {
+            RunStart = i;
+            ++NumRuns;
+        }
+    }
+    const int32 K = NumShared;
+    const int32 NewNum = L + N - 2 * K;
+    if (NumRuns != 1 || NewNum < 3 || NewNum > HL2MaxMergedCorners) return false;
+
+    // In the loop the run goes backwards, from FaceVertex(RunStart + K) at P to FaceVertex(RunStart) at P + K.
+    // Keep the loop from P + K around to P, then the face's own corners strictly between the run's ends.
+    const int32 P = FindInLoop(FaceVertex(RunStart + K));
+    Scratch.Reset(NewNum);
+    for (int32 t = 0; t <= L - K; ++t)
+    {
+        Scratch.Add(Loop[(P + K + t) % L]);
+    }
+    for (int32 t = 1; t < N - K; ++t)
+    {
+        Scratch.Add(First + (RunStart + K + t) % N);
+    }
+
+    TArray<int32, TInlineAllocator<64>> Vertices;
+    Vertices.Reserve(NewNum);
+    for (int32 Corner : Scratch)
+    {
+        Vertices.Add(Geo.Indices[Corner]);
+    }
+    Vertices.Sort();
+    for (int32 i = 1; i < Vertices.Num(); ++i)
+    {
+        if (Vertices[i] == Vertices[i - 1]) return false;
+    }
+    Swap(Loop, Scratch);
+    return true;
+}
+
+// Drops boundary corners that are collinear with their neighbours and referenced by no face outside the polygon.
+// Vertices other faces use are the compiler's T-junction fixes and must stay, or cracks open along the edge.
+static int32 RemoveCollinearCorners(const FBspGeometry& Geo, TArray<int32>& Loop, const TMap<int32, int32>& MemberUse, const TArray<int32>& VertexUse)
+{
+    int32 NumRemoved = 0;
+    for (bool bRemoved = true; bRemoved && Loop.Num() > 3; )
+    {
+        bRemoved = false;
+        const int32 L = Loop.Num();
+        for (int32 i = 0; i < L; ++i)
+        {
+            const int32 V = Geo.Indices[Loop[i]];
+            if (MemberUse.FindRef(V) != VertexUse[V]) continue;
+            const FVector3f P0 = Geo.Positions[Geo.Indices[Loop[(i + L - 1) % L]]];
+            const FVector3f P1 = Geo.Positions[V];
+            const FVector3f P2 = Geo.Positions[Geo.Indices[Loop[(i + 1) % L]]];
+            const FVector3f E1 = P1 - P0;
+            const FVector3f E2 = P2 - P1;
+            const float Lengths = E1.Size() * E2.Size();
+            if ((E1 ^ E2).Size() <= HL2CollinearSine * Lengths && (E1 | E2) >= 0.f)
+            {
+                Loop.RemoveAt(i);
+                ++NumRemoved;
+                bRemoved = true;
+                break;
+            }
+        }
+    }
+    return NumRemoved;
+}
+
+static float Cross2D(const FVector2f& A, const FVector2f& B)
+{
+    return A.X * B.Y - A.Y * B.X;
+}
+
+static float MinAngle(const FVector2f& A, const FVector2f& B, const FVector2f& C)
+{
+    auto Angle = [](const FVector2f& U, const FVector2f& V) { return FMath::Atan2(FMath::Abs(Cross2D(U, V)), U | V); };
+    return FMath::Min3(Angle(B - A, C - A), Angle(C - B, A - B), Angle(A - C, B - C));
+}
+
+// Ear clipping that always cuts the ear with the largest minimum angle, which avoids the slivers a fan produces
+// on long faces. Emits N - 2 triangles in the loop's winding.
+static void TriangulatePolygon(const FBspGeometry& Geo, TConstArrayView<int32> Loop, TArray<uint16>& OutTris)
+{
+    const int32 N = Loop.Num();
+    OutTris.Reset((N - 2) * 3);
+    if (N == 3)
+    {
+        OutTris.Append({ 0, 1, 2 });
+        return;
+    }
+
+    // Newell normal, then project onto the two axes orthogonal to its dominant component with a CCW orientation
+    FVector3f Normal = FVector3f::ZeroVector;
+    for (int32 i = 0; i < N; ++i)
+    {
+        const FVector3f& Cur = Geo.Positions[Geo.Indices[Loop[i]]];
+        const FVector3f& Nxt = Geo.Positions[Geo.Indices[Loop[(i + 1) % N]]];
+        Normal.X += (Cur.Y - Nxt.Y) * (Cur.Z + Nxt.Z);
+        Normal.Y += (Cur.Z - Nxt.Z) * (Cur.X + Nxt.X);
+        Normal.Z += (Cur.X - Nxt.X) * (Cur.Y + Nxt.Y);
+    }
+    const FVector3f AbsNormal = Normal.GetAbs();
+    const int32 Axis = (AbsNormal.X >= AbsNormal.Y && AbsNormal.X >= AbsNormal.Z) ? 0 : (AbsNormal.Y >= AbsNormal.Z ? 1 : 2);
+    const int32 U = (Axis + 1) % 3;
+    const int32 V = (Axis + 2) % 3;
+    const float Flip = Normal[Axis] < 0.f ? -1.f : 1.f;
+
+    TArray<FVector2f, TInlineAllocator<64>> Pt;
+    TArray<int32, TInlineAllocator<64>> Prev, Next;
+    TArray<float, TInlineAllocator<64>> Score;
+    Pt.SetNumUninitialized(N); Prev.SetNumUninitialized(N); Next.SetNumUninitialized(N); Score.SetNumUninitialized(N);
+    for (int32 i = 0; i < N; ++i)
+    {
+        const FVector3f& P = Geo.Positions[Geo.Indices[Loop[i]]];
+        Pt[i] = FVector2f(P[U] * Flip, P[V]);
+        Prev[i] = (i + N - 1) % N;
+        Next[i] = (i + 1) % N;
+    }
+
+    // Minimum angle of the ear at i, or -1 if i is reflex/degenerate or another remaining corner lies in the ear
+    auto Evaluate = [&](int32 i) -> float
+    {
+        const int32 a = Prev[i];
+        const int32 c = Next[i];
+        const FVector2f A = Pt[a], B = Pt[i], C = Pt[c];
+        const float Area = Cross2D(B - A, C - B);
+        if (Area <= UE_SMALL_NUMBER) return -1.f;
+        for (int32 j = Next[c]; j != a; j = Next[j])
+        {
+            const FVector2f& Q = Pt[j];
+            if (Q.Equals(A) || Q.Equals(B) || Q.Equals(C)) continue;
+            if (Cross2D(B - A, Q - A) >= 0.f && Cross2D(C - B, Q - B) >= 0.f && Cross2D(A - C, Q - C) >= 0.f) return -1.f;
+        }
+        return MinAngle(A, B, C);
+    };
+    for (int32 i = 0; i < N; ++i)
+    {
+        Score[i] = Evaluate(i);
+    }
+
+    int32 Head = 0;
+    for (int32 Remaining = N; Remaining > 3; --Remaining)
+    {
+        int32 Best = INDEX_NONE;
+        float BestScore = 0.f;
+        int32 i = Head;
+        for (int32 Step = 0; Step < Remaining; ++Step, i = Next[i])
+        {
+            if (Score[i] > BestScore)
+            {
+                BestScore = Score[i];
+                Best = i;
+            }
+        }
+        // No valid ear (numerically degenerate input): clip anyway so the triangle count stays N - 2
+        if (Best == INDEX_NONE) Best = Head;
+
+        const int32 a = Prev[Best];
+        const int32 c = Next[Best];
+        OutTris.Append({ (uint16)a, (uint16)Best, (uint16)c });
+        Next[a] = c;
+        Prev[c] = a;
+        if (Head == Best) Head = c;
+        Score[a] = Evaluate(a);
+        Score[c] = Evaluate(c);
+    }
+    OutTris.Append({ (uint16)Head, (uint16)Next[Head], (uint16)Next[Next[Head]] });
+}
+
+// Grows polygons over one group of faces (same texinfo and plane side), seeding from the lowest face index
+static void MergeGroup(const FBspGeometry& Geo, TConstArrayView<int32> GroupFaces, const TArray<int32>& VertexUse, TArray<FHL2MergeResult>& Out)
+{
+    const int32 NumGroupFaces = GroupFaces.Num();
+    TMap<uint64, int32> EdgeFace;
+    if (NumGroupFaces > 1)
+    {
+        for (int32 li = 0; li < NumGroupFaces; ++li)
+        {
+            const int32 First = Geo.FaceFirstCorner[GroupFaces[li]];
+            const int32 N = Geo.FaceNumCorners[GroupFaces[li]];
+            for (int32 i = 0; i < N; ++i)
+            {
+                EdgeFace.Add(EdgeKey(Geo.Indices[First + i], Geo.Indices[First + (i + 1) % N]), li);
+            }
+        }
+    }
+
+    TBitArray<> Consumed(false, NumGroupFaces);
+    TArray<int32> Frontier;
+    TArray<int32> Scratch;
+    auto AddNeighbours = [&](int32 li)
+    {
+        const int32 First = Geo.FaceFirstCorner[GroupFaces[li]];
+        const int32 N = Geo.FaceNumCorners[GroupFaces[li]];
+        for (int32 i = 0; i < N; ++i)
+        {
+            if (const int32* Other = EdgeFace.Find(EdgeKey(Geo.Indices[First + (i + 1) % N], Geo.Indices[First + i])))
+            {
+                if (!Consumed[*Other]) Frontier.Add(*Other);
+            }
+        }
+    };
+
+    for (int32 Seed = 0; Seed < NumGroupFaces; ++Seed)
+    {
+        if (Consumed[Seed]) continue;
+        Consumed[Seed] = true;
+        FHL2MergeResult& R = Out.AddDefaulted_GetRef();
+        R.Face = GroupFaces[Seed];
+        const int32 SeedFirst = Geo.FaceFirstCorner[R.Face];
+        for (int32 i = 0; i < Geo.FaceNumCorners[R.Face]; ++i)
+        {
+            R.Corners.Add(SeedFirst + i);
+        }
+        TArray<int32>& Members = R.Members;
+        Members.Add(R.Face);
+        Frontier.Reset();
+        if (NumGroupFaces > 1)
+        {
+            AddNeighbours(Seed);
+        }
+
+        // A neighbour that cannot join yet (e.g. it would close a ring) may fit once others have been added
+        for (bool bProgress = true; bProgress; )
+        {
+            bProgress = false;
+            for (int32 n = 0; n < Frontier.Num(); ++n)
+            {
+                const int32 Candidate = Frontier[n];
+                if (Consumed[Candidate]) continue;
+                if (TryMergeFace(Geo, R.Corners, GroupFaces[Candidate], Scratch))
+                {
+                    Consumed[Candidate] = true;
+                    Members.Add(GroupFaces[Candidate]);
+                    AddNeighbours(Candidate);
+                    bProgress = true;
+                }
+            }
+        }
+
+        TMap<int32, int32> MemberUse;
+        for (int32 Face : Members)
+        {
+            const int32 First = Geo.FaceFirstCorner[Face];
+            for (int32 i = 0; i < Geo.FaceNumCorners[Face]; ++i)
+            {
+                ++MemberUse.FindOrAdd(Geo.Indices[First + i]);
+            }
+        }
+        R.NumRemoved = RemoveCollinearCorners(Geo, R.Corners, MemberUse, VertexUse);
+        TriangulatePolygon(Geo, R.Corners, R.Tris);
+    }
+}
+
+void MergeCoplanarFaces(const FBspGeometry& Geo, TConstArrayView<int32> Faces, FHL2MergedPolygons& Out)
+{
+    Out = FHL2MergedPolygons();
+
+    // Face references per vertex over every assembled face, culled faces excluded (they have no corners)
+    TArray<int32> VertexUse;
+    VertexUse.SetNumZeroed(Geo.Positions.Num());
+    for (int32 Index : Geo.Indices)
+    {
+        ++VertexUse[Index];
+    }
+
+    // Group by (texinfo, plane side); displacement base faces and faces without texinfo stay on their own
+    TArray<TPair<uint64, int32>> Keyed;
+    Keyed.Reserve(Faces.Num());
+    for (int32 Face : Faces)
+    {
+        const bool bMergeable = Geo.FaceTexInfo[Face] >= 0 && !(Geo.FaceFlags[Face] & BspFaceFlags::Displacement);
+        const uint64 Key = bMergeable ? EdgeKey(Geo.FaceTexInfo[Face], Geo.FacePlane[Face]) : ((1ull << 63) | (uint32)Face);
+        Keyed.Emplace(Key, Face);
+    }
+    Keyed.Sort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B) { return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value; });
+
+    TArray<int32> SortedFaces;
+    TArray<int32> GroupStart;
+    SortedFaces.Reserve(Keyed.Num());
+    for (int32 i = 0; i < Keyed.Num(); ++i)
+    {
+        if (i == 0 || Keyed[i].Key != Keyed[i - 1].Key) GroupStart.Add(i);
+        SortedFaces.Add(Keyed[i].Value);
+    }
+    GroupStart.Add(SortedFaces.Num());
+    const int32 NumGroups = GroupStart.Num() - 1;
+
+    TArray<TArray<FHL2MergeResult>> GroupResults;
+    GroupResults.SetNum(NumGroups);
+    ParallelFor(TEXT("HL2BSP.MergeFaces"), NumGroups, 64, [&](int32 g)
+    {
+        const TConstArrayView<int32> GroupFaces(SortedFaces.GetData() + GroupStart[g], GroupStart[g + 1] - GroupStart[g]);
+        MergeGroup(Geo, GroupFaces, VertexUse, GroupResults[g]);
+    });
+
+    // Polygons in source face order, so material slots are created in the same order as without merging
+    TArray<const FHL2MergeResult*> Results;
+    int32 NumCorners = 0;
+    int32 NumTriCorners = 0;
+    for (const TArray<FHL2MergeResult>& Group : GroupResults)
+    {
+        for (const FHL2MergeResult& R : Group)
+        {
+            Results.Add(&R);
+            NumCorners += R.Corners.Num();
+            NumTriCorners += R.Tris.Num();
+        }
+    }
+    Results.Sort([](const FHL2MergeResult& A, const FHL2MergeResult& B) { return A.Face < B.Face; });
+
+    Out.Corners.Reserve(NumCorners);
+    Out.TriCorners.Reserve(NumTriCorners);
+    Out.PolyFirstCorner.Reserve(Results.Num());
+    Out.PolyNumCorners.Reserve(Results.Num());
+    Out.PolyFace.Reserve(Results.Num());
+    Out.PolyFirstMember.Reserve(Results.Num() + 1);
+    Out.Members.Reserve(Faces.Num());
+    for (const FHL2MergeResult* R : Results)
+    {
+        Out.PolyFirstMember.Add(Out.Members.Num());
+        Out.Members.Append(R->Members);
+        Out.PolyFirstCorner.Add(Out.Corners.Num());
+        Out.PolyNumCorners.Add(R->Corners.Num());
+        Out.PolyFace.Add(R->Face);
+        Out.Corners.Append(R->Corners);
+        Out.TriCorners.Append(R->Tris);
+        Out.FacesMerged += R->Members.Num() - 1;
+        Out.CollinearRemoved += R->NumRemoved;
+    }
+    Out.PolyFirstMember.Add(Out.Members.Num());
+}
@@ -0,0 +1,299 @@
+#include "HL2ImportReport.h"
+#include "HL2BSPImporter.h"
+#include "HL2BSPImportPipeline.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Import Report"), STAT_HL2_ImportReport, STATGROUP_HL2BSPImporter);
+
+// VBSP v20 lump names, and the on-disk element size where the lump is a plain array (0 = opaque blob)
+struct FHL2LumpDesc
+{
+    const TCHAR* Name;
+    int32 ElementSize;
+};
+
+static const FHL2LumpDesc HL2LumpDescs[64] =
+{
+    { TEXT("ENTITIES"), 0 },            { TEXT("PLANES"), 20 },             { TEXT("TEXDATA"), 32 },
+    { TEXT("VERTEXES"), 12 },           { TEXT("VISIBILITY"), 0 },          { TEXT("NODES"), 32 },
+    { TEXT("TEXINFO"), 72 },            { TEXT("FACES"), 56 },              { TEXT("LIGHTING"), 4 },
+    { TEXT("OCCLUSION"), 0 },           { TEXT("LEAFS"), 0 },               { TEXT("FACEIDS"), 2 },
+    { TEXT("EDGES"), 4 },               { TEXT("SURFEDGES"), 4 },           { TEXT("MODELS"), 48 },
+    { TEXT("WORLDLIGHTS"), 88 },        { TEXT("LEAFFACES"), 2 },           { TEXT("LEAFBRUSHES"), 2 },
+    { TEXT("BRUSHES"), 12 },            { TEXT("BRUSHSIDES"), 8 },          { TEXT("AREAS"), 8 },
+    { TEXT("AREAPORTALS"), 12 },        { TEXT("UNUSED0"), 0 },             { TEXT("UNUSED1"), 0 },
+    { TEXT("UNUSED2"), 0 },             { TEXT("UNUSED3"), 0 },             { TEXT("DISPINFO"), 176 },
+    { TEXT("ORIGINALFACES"), 56 },      { TEXT("PHYSDISP"), 0 },            { TEXT("PHYSCOLLIDE"), 0 },
+    { TEXT("VERTNORMALS"), 12 },        { TEXT("VERTNORMALINDICES"), 2 },   { TEXT("DISP_LIGHTMAP_ALPHAS"), 0 },
+    { TEXT("DISP_VERTS"), 20 },         { TEXT("DISP_LIGHTMAP_SAMPLE_POSITIONS"), 0 }, { TEXT("GAME_LUMP"), 0 },
+    { TEXT("LEAFWATERDATA"), 12 },      { TEXT("PRIMITIVES"), 10 },         { TEXT("PRIMVERTS"), 12 },
+    { TEXT("PRIMINDICES"), 2 },         { TEXT("PAKFILE"), 0 },             { TEXT("CLIPPORTALVERTS"), 12 },
+    { TEXT("CUBEMAPS"), 16 },           { TEXT("TEXDATA_STRING_DATA"), 0 }, { TEXT("TEXDATA_STRING_TABLE"), 4 },
+    { TEXT("OVERLAYS"), 352 },          { TEXT("LEAFMINDISTTOWATER"), 2 },  { TEXT("FACE_MACRO_TEXTURE_INFO"), 2 },
+    { TEXT("DISP_TRIS"), 2 },           { TEXT("PHYSCOLLIDESURFACE"), 0 },  { TEXT("WATEROVERLAYS"), 0 },
+    { TEXT("LEAF_AMBIENT_INDEX_HDR"), 4 }, { TEXT("LEAF_AMBIENT_INDEX"), 4 }, { TEXT("LIGHTING_HDR"), 4 },
+    { TEXT("WORLDLIGHTS_HDR"), 88 },    { TEXT("LEAF_AMBIENT_LIGHTING_HDR"), 28 }, { TEXT("LEAF_AMBIENT_LIGHTING"), 28 },
+    { TEXT("XZIPPAKFILE"), 0 },         { TEXT("FACES_HDR"), 56 },          { TEXT("MAP_FLAGS"), 0 },
+    { TEXT("OVERLAY_FADES"), 8 },       { TEXT("UNUSED61"), 0 },            { TEXT("UNUSED62"), 0 },
+    { TEXT("UNUSED63"), 0 },
+};
+
+static TSharedRef<FJsonObject> MakeStagesJson(const FHL2ImportTimings& T)
+{
+    TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+    Obj->SetNumberField(TEXT("parse_ms"), T.Parse * 1000.0);
+    Obj->SetNumberField(TEXT("build_mesh_description_ms"), T.Build * 1000.0);
+    Obj->SetNumberField(TEXT("normals_tangents_ms"), T.Normals * 1000.0);
+    Obj->SetNumberField(TEXT("brush_hulls_ms"), T.Collision * 1000.0);
+    Obj->SetNumberField(TEXT("build_static_mesh_ms"), T.MeshBuild * 1000.0);
+    Obj->SetNumberField(TEXT("save_ms"), T.Save * 1000.0);
+    return Obj;
+}
+
+static TSharedRef<FJsonObject> MakeMemoryJson(const FHL2ImportMemory& M)
+{
+    TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+    Obj->SetNumberField(TEXT("used_after_parse_bytes"), (double)M.AfterParse);
+    Obj->SetNumberField(TEXT("used_after_build_bytes"), (double)M.AfterBuild);
+    Obj->SetNumberField(TEXT("used_after_normals_bytes"), (double)M.AfterNormals);
+    Obj->SetNumberField(TEXT("used_after_static_mesh_bytes"), (double)M.AfterMeshBuild);
+    // Process-wide high-water mark, so it also covers anything imported earlier in the session
+    Obj->SetNumberField(TEXT("peak_used_physical_bytes"), (double)FPlatformMemory::GetStats().PeakUsedPhysical);
+    return Obj;
+}
+
+static TSharedRef<FJsonObject> MakeCullJson(const FBspCullStats& Cull)
+{
+    static const TCHAR* ReasonNames[(int32)EBspCullReason::Num] = { nullptr, TEXT("nodraw"), TEXT("sky"), TEXT("skip"), TEXT("hint"), TEXT("trigger"), TEXT("tool_texture"), TEXT("unreachable") };
+    TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+    for (int32 r = 1; r < (int32)EBspCullReason::Num; ++r)
+    {
+        Obj->SetNumberField(ReasonNames[r], Cull.Faces[r]);
+    }
+    Obj->SetNumberField(TEXT("total"), Cull.Total());
+    Obj->SetNumberField(TEXT("sky_faces_kept"), Cull.SkyFacesKept);
+    return Obj;
+}
+
+static TSharedRef<FJsonObject> MakeVisJson(const FBspVisStats& Vis)
+{
+    TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+    Obj->SetBoolField(TEXT("applied"), Vis.bApplied);
+    Obj->SetNumberField(TEXT("clusters"), Vis.Clusters);
+    Obj->SetNumberField(TEXT("start_clusters"), Vis.StartClusters);
+    Obj->SetNumberField(TEXT("reachable_clusters"), Vis.ReachableClusters);
+    Obj->SetNumberField(TEXT("faces_removed"), Vis.FacesRemoved);
+    Obj->SetNumberField(TEXT("triangles_removed"), Vis.TrianglesRemoved);
+    Obj->SetNumberField(TEXT("estimated_bytes_saved"), (double)Vis.BytesSaved);
+    Obj->SetNumberField(TEXT("ms"), Vis.Ms);
+    return Obj;
+}
+
+static TSharedRef<FJsonObject> MakeCollisionJson(const FHL2BrushCollisionStats& Stats)
+{
+    TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+    TSharedRef<FJsonObject> Groups = MakeShared<FJsonObject>();
+    for (int32 g = 0; g < (int32)EHL2CollisionGroup::Num; ++g)
+    {
+        Groups->SetNumberField(GetCollisionGroupName((EHL2CollisionGroup)g), Stats.Hulls[g]);
+    }
+    Obj->SetObjectField(TEXT("hulls_per_group"), Groups);
+    Obj->SetNumberField(TEXT("hulls"), Stats.TotalHulls());
+    Obj->SetNumberField(TEXT("hull_points"), Stats.Points);
+    Obj->SetNumberField(TEXT("brushes_skipped"), Stats.BrushesSkipped);
+    Obj->SetNumberField(TEXT("brushes_degenerate"), Stats.BrushesDegenerate);
+    return Obj;
+}
+
+// Triangles of LOD 1, 2, ...
+static TArray<TSharedPtr<FJsonValue>> MakeLODTrianglesJson(TConstArrayView<FMeshDescription> LODs)
+{
+    TArray<TSharedPtr<FJsonValue>> Values;
+    for (const FMeshDescription& LOD : LODs)
+    {
+        Values.Add(MakeShared<FJsonValueNumber>(LOD.Triangles().Num()));
+    }
+    return Values;
+}
+
+static TArray<TSharedPtr<FJsonValue>> MakeLumpsJson(const FBspFile& Bsp)
+{
+    TArray<TSharedPtr<FJsonValue>> Lumps;
+    const FBspHeader* Header = Bsp.GetHeader();
+    if (!Header) return Lumps;
+    for (int32 i = 0; i < (int32)UE_ARRAY_COUNT(HL2LumpDescs); ++i)
+    {
+        const FLumpInfo& L = Header->Lumps[i];
+        if (L.Len <= 0) continue;
+        TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+        Obj->SetNumberField(TEXT("index"), i);
+        Obj->SetStringField(TEXT("name"), HL2LumpDescs[i].Name);
+        Obj->SetNumberField(TEXT("bytes"), L.Len);
+        Obj->SetNumberField(TEXT("version"), L.Version);
+        if (HL2LumpDescs[i].ElementSize > 0)
+        {
+            Obj->SetNumberField(TEXT("elements"), L.Len / HL2LumpDescs[i].ElementSize);
+        }
+        Lumps.Add(MakeShared<FJsonValueObject>(Obj));
+    }
+    return Lumps;
+}
+
+bool WriteImportReport(const FHL2PreparedMap& Map, const FString& PackageName, double WallSeconds)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_ImportReport);
+
+    TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+    Root->SetNumberField(TEXT("schema"), 1);
+    Root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+    Root->SetStringField(TEXT("source"), Map.Filename);
+    Root->SetStringField(TEXT("package"), PackageName);
+    Root->SetNumberField(TEXT("file_bytes"), Map.Bsp.GetRawData().Num());
+    Root->SetBoolField(TEXT("memory_mapped"), Map.Bsp.IsMapped());
+    if (const FBspHeader* Header = Map.Bsp.GetHeader())
+    {
+        Root->SetNumberField(TEXT("bsp_version"), Header->Version);
+        Root->SetNumberField(TEXT("map_revision"), Header->MapRevision);
+    }
+
+    Root->SetNumberField(TEXT("wall_ms"), WallSeconds * 1000.0);
+    Root->SetObjectField(TEXT("stages"), MakeStagesJson(Map.Timings));
+
+    const FBspDecodeStats& Decode = Map.Bsp.GetDecodeStats();
+    TSharedRef<FJsonObject> DecodeObj = MakeShared<FJsonObject>();
+    DecodeObj->SetNumberField(TEXT("wall_ms"), Decode.WallMs);
+    for (const TPair<const TCHAR*, double>& Task : Decode.TaskCpuMs)
+    {
+        DecodeObj->SetNumberField(FString(Task.Key) + TEXT("_ms"), Task.Value);
+    }
+    Root->SetObjectField(TEXT("decode"), DecodeObj);
+    Root->SetObjectField(TEXT("memory"), MakeMemoryJson(Map.Memory));
+    Root->SetArrayField(TEXT("lumps"), MakeLumpsJson(Map.Bsp));
+
+    const FHL2MeshBuildStats& Stats = Map.BuildStats;
+    TSharedRef<FJsonObject> Mesh = MakeShared<FJsonObject>();
+    Mesh->SetNumberField(TEXT("faces_built"), Stats.FacesBuilt);
+    Mesh->SetNumberField(TEXT("faces_skipped"), Stats.FacesSkipped);
+    Mesh->SetNumberField(TEXT("faces_merged"), Stats.FacesMerged);
+    Mesh->SetNumberField(TEXT("collinear_corners_removed"), Stats.CollinearCornersRemoved);
+    Mesh->SetNumberField(TEXT("displacements_built"), Stats.DispsBuilt);
+    Mesh->SetNumberField(TEXT("displacements_skipped"), Stats.DispsSkipped);
+    Mesh->SetNumberField(TEXT("displacement_nodes_stitched"), Stats.DispNodesStitched);
+    Mesh->SetNumberField(TEXT("vertices"), Stats.Vertices);
+    Mesh->SetNumberField(TEXT("vertex_instances"), Stats.VertexInstances);
+    Mesh->SetNumberField(TEXT("triangles"), Stats.Triangles);
+    Mesh->SetNumberField(TEXT("degenerate_triangles"), Stats.DegenerateTriangles);
+    Mesh->SetNumberField(TEXT("collapsed_triangles"), Stats.CollapsedTriangles);
+    Mesh->SetArrayField(TEXT("lod_triangles"), MakeLODTrianglesJson(Map.LODMeshDescriptions));
+    TArray<TSharedPtr<FJsonValue>> Slots;
+    for (int32 i = 0; i < Map.SlotNames.Num(); ++i)
+    {
+        TSharedRef<FJsonObject> Slot = MakeShared<FJsonObject>();
+        Slot->SetStringField(TEXT("slot"), Map.SlotNames[i].ToString());
+        Slot->SetNumberField(TEXT("triangles"), Stats.TrianglesPerSlot.IsValidIndex(i) ? Stats.TrianglesPerSlot[i] : 0);
+        Slots.Add(MakeShared<FJsonValueObject>(Slot));
+    }
+    Mesh->SetArrayField(TEXT("material_slots"), Slots);
+    TSharedRef<FJsonObject> SlotCompaction = MakeShared<FJsonObject>();
+    SlotCompaction->SetNumberField(TEXT("meshes"), Map.SlotCompaction.Meshes);
+    SlotCompaction->SetNumberField(TEXT("slots_before"), Map.SlotCompaction.SlotsBefore);
+    SlotCompaction->SetNumberField(TEXT("slots_after"), Map.SlotCompaction.SlotsAfter);
+    SlotCompaction->SetNumberField(TEXT("ms"), Map.SlotCompaction.Seconds * 1000.0);
+    Mesh->SetObjectField(TEXT("slot_compaction"), SlotCompaction);
+    Mesh->SetObjectField(TEXT("culled_faces"), MakeCullJson(Map.Bsp.GetCullStats()));
+    Mesh->SetObjectField(TEXT("pvs"), MakeVisJson(Map.Bsp.GetVisStats()));
+    Mesh->SetNumberField(TEXT("sky_triangles"), Map.SkyMeshDescription.Triangles().Num());
+    if (Map.Chunks.Num() > 0)
+    {
+        TArray<TSharedPtr<FJsonValue>> Chunks;
+        for (const FHL2MeshChunk& Chunk : Map.Chunks)
+        {
+            TSharedRef<FJsonObject> Obj = MakeShared<FJsonObject>();
+            Obj->SetNumberField(TEXT("cell_x"), Chunk.Cell.X);
+            Obj->SetNumberField(TEXT("cell_y"), Chunk.Cell.Y);
+            Obj->SetNumberField(TEXT("triangles"), Chunk.BuildStats.Triangles);
+            Obj->SetNumberField(TEXT("vertices"), Chunk.BuildStats.Vertices);
+            Obj->SetNumberField(TEXT("material_slots"), Chunk.SlotNames.Num());
+            Obj->SetNumberField(TEXT("brush_hulls"), Chunk.CollisionHulls.Num());
+            Obj->SetNumberField(TEXT("lightmap_charts"), Chunk.Lightmap.Charts.Num());
+            Obj->SetNumberField(TEXT("clusters"), Chunk.Clusters.Num());
+            Obj->SetArrayField(TEXT("lod_triangles"), MakeLODTrianglesJson(Chunk.LODs));
+            Obj->SetStringField(TEXT("lightmap_size"), Chunk.Lightmap.Size.ToString());
+            Obj->SetStringField(TEXT("bounds_min"), Chunk.Bounds.Min.ToString());
+            Obj->SetStringField(TEXT("bounds_max"), Chunk.Bounds.Max.ToString());
+            Chunks.Add(MakeShared<FJsonValueObject>(Obj));
+        }
+        Mesh->SetArrayField(TEXT("chunks"), Chunks);
+    }
+    Root->SetObjectField(TEXT("mesh"), Mesh);
+    if (Stats.LightmapCharts > 0)
+    {
+        TSharedRef<FJsonObject> Lightmap = MakeShared<FJsonObject>();
+        Lightmap->SetNumberField(TEXT("charts"), Stats.LightmapCharts);
+        Lightmap->SetNumberField(TEXT("size_x"), Map.Lightmap.Size.X);
+        Lightmap->SetNumberField(TEXT("size_y"), Map.Lightmap.Size.Y);
+        bool bBaked = Map.Lightmap.Texels.Num() > 0;
+        for (const FHL2MeshChunk& Chunk : Map.Chunks)
+        {
+            bBaked |= Chunk.Lightmap.Texels.Num() > 0;
+        }
+        Lightmap->SetBoolField(TEXT("baked"), bBaked);
+        Root->SetObjectField(TEXT("lightmap"), Lightmap);
+    }
+    if (Map.BrushModelStats.Models > 0)
+    {
+        const FHL2BrushModelStats& Brush = Map.BrushModelStats;
+        TSharedRef<FJsonObject> Models = MakeShared<FJsonObject>();
+        Models->SetNumberField(TEXT("submodels"), Brush.Models);
+        Models->SetNumberField(TEXT("referenced"), Brush.Referenced);
+        Models->SetNumberField(TEXT("empty"), Brush.Empty);
+        Models->SetNumberField(TEXT("distinct_meshes"), Brush.Groups);
+        Models->SetNumberField(TEXT("entities"), Brush.Placements);
+        Models->SetNumberField(TEXT("triangles"), Brush.Triangles);
+        Root->SetObjectField(TEXT("brush_models"), Models);
+    }
+    if (Map.Bsp.GetStaticProps().Num() > 0)
+    {
+        TSharedRef<FJsonObject> Props = MakeShared<FJsonObject>();
+        Props->SetNumberField(TEXT("placements"), Map.Bsp.GetStaticProps().Num());
+        Props->SetNumberField(TEXT("models"), Map.Bsp.GetStaticPropModels().Num());
+        Props->SetNumberField(TEXT("instance_batches"), Map.PropBatches.Num());
+        Root->SetObjectField(TEXT("static_props"), Props);
+    }
+    if (Map.CollisionStats.TotalHulls() > 0)
+    {
+        Root->SetObjectField(TEXT("brush_collision"), MakeCollisionJson(Map.CollisionStats));
+    }
+    if (Map.VisibilityStats.Sections > 0)
+    {
+        const FHL2VisibilityStats& Vis = Map.VisibilityStats;
+        TSharedRef<FJsonObject> Visibility = MakeShared<FJsonObject>();
+        Visibility->SetNumberField(TEXT("clusters"), Vis.Clusters);
+        Visibility->SetNumberField(TEXT("areas"), Vis.Areas);
+        Visibility->SetNumberField(TEXT("area_portals"), Vis.AreaPortals);
+        Visibility->SetNumberField(TEXT("sections"), Vis.Sections);
+        Visibility->SetNumberField(TEXT("untagged_sections"), Vis.UntaggedSections);
+        Visibility->SetNumberField(TEXT("avg_visible_sections"), Vis.AvgVisibleSections);
+        Visibility->SetNumberField(TEXT("bytes"), (double)Vis.Bytes);
+        Visibility->SetNumberField(TEXT("ms"), Vis.Seconds * 1000.0);
+        Root->SetObjectField(TEXT("visibility"), Visibility);
+    }
+
+    FString JsonText;
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonText);
+    FJsonSerializer::Serialize(Root, Writer);
+    const FString ReportPath = FPackageName::LongPackageNameToFilename(PackageName, TEXT(".ImportReport.json"));
+    if (!FFileHelper::SaveStringToFile(JsonText, *ReportPath))
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("Failed to write import report: %s"), *ReportPath);
+        return false;
+    }
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Import report written to %s"), *ReportPath);
+    return true;
+}
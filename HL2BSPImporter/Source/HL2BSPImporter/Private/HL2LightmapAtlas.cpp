@@ -0,0 +1,168 @@
+#include "HL2LightmapAtlas.h"
+#include "HL2BSPImporter.h"
+#include "BspFile.h"
+#include "Engine/Texture2D.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+
+// Source lightmaps -> one packed page per mesh: charts in luxels, shelf packing, RGBE decode of light style 0.
+
+DECLARE_CYCLE_STAT(TEXT("Lightmap Pack"), STAT_HL2_LightmapPack, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Lightmap Bake"), STAT_HL2_LightmapBake, STATGROUP_HL2BSPImporter);
+
+static constexpr int32 HL2LightmapChartPadding = 1;   // texels around each chart, so bilinear filtering stays inside it
+static constexpr int32 HL2LightmapMaxChartSize = 512; // samples per axis; larger charts are scaled down
+
+int32 FHL2LightmapAtlas::AddChart(const FVector2f& Min, const FVector2f& Max, TConstArrayView<int32> Faces)
+{
+    FHL2LightmapChart& Chart = Charts.AddDefaulted_GetRef();
+    Chart.Mins = FIntPoint(FMath::FloorToInt(Min.X), FMath::FloorToInt(Min.Y));
+    const FIntPoint Extent(FMath::Max(0, FMath::CeilToInt(Max.X) - Chart.Mins.X), FMath::Max(0, FMath::CeilToInt(Max.Y) - Chart.Mins.Y));
+    const int32 LargestExtent = FMath::Max(Extent.X, Extent.Y);
+    if (LargestExtent >= HL2LightmapMaxChartSize)
+    {
+        Chart.Scale = (float)(HL2LightmapMaxChartSize - 1) / (float)LargestExtent;
+    }
+    Chart.Size = FIntPoint(FMath::CeilToInt(Extent.X * Chart.Scale) + 1, FMath::CeilToInt(Extent.Y * Chart.Scale) + 1);
+    Chart.FirstFace = ChartFaces.Num();
+    Chart.NumFaces = Faces.Num();
+    ChartFaces.Append(Faces);
+    return Charts.Num() - 1;
+}
+
+void PackLightmapAtlas(FHL2LightmapAtlas& Atlas)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_LightmapPack);
+    const int32 Pad2 = HL2LightmapChartPadding * 2;
+    TArray<int32> Order;
+    Order.Reserve(Atlas.Charts.Num());
+    int64 Area = 0;
+    int32 Widest = 1;
+    for (int32 c = 0; c < Atlas.Charts.Num(); ++c)
+    {
+        const FIntPoint& Size = Atlas.Charts[c].Size;
+        Order.Add(c);
+        Area += (int64)(Size.X + Pad2) * (Size.Y + Pad2);
+        Widest = FMath::Max(Widest, Size.X + Pad2);
+    }
+    Order.Sort([&Atlas](int32 A, int32 B)
+    {
+        const FIntPoint& SA = Atlas.Charts[A].Size;
+        const FIntPoint& SB = Atlas.Charts[B].Size;
+        return SA.Y != SB.Y ? SA.Y > SB.Y : (SA.X != SB.X ? SA.X > SB.X : A < B);
+    });
+
+    // Shelves fill a page about as wide as it will be tall
+    const int32 Width = Align(FMath::Max(Widest, FMath::CeilToInt(FMath::Sqrt((double)Area))), 4);
+    int32 X = 0;
+    int32 ShelfY = 0;
+    int32 ShelfHeight = 0;
+    for (int32 c : Order)
+    {
+        FHL2LightmapChart& Chart = Atlas.Charts[c];
+        if (X + Chart.Size.X + Pad2 > Width)
+        {
+            X = 0;
+            ShelfY += ShelfHeight;
+            ShelfHeight = 0;
+        }
+        Chart.Origin = FIntPoint(X + HL2LightmapChartPadding, ShelfY + HL2LightmapChartPadding);
+        X += Chart.Size.X + Pad2;
+        ShelfHeight = FMath::Max(ShelfHeight, Chart.Size.Y + Pad2);
+    }
+    Atlas.Size = Atlas.Charts.Num() > 0 ? FIntPoint(Width, Align(FMath::Max(1, ShelfY + ShelfHeight), 4)) : FIntPoint::ZeroValue;
+}
+
+static FFloat16Color DecodeRGBExp32(const DColorRGBExp32& C)
+{
+    const float Scale = FMath::Exp2((float)C.Exponent) / 255.f;
+    return FFloat16Color(FLinearColor(C.R * Scale, C.G * Scale, C.B * Scale, 1.f));
+}
+
+bool BakeLightmapAtlas(const FBspFile& Bsp, FHL2LightmapAtlas& Atlas)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_LightmapBake);
+    const FBspGeometry& Geo = Bsp.GetGeometry();
+    TConstArrayView<DColorRGBExp32> Samples;
+    TConstArrayView<DFace> HDRFaces;
+    Bsp.GetLumpView(BspLump::Lighting, Samples);
+    const bool bHDR = Samples.Num() == 0;
+    if (bHDR)
+    {
+        // HDR-only maps keep their offsets in the HDR copy of the face lump
+        Bsp.GetLumpView(BspLump::LightingHDR, Samples);
+        Bsp.GetLumpView(BspLump::FacesHDR, HDRFaces);
+    }
+    if (Samples.Num() == 0 || Atlas.Charts.Num() == 0)
+    {
+        Atlas.Texels.Reset();
+        return false;
+    }
+    auto GetLightOfs = [&](int32 Face) -> int32
+    {
+        if (Geo.FaceLightOfs[Face] < 0) return -1;
+        return bHDR ? (HDRFaces.IsValidIndex(Face) ? HDRFaces[Face].Lightofs : -1) : Geo.FaceLightOfs[Face];
+    };
+
+    Atlas.Texels.Init(FFloat16Color(FLinearColor::Black), Atlas.Size.X * Atlas.Size.Y);
+    const FFloat16Color Unlit(FLinearColor::White);
+    ParallelFor(TEXT("HL2BSP.BakeLightmap"), Atlas.Charts.Num(), 16, [&](int32 c)
+    {
+        const FHL2LightmapChart& Chart = Atlas.Charts[c];
+        const TConstArrayView<int32> Faces(Atlas.ChartFaces.GetData() + Chart.FirstFace, Chart.NumFaces);
+        // The padding ring repeats the nearest edge sample
+        for (int32 y = -HL2LightmapChartPadding; y < Chart.Size.Y + HL2LightmapChartPadding; ++y)
+        {
+            for (int32 x = -HL2LightmapChartPadding; x < Chart.Size.X + HL2LightmapChartPadding; ++x)
+            {
+                const int32 LX = Chart.Mins.X + FMath::RoundToInt(FMath::Clamp(x, 0, Chart.Size.X - 1) / Chart.Scale);
+                const int32 LY = Chart.Mins.Y + FMath::RoundToInt(FMath::Clamp(y, 0, Chart.Size.Y - 1) / Chart.Scale);
+
+                // Merged polygons span several faces: take the face whose lightmap holds the luxel, or the closest one
+                FFloat16Color Texel = Unlit;
+                int32 BestDist = MAX_int32;
+                for (int32 Face : Faces)
+                {
+                    const FIntPoint FaceSize = Geo.FaceLightmapSize[Face];
+                    const int32 LightOfs = GetLightOfs(Face);
+                    if (FaceSize.X == 0 || FaceSize.Y == 0 || LightOfs < 0) continue;
+                    const FIntPoint& FaceMins = Geo.FaceLightmapMins[Face];
+                    const int32 SX = FMath::Clamp(LX, FaceMins.X, FaceMins.X + FaceSize.X - 1);
+                    const int32 SY = FMath::Clamp(LY, FaceMins.Y, FaceMins.Y + FaceSize.Y - 1);
+                    const int32 Dist = FMath::Abs(SX - LX) + FMath::Abs(SY - LY);
+                    if (Dist >= BestDist) continue;
+                    const int64 Sample = LightOfs / (int32)sizeof(DColorRGBExp32) + (int64)(SY - FaceMins.Y) * FaceSize.X + (SX - FaceMins.X);
+                    if (Sample < 0 || Sample >= Samples.Num()) continue;
+                    BestDist = Dist;
+                    Texel = DecodeRGBExp32(Samples[Sample]);
+                    if (Dist == 0) break;
+                }
+                Atlas.Texels[(Chart.Origin.Y + y) * Atlas.Size.X + Chart.Origin.X + x] = Texel;
+            }
+        }
+    });
+    return true;
+}
+
+UTexture2D* CreateLightmapTexture(const FHL2LightmapAtlas& Atlas, UObject* Outer, FName Name, EObjectFlags Flags)
+{
+    check(IsInGameThread());
+    if (Atlas.Texels.Num() == 0 || Atlas.Texels.Num() != Atlas.Size.X * Atlas.Size.Y)
+    {
+        return nullptr;
+    }
+    UTexture2D* Texture = NewObject<UTexture2D>(Outer, Name, Flags);
+    Texture->Source.Init(Atlas.Size.X, Atlas.Size.Y, 1, 1, TSF_RGBA16F, reinterpret_cast<const uint8*>(Atlas.Texels.GetData()));
+    Texture->CompressionSettings = TC_HDR;
+    Texture->SRGB = false;
+    Texture->MipGenSettings = TMGS_NoMipmaps;
+    Texture->LODGroup = TEXTUREGROUP_World;
+    Texture->AddressX = TA_Clamp;
+    Texture->AddressY = TA_Clamp;
+    Texture->PostEditChange();
+
+    FAssetRegistryModule::AssetCreated(Texture);
+    Texture->MarkPackageDirty();
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Created lightmap texture %s (%dx%d, %d charts)"), *Texture->GetName(), Atlas.Size.X, Atlas.Size.Y, Atlas.Charts.Num());
+    return Texture;
+}
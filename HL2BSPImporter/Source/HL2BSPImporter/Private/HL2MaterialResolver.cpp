@@ -0,0 +1,184 @@
+#include "HL2MaterialResolver.h"
+#include "HL2BSPImporter.h"
+#include "HL2BSPImporterSettings.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Interfaces/IPluginManager.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+
+DECLARE_CYCLE_STAT(TEXT("Material Requests"), STAT_HL2_MaterialRequest, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Material Resolve"), STAT_HL2_MaterialResolve, STATGROUP_HL2BSPImporter);
+
+// Chooses the material JSON: settings path (absolute or /Game/...) first, then the plugin fallback
+static FString FindMaterialJson(const UHL2BSPImporterSettings* Sets)
+{
+    if (Sets && !Sets->MaterialJsonPath.IsEmpty())
+    {
+        const FString& P = Sets->MaterialJsonPath;
+        if (P.StartsWith(TEXT("/Game/")))
+        {
+            FString Rel = P.RightChop(6); // strip /Game/
+            if (!Rel.EndsWith(TEXT(".json")))
+            {
+                Rel += TEXT(".json");
+            }
+            const FString Abs = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir() / Rel);
+            if (FPaths::FileExists(Abs))
+            {
+                return Abs;
+            }
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("MaterialJsonPath points to '/Game/...', but file was not found: %s"), *Abs);
+        }
+        else if (FPaths::FileExists(P))
+        {
+            return P;
+        }
+    }
+
+    // Fallback to plugin Resources/Materials.json
+    if (const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("HL2BSPImporter")))
+    {
+        const FString Fallback = Plugin->GetBaseDir() / TEXT("Resources/Materials.json");
+        if (FPaths::FileExists(Fallback))
+        {
+            return Fallback;
+        }
+    }
+    return FString();
+}
+
+static void ParseMaterialJson(const FString& Path, FHL2MaterialIndex& Out)
+{
+    FString JsonStr;
+    if (!FFileHelper::LoadFileToString(JsonStr, *Path))
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("Failed to read material JSON: %s"), *Path);
+        return;
+    }
+
+    TSharedPtr<FJsonValue> RootValue;
+    const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonStr);
+    if (!FJsonSerializer::Deserialize(Reader, RootValue) || !RootValue.IsValid() || RootValue->Type != EJson::Array)
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("Material JSON is not an array: %s"), *Path);
+        return;
+    }
+
+    const TArray<TSharedPtr<FJsonValue>>& Arr = RootValue->AsArray();
+    Out.ByTexture.Reserve(Arr.Num());
+    for (const TSharedPtr<FJsonValue>& V : Arr)
+    {
+        if (!V.IsValid() || V->Type != EJson::Object) continue;
+        const TSharedPtr<FJsonObject> Obj = V->AsObject();
+        FString TextureName;
+        FString MaterialPath;
+        if (!Obj->TryGetStringField(TEXT("TextureName"), TextureName)) continue;
+        if (!Obj->TryGetStringField(TEXT("MaterialPath"), MaterialPath)) continue;
+        Out.ByTexture.Add(FHL2MaterialIndex::NormalizeTextureName(TextureName), FSoftObjectPath(MaterialPath));
+    }
+}
+
+FString FHL2MaterialIndex::NormalizeTextureName(const FString& TextureName)
+{
+    FString Key = TextureName.ToLower();
+    Key.ReplaceCharInline(TEXT('\\'), TEXT('/'));
+    return Key;
+}
+
+TSharedRef<const FHL2MaterialIndex> FHL2MaterialResolver::GetIndex(const UHL2BSPImporterSettings* Sets)
+{
+    static FCriticalSection CacheLock;
+    static TSharedPtr<const FHL2MaterialIndex> Cached;
+
+    const FString Path = FindMaterialJson(Sets);
+    const FDateTime Timestamp = Path.IsEmpty() ? FDateTime::MinValue() : IFileManager::Get().GetTimeStamp(*Path);
+
+    FScopeLock Lock(&CacheLock);
+    if (Cached.IsValid() && Cached->SourcePath == Path && Cached->Timestamp == Timestamp)
+    {
+        return Cached.ToSharedRef();
+    }
+
+    TSharedRef<FHL2MaterialIndex> Index = MakeShared<FHL2MaterialIndex>();
+    Index->SourcePath = Path;
+    Index->Timestamp = Timestamp;
+    if (Path.IsEmpty())
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("No candidate material JSON found. Using empty material map."));
+    }
+    else
+    {
+        const double Start = FPlatformTime::Seconds();
+        ParseMaterialJson(Path, *Index);
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("Indexed %d material mappings from: %s (%.2fms)"), Index->ByTexture.Num(), *Path, (FPlatformTime::Seconds() - Start) * 1000.0);
+    }
+    Cached = Index;
+    return Index;
+}
+
+FHL2MaterialResolver::FHL2MaterialResolver(TSharedRef<const FHL2MaterialIndex> InIndex)
+    : Index(MoveTemp(InIndex))
+{
+}
+
+FHL2MaterialResolver::~FHL2MaterialResolver()
+{
+    if (Handle.IsValid())
+    {
+        Handle->ReleaseHandle();
+    }
+}
+
+void FHL2MaterialResolver::RequestLoads(TConstArrayView<FName> SlotNames)
+{
+    check(IsInGameThread());
+    HL2_STAGE_SCOPE(STAT_HL2_MaterialRequest);
+    TArray<FSoftObjectPath> Paths;
+    Paths.Reserve(SlotNames.Num());
+    for (const FName& Slot : SlotNames)
+    {
+        if (const FSoftObjectPath* Path = Index->Find(Slot))
+        {
+            if (!Path->IsNull())
+            {
+                Paths.AddUnique(*Path);
+            }
+        }
+    }
+    NumRequestedPaths = Paths.Num();
+    if (Paths.Num() == 0) return;
+
+    Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Paths), FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Material loads requested: %d paths for %d slots"), NumRequestedPaths, SlotNames.Num());
+}
+
+UMaterialInterface* FHL2MaterialResolver::Resolve(FName SlotName)
+{
+    check(IsInGameThread());
+    HL2_STAGE_SCOPE(STAT_HL2_MaterialResolve);
+    const FSoftObjectPath* Path = Index->Find(SlotName);
+    if (!Path || Path->IsNull())
+    {
+        return nullptr;
+    }
+    if (Handle.IsValid() && Handle->IsLoadingInProgress())
+    {
+        const double Start = FPlatformTime::Seconds();
+        Handle->WaitUntilComplete();
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("Waited %.2fms for material loads"), (FPlatformTime::Seconds() - Start) * 1000.0);
+    }
+    // Loaded by the batch; also covers slots that were not part of RequestLoads (synchronous fallback)
+    UObject* Loaded = Path->ResolveObject();
+    if (!Loaded)
+    {
+        Loaded = Path->TryLoad();
+    }
+    return Cast<UMaterialInterface>(Loaded);
+}
@@ -0,0 +1,57 @@
+#include "HL2MaterialSlots.h"
+#include "HL2BSPImporter.h"
+#include "MeshDescription.h"
+#include "StaticMeshAttributes.h"
+
+// Material slot compaction: one polygon group per resolved material instead of per texture name.
+
+DECLARE_CYCLE_STAT(TEXT("Slot Compaction"), STAT_HL2_SlotCompaction, STATGROUP_HL2BSPImporter);
+
+int32 CompactMaterialSlots(FMeshDescription& MD, const TMap<FName, FName>& SlotRedirects)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_SlotCompaction);
+    if (SlotRedirects.Num() == 0)
+    {
+        return 0;
+    }
+    FStaticMeshAttributes Attrs(MD);
+    TPolygonGroupAttributesRef<FName> SlotNames = Attrs.GetPolygonGroupMaterialSlotNames();
+
+    // Groups are visited in creation order, so the first one of a slot keeps its place and collects the others
+    TArray<FPolygonGroupID> Groups;
+    Groups.Reserve(MD.PolygonGroups().Num());
+    for (const FPolygonGroupID PG : MD.PolygonGroups().GetElementIDs())
+    {
+        Groups.Add(PG);
+    }
+    TMap<FName, FPolygonGroupID> Kept;
+    TArray<FPolygonID> Polygons;
+    int32 Removed = 0;
+    for (const FPolygonGroupID PG : Groups)
+    {
+        const FName* Redirect = SlotRedirects.Find(SlotNames[PG]);
+        const FName Slot = Redirect ? *Redirect : SlotNames[PG];
+        const FPolygonGroupID* Into = Kept.Find(Slot);
+        if (!Into)
+        {
+            Kept.Add(Slot, PG);
+            SlotNames[PG] = Slot;
+            continue;
+        }
+        Polygons.Reset();
+        Polygons.Append(MD.GetPolygonGroupPolygonIDs(PG));
+        for (const FPolygonID Polygon : Polygons)
+        {
+            MD.SetPolygonPolygonGroup(Polygon, *Into);
+        }
+        MD.DeletePolygonGroup(PG);
+        ++Removed;
+    }
+    if (Removed > 0)
+    {
+        // Dense group IDs again (the builder leaves no holes in the other elements)
+        FElementIDRemappings Remappings;
+        MD.Compact(Remappings);
+    }
+    return Removed;
+}
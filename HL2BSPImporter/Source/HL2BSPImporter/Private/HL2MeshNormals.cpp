@@ -0,0 +1,164 @@
+#include "HL2MeshNormals.h"
+#include "HL2BSPImporter.h"
+#include "Async/ParallelFor.h"
+
+// Smoothing-group aware normals and MikkTSpace-style tangents straight from the builder's point streams.
+
+DECLARE_CYCLE_STAT(TEXT("Build Normals/Tangents"), STAT_HL2_BuildNormals, STATGROUP_HL2BSPImporter);
+
+static constexpr int32 HL2NormalBatchSize = 4096;
+static constexpr float HL2DegenerateArea2 = UE_KINDA_SMALL_NUMBER;   // squared doubled area, Unreal units
+
+static float CornerAngle(const FVector3f& P, const FVector3f& A, const FVector3f& B)
+{
+    const FVector3f E0 = (A - P).GetSafeNormal();
+    const FVector3f E1 = (B - P).GetSafeNormal();
+    return FMath::Acos(FMath::Clamp(FVector3f::DotProduct(E0, E1), -1.f, 1.f));
+}
+
+void ComputeTangentFrames(TConstArrayView<FHL2NormalRegion> Regions, TConstArrayView<FVector3f> Positions, TConstArrayView<FVector2f> UVs,
+                          TConstArrayView<int32> PointVertex, int32 NumVertices, TConstArrayView<int32> TriPoints, FHL2TangentFrames& Out)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_BuildNormals);
+    const int32 NumPoints = Positions.Num();
+    TArray<FVector3f> AccNormals; AccNormals.SetNumZeroed(NumPoints);
+    TArray<FVector3f> AccTangents; AccTangents.SetNumZeroed(NumPoints);
+    TArray<FVector3f> AccBitangents; AccBitangents.SetNumZeroed(NumPoints);
+    TArray<int32> PointRegion; PointRegion.SetNumUninitialized(NumPoints);
+    TArray<int32> RegionDegenerate; RegionDegenerate.SetNumZeroed(Regions.Num());
+    TArray<int32> RegionCollapsed; RegionCollapsed.SetNumZeroed(Regions.Num());
+
+    // Pass 1: angle-weighted sums inside each region. A region owns its points, so regions run without locks.
+    ParallelFor(TEXT("HL2BSP.RegionFrames"), Regions.Num(), 64, [&](int32 r)
+    {
+        const FHL2NormalRegion& Region = Regions[r];
+        const int32 EndPoint = r + 1 < Regions.Num() ? Regions[r + 1].FirstPoint : NumPoints;
+        TArray<float, TInlineAllocator<64>> Weights;
+        Weights.SetNumZeroed(EndPoint - Region.FirstPoint);
+        FVector3f Winding = FVector3f::ZeroVector;
+        for (int32 p = Region.FirstPoint; p < EndPoint; ++p)
+        {
+            PointRegion[p] = r;
+        }
+        for (int32 t = Region.FirstTri; t < Region.FirstTri + Region.NumTris; ++t)
+        {
+            const int32 Corner[3] = { TriPoints[t * 3 + 0], TriPoints[t * 3 + 1], TriPoints[t * 3 + 2] };
+            if (PointVertex[Corner[0]] == PointVertex[Corner[1]] || PointVertex[Corner[1]] == PointVertex[Corner[2]] || PointVertex[Corner[0]] == PointVertex[Corner[2]])
+            {
+                ++RegionCollapsed[r];
+            }
+            const FVector3f& P0 = Positions[Corner[0]];
+            const FVector3f& P1 = Positions[Corner[1]];
+            const FVector3f& P2 = Positions[Corner[2]];
+            const FVector3f D1 = P1 - P0;
+            const FVector3f D2 = P2 - P0;
+            const FVector3f Normal = FVector3f::CrossProduct(D2, D1);
+            const float Area2 = Normal.SizeSquared();
+            if (Area2 <= HL2DegenerateArea2)
+            {
+                ++RegionDegenerate[r];
+                continue;
+            }
+            Winding += Normal;
+            const FVector3f UnitNormal = Normal * FMath::InvSqrt(Area2);
+
+            // UV gradients: dP = T * du + B * dv over the triangle
+            const FVector2f E1 = UVs[Corner[1]] - UVs[Corner[0]];
+            const FVector2f E2 = UVs[Corner[2]] - UVs[Corner[0]];
+            const float UVArea = E1.X * E2.Y - E2.X * E1.Y;
+            FVector3f Tangent = FVector3f::ZeroVector;
+            FVector3f Bitangent = FVector3f::ZeroVector;
+            if (FMath::Abs(UVArea) > UE_SMALL_NUMBER)
+            {
+                const float InvArea = 1.f / UVArea;
+                Tangent = ((D1 * E2.Y - D2 * E1.Y) * InvArea).GetSafeNormal();
+                Bitangent = ((D2 * E1.X - D1 * E2.X) * InvArea).GetSafeNormal();
+            }
+
+            const float Angles[3] = { CornerAngle(P0, P1, P2), CornerAngle(P1, P2, P0), CornerAngle(P2, P0, P1) };
+            for (int32 k = 0; k < 3; ++k)
+            {
+                const int32 p = Corner[k];
+                AccNormals[p] += UnitNormal * Angles[k];
+                AccTangents[p] += Tangent * Angles[k];
+                AccBitangents[p] += Bitangent * Angles[k];
+                Weights[p - Region.FirstPoint] += Angles[k];
+            }
+        }
+
+        // Planar regions take the BSP plane normal at full weight, facing the same way as the winding
+        if (!Region.PlaneNormal.IsZero() && !Winding.IsZero())
+        {
+            const FVector3f PlaneNormal = FVector3f::DotProduct(Region.PlaneNormal, Winding) < 0.f ? -Region.PlaneNormal : Region.PlaneNormal;
+            for (int32 p = Region.FirstPoint; p < EndPoint; ++p)
+            {
+                AccNormals[p] = PlaneNormal * Weights[p - Region.FirstPoint];
+            }
+        }
+    });
+
+    // Welded vertex -> points (counting sort; points stay in stream order per vertex)
+    TArray<int32> VertexFirst; VertexFirst.SetNumZeroed(NumVertices + 1);
+    for (int32 p = 0; p < NumPoints; ++p)
+    {
+        ++VertexFirst[PointVertex[p] + 1];
+    }
+    for (int32 v = 0; v < NumVertices; ++v)
+    {
+        VertexFirst[v + 1] += VertexFirst[v];
+    }
+    TArray<int32> VertexPoints; VertexPoints.SetNumUninitialized(NumPoints);
+    {
+        TArray<int32> Cursor(VertexFirst.GetData(), NumVertices);
+        for (int32 p = 0; p < NumPoints; ++p)
+        {
+            VertexPoints[Cursor[PointVertex[p]]++] = p;
+        }
+    }
+
+    // Pass 2: smoothing across regions, then the frame
+    Out.Normals.SetNumUninitialized(NumPoints);
+    Out.Tangents.SetNumUninitialized(NumPoints);
+    Out.BinormalSigns.SetNumUninitialized(NumPoints);
+    ParallelFor(TEXT("HL2BSP.SmoothFrames"), NumPoints, HL2NormalBatchSize, [&](int32 p)
+    {
+        const uint32 Groups = Regions[PointRegion[p]].SmoothingGroups;
+        const FVector3f Own = AccNormals[p];
+        FVector3f Sum = Own;
+        if (Groups != 0)
+        {
+            const int32 V = PointVertex[p];
+            for (int32 i = VertexFirst[V]; i < VertexFirst[V + 1]; ++i)
+            {
+                const int32 q = VertexPoints[i];
+                if (PointRegion[q] == PointRegion[p] || !(Regions[PointRegion[q]].SmoothingGroups & Groups)) continue;
+                if (FVector3f::DotProduct(Own, AccNormals[q]) <= 0.f) continue;
+                Sum += AccNormals[q];
+            }
+        }
+        FVector3f Normal = Sum.GetSafeNormal();
+        if (Normal.IsZero())
+        {
+            Normal = FVector3f::UpVector;
+        }
+
+        // Gram-Schmidt against the final normal; UV-less or degenerate points get any perpendicular
+        FVector3f Tangent = (AccTangents[p] - Normal * FVector3f::DotProduct(Normal, AccTangents[p])).GetSafeNormal();
+        if (Tangent.IsZero())
+        {
+            FVector3f Unused;
+            Normal.FindBestAxisVectors(Tangent, Unused);
+        }
+        Out.Normals[p] = Normal;
+        Out.Tangents[p] = Tangent;
+        Out.BinormalSigns[p] = FVector3f::DotProduct(FVector3f::CrossProduct(Normal, Tangent), AccBitangents[p]) < 0.f ? -1.f : 1.f;
+    });
+
+    Out.DegenerateTriangles = 0;
+    Out.CollapsedTriangles = 0;
+    for (int32 r = 0; r < Regions.Num(); ++r)
+    {
+        Out.DegenerateTriangles += RegionDegenerate[r];
+        Out.CollapsedTriangles += RegionCollapsed[r];
+    }
+}
@@ -0,0 +1,157 @@
+#include "HL2StaticProps.h"
+#include "HL2BSPImporter.h"
+#include "BspFile.h"
+#include "HL2CoordTransform.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "GameFramework/Actor.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "UObject/Package.h"
+#include "Misc/Paths.h"
+
+// sprp static props -> one HISM per model in a companion level.
+
+FSoftObjectPath MakePropMeshPath(const FString& Model, const FString& MeshRoot)
+{
+    FString Path = Model.Replace(TEXT("\\"), TEXT("/"));
+    if (Path.EndsWith(TEXT(".mdl"), ESearchCase::IgnoreCase))
+    {
+        Path.LeftChopInline(4);
+    }
+    const FString AssetName = FPaths::GetCleanFilename(Path);
+    return FSoftObjectPath(MeshRoot / Path + TEXT(".") + AssetName);
+}
+
+void BuildStaticPropBatches(const FBspFile& Bsp, const FHL2CoordTransform& Xform, const FString& MeshRoot, TArray<FHL2PropBatch>& OutBatches)
+{
+    const TArray<FString>& Models = Bsp.GetStaticPropModels();
+    const TArray<FBspStaticProp>& Props = Bsp.GetStaticProps();
+    const float Scale = FVector3f(Xform.Rows[0].X, Xform.Rows[0].Y, Xform.Rows[0].Z).Size();
+
+    TArray<int32> BatchOfModel;
+    BatchOfModel.Init(INDEX_NONE, Models.Num());
+    TArray<bool> NeverFades;
+    OutBatches.Reset();
+    int32 NumSkinned = 0;
+    int32 NumInvalid = 0;
+    for (const FBspStaticProp& Prop : Props)
+    {
+        if (!Models.IsValidIndex(Prop.Model))
+        {
+            ++NumInvalid;
+            continue;
+        }
+        int32& BatchIndex = BatchOfModel[Prop.Model];
+        if (BatchIndex == INDEX_NONE)
+        {
+            BatchIndex = OutBatches.Num();
+            FHL2PropBatch& NewBatch = OutBatches.AddDefaulted_GetRef();
+            NewBatch.Model = Models[Prop.Model];
+            NewBatch.Mesh = MakePropMeshPath(NewBatch.Model, MeshRoot);
+            NeverFades.Add(false);
+        }
+        FHL2PropBatch& Batch = OutBatches[BatchIndex];
+        Batch.Instances.Emplace(Xform.TransformAngles(Prop.Angles), FVector(Xform.TransformPosition(Prop.Origin)));
+        Batch.bCollision |= Prop.Solid != 0;
+        if (Prop.FadeMaxDist > 0.f)
+        {
+            Batch.CullStart = FMath::Max(Batch.CullStart, FMath::Min(Prop.FadeMinDist, Prop.FadeMaxDist) * Scale);
+            Batch.CullEnd = FMath::Max(Batch.CullEnd, Prop.FadeMaxDist * Scale);
+        }
+        else
+        {
+            NeverFades[BatchIndex] = true;
+        }
+        NumSkinned += Prop.Skin != 0 ? 1 : 0;
+    }
+    for (int32 b = 0; b < OutBatches.Num(); ++b)
+    {
+        if (NeverFades[b])
+        {
+            OutBatches[b].CullStart = OutBatches[b].CullEnd = 0.f;
+        }
+    }
+
+    if (Props.Num() > 0)
+    {
+        UE_LOG(LogHL2BSPImporter, Log, TEXT("Static props: %d placements in %d model batches (invalid model index=%d, non-default skin=%d; skins use the default material set)"),
+            Props.Num() - NumInvalid, OutBatches.Num(), NumInvalid, NumSkinned);
+    }
+}
+
+UWorld* CreateStaticPropWorld(TConstArrayView<FHL2PropBatch> Batches, UPackage* Package, FName Name, EObjectFlags Flags)
+{
+    check(IsInGameThread());
+    if (Batches.Num() == 0)
+    {
+        return nullptr;
+    }
+
+    // One blocking request for every model mesh
+    TArray<FSoftObjectPath> Paths;
+    for (const FHL2PropBatch& Batch : Batches)
+    {
+        Paths.Add(Batch.Mesh);
+    }
+    TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestSyncLoad(MoveTemp(Paths));
+
+    TArray<int32> Placeable;
+    for (int32 b = 0; b < Batches.Num(); ++b)
+    {
+        if (Cast<UStaticMesh>(Batches[b].Mesh.ResolveObject()))
+        {
+            Placeable.Add(b);
+        }
+        else
+        {
+            UE_LOG(LogHL2BSPImporter, Warning, TEXT("No static mesh at %s for prop model '%s'; %d placements skipped."),
+                *Batches[b].Mesh.ToString(), *Batches[b].Model, Batches[b].Instances.Num());
+        }
+    }
+    if (Placeable.Num() == 0)
+    {
+        return nullptr;
+    }
+
+    UWorld* World = UWorld::CreateWorld(EWorldType::Inactive, false, Name, Package, false);
+    World->SetFlags(Flags);
+    AActor* Actor = World->SpawnActor<AActor>();
+    Actor->SetActorLabel(TEXT("HL2StaticProps"));
+    USceneComponent* Root = NewObject<USceneComponent>(Actor, TEXT("Root"));
+    Root->SetMobility(EComponentMobility::Static);
+    Actor->SetRootComponent(Root);
+    Actor->AddInstanceComponent(Root);
+    Root->RegisterComponent();
+
+    int32 NumInstances = 0;
+    for (int32 b : Placeable)
+    {
+        const FHL2PropBatch& Batch = Batches[b];
+        UStaticMesh* Mesh = Cast<UStaticMesh>(Batch.Mesh.ResolveObject());
+        UHierarchicalInstancedStaticMeshComponent* HISM = NewObject<UHierarchicalInstancedStaticMeshComponent>(
+            Actor, MakeUniqueObjectName(Actor, UHierarchicalInstancedStaticMeshComponent::StaticClass(), Mesh->GetFName()));
+        HISM->SetMobility(EComponentMobility::Static);
+        HISM->SetStaticMesh(Mesh);
+        HISM->InstanceStartCullDistance = FMath::RoundToInt(Batch.CullStart);
+        HISM->InstanceEndCullDistance = FMath::RoundToInt(Batch.CullEnd);
+        if (!Batch.bCollision)
+        {
+            HISM->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+        }
+        HISM->SetupAttachment(Root);
+        Actor->AddInstanceComponent(HISM);
+        // Fill before registering so the cluster tree is built once; the component sits at the origin
+        HISM->AddInstances(Batch.Instances, false);
+        HISM->RegisterComponent();
+        NumInstances += Batch.Instances.Num();
+    }
+
+    FAssetRegistryModule::AssetCreated(World);
+    World->MarkPackageDirty();
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Created static prop level %s: %d instances in %d HISM components (%d models without a mesh)"),
+        *World->GetName(), NumInstances, Placeable.Num(), Batches.Num() - Placeable.Num());
+    return World;
+}
@@ -0,0 +1,268 @@
+#include "HL2SyntheticBsp.h"
+#include "BspFile.h"
+#include "Math/RandomStream.h"
+
+// Synthetic VBSP v20 writer used by the benchmark commandlet.
+
+static constexpr int32 SyntheticCellSize = 128;
+static constexpr int32 SyntheticMaxVerts = 65535;
+static constexpr float SyntheticBrushDepth = 16.f;
+
+template <typename T>
+static void AppendLump(TArray<uint8>& Out, int32 LumpIndex, const TArray<T>& Data)
+{
+    Out.SetNumZeroed(Align(Out.Num(), 4));
+    const int32 Ofs = Out.Num();
+    const int32 Len = Data.Num() * (int32)sizeof(T);
+    Out.Append(reinterpret_cast<const uint8*>(Data.GetData()), Len);
+
+    FBspHeader& H = *reinterpret_cast<FBspHeader*>(Out.GetData());
+    H.Lumps[LumpIndex].Ofs = Ofs;
+    H.Lumps[LumpIndex].Len = Len;
+}
+
+// Node/leaf tree over the prisms of a grid of rings
+struct FSyntheticTree
+{
+    TArray<DPlane>& Planes;
+    const TArray<DBrush>& Brushes;
+    const TArray<DBrushSide>& BrushSides;
+    const TArray<int32>& RingBrush;   // per ring -> Brushes, INDEX_NONE without one
+    int32 GridWidth = 1;
+    TArray<DNode> Nodes;
+    TArray<DLeaf> Leafs;
+
+    // As a node child
+    int32 AddLeaf(int32 Contents)
+    {
+        DLeaf& Leaf = Leafs.AddZeroed_GetRef();
+        Leaf.Contents = Contents;
+        Leaf.Cluster = -1;
+        Leaf.LeafWaterDataID = -1;
+        return -1 - (Leafs.Num() - 1);
+    }
+
+    int32 AddNode(int32 PlaneNum)
+    {
+        Nodes.AddZeroed_GetRef().PlaneNum = PlaneNum;
+        return Nodes.Num() - 1;
+    }
+
+    // Cells [X0, X1) x [Y0, Y1) are halved by axial planes on cell borders until one is left. A cell with a prism
+    // then tests its brush planes in turn: each front side is an empty leaf, the back of the last the solid inside.
+    // Nodes are numbered before their children, as vbsp writes them.
+    int32 BuildCells(int32 X0, int32 Y0, int32 X1, int32 Y1)
+    {
+        if (X1 - X0 > 1 || Y1 - Y0 > 1)
+        {
+            const bool bSplitX = X1 - X0 >= Y1 - Y0;
+            const int32 Mid = bSplitX ? (X0 + X1) / 2 : (Y0 + Y1) / 2;
+            const int32 Node = AddNode(Planes.Num());
+            Planes.Add(DPlane{ { bSplitX ? 1.f : 0.f, bSplitX ? 0.f : 1.f, 0.f }, (Mid - 0.5f) * SyntheticCellSize, bSplitX ? 0 : 1 });
+            const int32 Front = bSplitX ? BuildCells(Mid, Y0, X1, Y1) : BuildCells(X0, Mid, X1, Y1);
+            Nodes[Node].Children[0] = Front;
+            const int32 Back = bSplitX ? BuildCells(X0, Y0, Mid, Y1) : BuildCells(X0, Y0, X1, Mid);
+            Nodes[Node].Children[1] = Back;
+            return Node;
+        }
+        const int32 Ring = Y0 * GridWidth + X0;
+        if (!RingBrush.IsValidIndex(Ring) || RingBrush[Ring] == INDEX_NONE)
+        {
+            return AddLeaf(0);
+        }
+        const DBrush& Brush = Brushes[RingBrush[Ring]];
+        const int32 First = Nodes.Num();
+        for (int32 s = 0; s < Brush.NumSides; ++s)
+        {
+            const int32 Node = AddNode(BrushSides[Brush.FirstSide + s].Planenum);
+            Nodes[Node].Children[0] = AddLeaf(0);
+            Nodes[Node].Children[1] = s + 1 < Brush.NumSides ? Node + 1 : AddLeaf(BspContents::Solid);
+        }
+        return First;
+    }
+};
+
+void GenerateSyntheticBsp(const FHL2SyntheticBspParams& Params, TArray<uint8>& OutBytes)
+{
+    const int32 NumFaces = FMath::Max(1, Params.NumFaces);
+    const int32 Sides = FMath::Clamp(Params.SidesPerFace, 3, 32);
+    const int32 NumDisps = FMath::Clamp(Params.NumDisplacements, 0, FMath::Min(NumFaces, (int32)MAX_int16));
+    const int32 DispPower = FMath::Clamp(Params.DispPower, 2, 4);
+    const int32 NumTextures = FMath::Clamp(Params.NumTextures, 1, (int32)MAX_int16);
+    FRandomStream Rng(Params.Seed);
+
+    // Vertex rings: displacement faces are quads, the rest regular polygons. Rings are shared once the
+    // uint16 vertex budget is spent.
+    const int32 NumDispRings = FMath::Min(NumDisps, SyntheticMaxVerts / 8);
+    const int32 NumPlainFaces = NumFaces - NumDisps;
+    const int32 NumFaceRings = NumPlainFaces > 0 ? FMath::Max(1, FMath::Min(NumPlainFaces, (SyntheticMaxVerts - NumDispRings * 4) / Sides)) : 0;
+    const int32 NumRings = NumDispRings + NumFaceRings;
+    const int32 GridWidth = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float)NumRings)));
+
+    TArray<DVertex> Verts;
+    TArray<DEdge> Edges;
+    TArray<int32> SurfEdges;
+    TArray<int32> RingFirstSurfEdge;
+    TArray<int32> RingNumSides;
+    TArray<int32> RingBrush;
+    TArray<DPlane> Planes;
+    TArray<DBrush> Brushes;
+    TArray<DBrushSide> BrushSides;
+    auto AddBrushSide = [&](float NX, float NY, float NZ, float Dist)
+    {
+        BrushSides.Add(DBrushSide{ (uint16)Planes.Num(), 0, -1, 0 });
+        Planes.Add(DPlane{ { NX, NY, NZ }, Dist, 0 });
+    };
+    Edges.Add(DEdge{ { 0, 0 } }); // edge 0 is unused by convention (its sign cannot be encoded)
+    for (int32 r = 0; r < NumRings; ++r)
+    {
+        const bool bDisp = r < NumDispRings;
+        const int32 N = bDisp ? 4 : Sides;
+        const float CX = (r % GridWidth) * (float)SyntheticCellSize;
+        const float CY = (r / GridWidth) * (float)SyntheticCellSize;
+        const float Z = Rng.FRandRange(0.f, 64.f);
+        const int32 FirstVert = Verts.Num();
+        for (int32 i = 0; i < N; ++i)
+        {
+            // Counter-clockwise seen from +Z, starting at the lower-left corner for quads
+            const float Angle = PI * 1.25f + 2.f * PI * i / N;
+            DVertex& V = Verts.AddDefaulted_GetRef();
+            V.Pos[0] = CX + FMath::Cos(Angle) * SyntheticCellSize * 0.375f * (bDisp ? UE_SQRT_2 : 1.f);
+            V.Pos[1] = CY + FMath::Sin(Angle) * SyntheticCellSize * 0.375f * (bDisp ? UE_SQRT_2 : 1.f);
+            V.Pos[2] = Z;
+        }
+        RingFirstSurfEdge.Add(SurfEdges.Num());
+        RingNumSides.Add(N);
+        for (int32 i = 0; i < N; ++i)
+        {
+            SurfEdges.Add(Edges.Num());
+            Edges.Add(DEdge{ { (uint16)(FirstVert + i), (uint16)(FirstVert + (i + 1) % N) } });
+        }
+
+        // Prism brush: the ring is its top face, walls face outward from each edge
+        RingBrush.Add(INDEX_NONE);
+        if (Planes.Num() + N + 2 > (int32)MAX_uint16) continue;
+        RingBrush[r] = Brushes.Num();
+        DBrush& Brush = Brushes.AddDefaulted_GetRef();
+        Brush.FirstSide = BrushSides.Num();
+        Brush.NumSides = N + 2;
+        Brush.Contents = BspContents::Solid;
+        AddBrushSide(0.f, 0.f, 1.f, Z);
+        AddBrushSide(0.f, 0.f, -1.f, -(Z - SyntheticBrushDepth));
+        for (int32 i = 0; i < N; ++i)
+        {
+            const DVertex& A = Verts[FirstVert + i];
+            const DVertex& B = Verts[FirstVert + (i + 1) % N];
+            const FVector2f Normal = FVector2f(B.Pos[1] - A.Pos[1], A.Pos[0] - B.Pos[0]).GetSafeNormal();
+            AddBrushSide(Normal.X, Normal.Y, 0.f, Normal.X * A.Pos[0] + Normal.Y * A.Pos[1]);
+        }
+    }
+
+    // Tree: leaf 0 is the conventional solid leaf outside the world
+    FSyntheticTree Tree{ Planes, Brushes, BrushSides, RingBrush, GridWidth };
+    Tree.AddLeaf(BspContents::Solid);
+    Tree.BuildCells(0, 0, GridWidth, (NumRings + GridWidth - 1) / GridWidth);
+
+    // Materials: one texinfo + texdata + name per texture
+    TArray<DTexInfo> TexInfos;
+    TArray<DTexData> TexDatas;
+    TArray<int32> StringTable;
+    TArray<ANSICHAR> StringData;
+    for (int32 t = 0; t < NumTextures; ++t)
+    {
+        DTexInfo& TI = TexInfos.AddZeroed_GetRef();
+        TI.TextureVecs[0][0] = 0.25f;
+        TI.TextureVecs[1][1] = -0.25f;
+        TI.TexData = t;
+        DTexData& TD = TexDatas.AddZeroed_GetRef();
+        TD.Reflectivity[0] = TD.Reflectivity[1] = TD.Reflectivity[2] = 0.5f;
+        TD.NameStringTableID = t;
+        TD.Width = TD.Height = TD.ViewWidth = TD.ViewHeight = 256;
+        StringTable.Add(StringData.Num());
+        const auto Name = StringCast<ANSICHAR>(*FString::Printf(TEXT("synthetic/tex_%04d"), t));
+        StringData.Append(Name.Get(), Name.Length() + 1);
+    }
+
+    TArray<DFace> Faces;
+    Faces.SetNumZeroed(NumFaces);
+    TArray<DDispInfo> DispInfos;
+    DispInfos.SetNumZeroed(NumDisps);
+    TArray<DDispVert> DispVerts;
+    const int32 DispSide = (1 << DispPower) + 1;
+    for (int32 f = 0; f < NumFaces; ++f)
+    {
+        const bool bDisp = f < NumDisps;
+        const int32 Ring = bDisp ? f % FMath::Max(1, NumDispRings) : NumDispRings + (f - NumDisps) % FMath::Max(1, NumFaceRings);
+        DFace& DF = Faces[f];
+        DF.FirstEdge = RingFirstSurfEdge[Ring];
+        DF.NumEdges = (int16)RingNumSides[Ring];
+        DF.TexInfo = (int16)Rng.RandHelper(NumTextures);
+        DF.DispInfo = bDisp ? (int16)f : -1;
+        DF.SurfaceFogVolumeID = -1;
+        DF.Styles[0] = 0; DF.Styles[1] = DF.Styles[2] = DF.Styles[3] = 255;
+        DF.Lightofs = -1;
+        DF.OrigFace = f;
+        if (!bDisp) continue;
+
+        DDispInfo& DI = DispInfos[f];
+        const DVertex& Start = Verts[Edges[SurfEdges[DF.FirstEdge]].V[0]];
+        DI.StartPosition[0] = Start.Pos[0]; DI.StartPosition[1] = Start.Pos[1]; DI.StartPosition[2] = Start.Pos[2];
+        DI.DispVertStart = DispVerts.Num();
+        DI.Power = DispPower;
+        DI.MapFace = (uint16)f;
+        for (DDispNeighbor& EN : DI.EdgeNeighbors) { EN.Sub[0].Neighbor = EN.Sub[1].Neighbor = 0xFFFF; }
+        for (DDispCornerNeighbors& CN : DI.CornerNeighbors) { FMemory::Memset(CN.Neighbors, 0xFF, sizeof(CN.Neighbors)); }
+
+        // Rolling hills: offsets along +Z
+        const float Phase = Rng.FRandRange(0.f, 2.f * PI);
+        for (int32 y = 0; y < DispSide; ++y)
+        {
+            for (int32 x = 0; x < DispSide; ++x)
+            {
+                DDispVert& DV = DispVerts.AddZeroed_GetRef();
+                DV.Vector[2] = 1.f;
+                DV.Dist = 16.f + 16.f * FMath::Sin(Phase + x * 0.7f) * FMath::Cos(y * 0.5f);
+            }
+        }
+    }
+
+    // Entities: worldspawn plus point entities spread over the grid
+    FString EntText = TEXT("{\n\"classname\" \"worldspawn\"\n\"mapversion\" \"1\"\n}\n");
+    const float Extent = GridWidth * (float)SyntheticCellSize;
+    for (int32 e = 1; e < Params.NumEntities; ++e)
+    {
+        EntText += FString::Printf(
+            TEXT("{\n\"origin\" \"%.2f %.2f %.2f\"\n\"angles\" \"0 %d 0\"\n\"targetname\" \"ent_%d\"\n\"classname\" \"%s\"\n\"model\" \"models/synthetic/prop_%02d.mdl\"\n}\n"),
+            Rng.FRandRange(0.f, Extent), Rng.FRandRange(0.f, Extent), Rng.FRandRange(0.f, 256.f), Rng.RandHelper(360), e,
+            (e % 3) ? TEXT("prop_static") : TEXT("info_target"), e % 16);
+    }
+    const auto EntAnsi = StringCast<ANSICHAR>(*EntText);
+    TArray<ANSICHAR> EntBytes;
+    EntBytes.Append(EntAnsi.Get(), EntAnsi.Length() + 1);
+
+    OutBytes.Reset();
+    OutBytes.SetNumZeroed(sizeof(FBspHeader));
+    FBspHeader& H = *reinterpret_cast<FBspHeader*>(OutBytes.GetData());
+    H.Ident = int32('V') | (int32('B') << 8) | (int32('S') << 16) | (int32('P') << 24);
+    H.Version = 20;
+    H.MapRevision = Params.Seed;
+
+    AppendLump(OutBytes, BspLump::Entities, EntBytes);
+    AppendLump(OutBytes, BspLump::Planes, Planes);
+    AppendLump(OutBytes, BspLump::Nodes, Tree.Nodes);
+    AppendLump(OutBytes, BspLump::Leafs, Tree.Leafs);
+    AppendLump(OutBytes, BspLump::TexData, TexDatas);
+    AppendLump(OutBytes, BspLump::Vertexes, Verts);
+    AppendLump(OutBytes, BspLump::TexInfo, TexInfos);
+    AppendLump(OutBytes, BspLump::Faces, Faces);
+    AppendLump(OutBytes, BspLump::Edges, Edges);
+    AppendLump(OutBytes, BspLump::SurfEdges, SurfEdges);
+    AppendLump(OutBytes, BspLump::Brushes, Brushes);
+    AppendLump(OutBytes, BspLump::BrushSides, BrushSides);
+    AppendLump(OutBytes, BspLump::DispInfo, DispInfos);
+    AppendLump(OutBytes, BspLump::DispVerts, DispVerts);
+    AppendLump(OutBytes, BspLump::TexDataStringTable, StringTable);
+    AppendLump(OutBytes, BspLump::TexDataStringData, StringData);
+    // AppendLump may have moved the buffer
+    reinterpret_cast<FBspHeader*>(OutBytes.GetData())->Lumps[BspLump::Leafs].Version = 1;
+}
@@ -0,0 +1,264 @@
+#include "HL2Visibility.h"
+#include "HL2BSPImporter.h"
+#include "BspFile.h"
+#include "HL2CoordTransform.h"
+#include "HL2ChunkManifest.h"
+#include "HL2VisibilityData.h"
+#include "Async/ParallelFor.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "HAL/PlatformTime.h"
+
+// Cluster/area tags of imported sections and the runtime visibility asset built from them.
+
+DECLARE_CYCLE_STAT(TEXT("Visibility Tags"), STAT_HL2_VisTags, STATGROUP_HL2BSPImporter);
+DECLARE_CYCLE_STAT(TEXT("Visibility Data"), STAT_HL2_VisData, STATGROUP_HL2BSPImporter);
+
+// Slack around face bounds for the leaf query, in Source units
+static constexpr float HL2VisBoxSlack = 1.f;
+
+void GatherSectionClusters(const FBspFile& Bsp, TConstArrayView<int32> FaceSection, int32 NumSections,
+                           TArray<TArray<int32>>& OutClusters, TArray<TArray<int32>>& OutAreas)
+{
+    HL2_STAGE_SCOPE(STAT_HL2_VisTags);
+    OutClusters.Reset();
+    OutClusters.SetNum(NumSections);
+    OutAreas.Reset();
+    OutAreas.SetNum(NumSections);
+    const FHL2BspTree& Tree = Bsp.GetTree();
+    if (!Tree.HasVisibility())
+    {
+        return;
+    }
+    const FBspGeometry& Geo = Bsp.GetGeometry();
+    TArray<TBitArray<>> Clusters;
+    TArray<TBitArray<>> Areas;
+    Clusters.SetNum(NumSections);
+    Areas.SetNum(NumSections);
+    for (int32 s = 0; s < NumSections; ++s)
+    {
+        Clusters[s].Init(false, Tree.NumClusters);
+        Areas[s].Init(false, FMath::Max(1, Tree.Areas.Num()));
+    }
+    auto AddLeaf = [&](int32 Section, const FHL2BspLeaf& Leaf)
+    {
+        if (Leaf.Cluster >= 0 && Leaf.Cluster < Tree.NumClusters) Clusters[Section][Leaf.Cluster] = true;
+        if (Tree.Areas.IsValidIndex(Leaf.Area)) Areas[Section][Leaf.Area] = true;
+    };
+
+    TBitArray<> Listed(false, Geo.NumFaces());
+    for (const FHL2BspLeaf& Leaf : Tree.Leafs)
+    {
+        for (int32 i = Leaf.FirstLeafFace; i < Leaf.FirstLeafFace + Leaf.NumLeafFaces; ++i)
+        {
+            const int32 Face = Tree.LeafFaces[i];
+            if (Face < FaceSection.Num() && FaceSection[Face] != INDEX_NONE)
+            {
+                Listed[Face] = true;
+                AddLeaf(FaceSection[Face], Leaf);
+            }
+        }
+    }
+
+    const TArray<FDispInfo>& DispInfos = Bsp.GetDispInfos();
+    const TArray<FDispVert>& DispVerts = Bsp.GetDispVerts();
+    TArray<int32> FaceDisp;
+    FaceDisp.Init(INDEX_NONE, Geo.NumFaces());
+    for (int32 d = 0; d < DispInfos.Num(); ++d)
+    {
+        if (DispInfos[d].MapFace >= 0 && DispInfos[d].MapFace < Geo.NumFaces()) FaceDisp[DispInfos[d].MapFace] = d;
+    }
+    TArray<int32> Leaves;
+    for (int32 f = 0; f < FMath::Min(FaceSection.Num(), Geo.NumFaces()); ++f)
+    {
+        const int32 NumCorners = Geo.FaceNumCorners[f];
+        if (FaceSection[f] == INDEX_NONE || Listed[f] || NumCorners < 3) continue;
+        FBox3f Box(ForceInit);
+        for (int32 c = 0; c < NumCorners; ++c)
+        {
+            Box += Geo.Positions[Geo.Indices[Geo.FaceFirstCorner[f] + c]];
+        }
+        // A displaced point is a point of the base face plus its offset, so the offsets' range widens the base bounds
+        if (FaceDisp[f] != INDEX_NONE)
+        {
+            const FDispInfo& Disp = DispInfos[FaceDisp[f]];
+            const int32 Side = (1 << Disp.Power) + 1;
+            if (Disp.VertStart >= 0 && Disp.VertStart + Side * Side <= DispVerts.Num())
+            {
+                FVector3f MinOffset(0.f), MaxOffset(0.f);
+                for (int32 v = Disp.VertStart; v < Disp.VertStart + Side * Side; ++v)
+                {
+                    const FDispVert& Vert = DispVerts[v];
+                    const FVector3f Offset = FVector3f(Vert.Vector[0], Vert.Vector[1], Vert.Vector[2]) * Vert.Dist;
+                    MinOffset = FVector3f::Min(MinOffset, Offset);
+                    MaxOffset = FVector3f::Max(MaxOffset, Offset);
+                }
+                Box.Min += MinOffset;
+                Box.Max += MaxOffset;
+            }
+        }
+        Leaves.Reset();
+        Tree.BoxLeaves(Box.ExpandBy(HL2VisBoxSlack), Leaves);
+        for (int32 Leaf : Leaves)
+        {
+            AddLeaf(FaceSection[f], Tree.Leafs[Leaf]);
+        }
+    }
+
+    for (int32 s = 0; s < NumSections; ++s)
+    {
+        for (TConstSetBitIterator<> It(Clusters[s]); It; ++It) OutClusters[s].Add(It.GetIndex());
+        for (TConstSetBitIterator<> It(Areas[s]); It; ++It) OutAreas[s].Add(It.GetIndex());
+    }
+}
+
+// func_areaportal start state by portal key; portals without an entity (or areaportal windows) start open
+static TMap<int32, bool> GetAreaPortalStartOpen(const FBspFile& Bsp)
+{
+    TMap<int32, bool> StartOpen;
+    const FHL2EntityKeyValues& KV = Bsp.GetEntityKeyValues();
+    for (int32 e = 0; e < KV.NumEntities(); ++e)
+    {
+        if (!KV.FindValue(e, "classname").Equals("func_areaportal", ESearchCase::IgnoreCase)) continue;
+        float Key = 0.f, Open = 1.f;
+        if (FHL2EntityKeyValues::ParseFloats(KV.FindValue(e, "portalnumber"), &Key, 1) != 1) continue;
+        FHL2EntityKeyValues::ParseFloats(KV.FindValue(e, "StartOpen"), &Open, 1);
+        StartOpen.Add((int32)Key, Open != 0.f);
+    }
+    return StartOpen;
+}
+
+UHL2VisibilityData* CreateVisibilityData(const FBspFile& Bsp, const FHL2CoordTransform& Xform, const UHL2ChunkManifest& Manifest,
+                                         UObject* Parent, FName Name, EObjectFlags Flags, FHL2VisibilityStats& OutStats)
+{
+    check(IsInGameThread());
+    HL2_STAGE_SCOPE(STAT_HL2_VisData);
+    const double Start = FPlatformTime::Seconds();
+    OutStats = FHL2VisibilityStats();
+    const FHL2BspTree& Tree = Bsp.GetTree();
+    if (!Tree.IsValid() || !Tree.HasVisibility() || Manifest.Chunks.Num() == 0)
+    {
+        UE_LOG(LogHL2BSPImporter, Warning, TEXT("No visibility data written: the map has no %s"),
+            Manifest.Chunks.Num() == 0 ? TEXT("chunks") : TEXT("PVS (compiled without vvis?)"));
+        return nullptr;
+    }
+
+    UHL2VisibilityData* Data = NewObject<UHL2VisibilityData>(Parent, Name, Flags);
+    Data->SourceFile = Manifest.SourceFile;
+    Data->NumClusters = Tree.NumClusters;
+    Data->NumAreas = Tree.Areas.Num();
+
+    // Planes into Unreal space. The transform is a uniform scale times a rotation/reflection, so the transformed
+    // normal keeps which side is front.
+    Data->Nodes.SetNum(Tree.Nodes.Num());
+    for (int32 n = 0; n < Tree.Nodes.Num(); ++n)
+    {
+        const FHL2BspNode& Src = Tree.Nodes[n];
+        const FVector3f Normal = Xform.TransformVector(Src.Normal).GetSafeNormal();
+        const FVector3f OnPlane = Xform.TransformPosition(Src.Normal * Src.Dist);
+        Data->Nodes[n].Plane = FVector4f(Normal, FVector3f::DotProduct(Normal, OnPlane));
+        Data->Nodes[n].Children[0] = Src.Children[0];
+        Data->Nodes[n].Children[1] = Src.Children[1];
+    }
+    Data->LeafClusters.SetNumUninitialized(Tree.Leafs.Num());
+    Data->LeafAreas.SetNumUninitialized(Tree.Leafs.Num());
+    for (int32 l = 0; l < Tree.Leafs.Num(); ++l)
+    {
+        Data->LeafClusters[l] = Tree.Leafs[l].Cluster;
+        Data->LeafAreas[l] = (uint8)FMath::Clamp<int32>(Tree.Leafs[l].Area, 0, 255);
+    }
+
+    // Each portal is listed by both its areas; keep it once
+    const TMap<int32, bool> StartOpen = GetAreaPortalStartOpen(Bsp);
+    for (int32 a = 0; a < Tree.Areas.Num(); ++a)
+    {
+        const FHL2BspArea& Area = Tree.Areas[a];
+        for (int32 p = Area.FirstAreaPortal; p < Area.FirstAreaPortal + Area.NumAreaPortals; ++p)
+        {
+            const FHL2BspAreaPortal& Portal = Tree.AreaPortals[p];
+            if (Portal.OtherArea <= a) continue;
+            FHL2VisAreaPortal& Out = Data->AreaPortals.AddDefaulted_GetRef();
+            Out.PortalKey = Portal.PortalKey;
+            Out.Areas[0] = a;
+            Out.Areas[1] = Portal.OtherArea;
+            const bool* bOpen = StartOpen.Find(Portal.PortalKey);
+            Out.bStartOpen = !bOpen || *bOpen;
+        }
+    }
+
+    const int32 NumSections = Manifest.Chunks.Num();
+    Data->SectionWords = (NumSections + 31) / 32;
+    Data->SectionMeshes.Reserve(NumSections);
+    TArray<TArray<int32>> ClusterSectionList;
+    ClusterSectionList.SetNum(Tree.NumClusters);
+    TArray<int32> Untagged;
+    for (int32 s = 0; s < NumSections; ++s)
+    {
+        const FHL2ChunkEntry& Entry = Manifest.Chunks[s];
+        Data->SectionMeshes.Add(Entry.Mesh);
+        for (int32 Cluster : Entry.Clusters)
+        {
+            if (ClusterSectionList.IsValidIndex(Cluster)) ClusterSectionList[Cluster].Add(s);
+        }
+        if (Entry.Clusters.Num() == 0) Untagged.Add(s);
+    }
+
+    // Row c = union of the sections of every cluster in c's PVS; rows are independent
+    const int32 Words = Data->SectionWords;
+    Data->ClusterSections.SetNumZeroed(Tree.NumClusters * Words);
+    TArray<int32> RowCounts;
+    RowCounts.SetNumZeroed(Tree.NumClusters);
+    ParallelFor(TEXT("HL2BSP.VisRows"), Tree.NumClusters, 64, [&](int32 c)
+    {
+        uint32* Row = Data->ClusterSections.GetData() + (int64)c * Words;
+        auto SetSection = [Row](int32 s) { Row[s >> 5] |= 1u << (s & 31); };
+        TBitArray<> Visible;
+        if (!Tree.GetClusterPVS(c, Visible))
+        {
+            for (int32 s = 0; s < NumSections; ++s) SetSection(s);
+        }
+        else
+        {
+            Visible[c] = true;
+            for (TConstSetBitIterator<> It(Visible); It; ++It)
+            {
+                for (int32 s : ClusterSectionList[It.GetIndex()]) SetSection(s);
+            }
+            for (int32 s : Untagged) SetSection(s);
+        }
+        for (int32 w = 0; w < Words; ++w) RowCounts[c] += FMath::CountBits(Row[w]);
+    });
+
+    // Area rows only matter if some portal can close
+    if (Data->AreaPortals.Num() > 0)
+    {
+        Data->AreaWords = (Data->NumAreas + 31) / 32;
+        Data->SectionAreas.SetNumZeroed(NumSections * Data->AreaWords);
+        for (int32 s = 0; s < NumSections; ++s)
+        {
+            uint32* Row = Data->SectionAreas.GetData() + s * Data->AreaWords;
+            const TArray<int32>& Areas = Manifest.Chunks[s].Areas;
+            for (int32 a = 0; a < Data->NumAreas; ++a)
+            {
+                if (Areas.Num() == 0 || Areas.Contains(a)) Row[a >> 5] |= 1u << (a & 31);
+            }
+        }
+    }
+
+    FAssetRegistryModule::AssetCreated(Data);
+    Data->MarkPackageDirty();
+
+    OutStats.Clusters = Data->NumClusters;
+    OutStats.Areas = Data->NumAreas;
+    OutStats.AreaPortals = Data->AreaPortals.Num();
+    OutStats.Sections = NumSections;
+    OutStats.UntaggedSections = Untagged.Num();
+    int64 VisibleSum = 0;
+    for (int32 Count : RowCounts) VisibleSum += Count;
+    OutStats.AvgVisibleSections = Tree.NumClusters > 0 ? (double)VisibleSum / Tree.NumClusters : 0.0;
+    OutStats.Bytes = Data->GetDataSize();
+    OutStats.Seconds = FPlatformTime::Seconds() - Start;
+    UE_LOG(LogHL2BSPImporter, Log, TEXT("Created visibility data %s: %d clusters, %d areas, %d area portals, %d sections (%d untagged), %.1f sections visible per cluster, %lld bytes (%.2fms)"),
+        *Data->GetName(), OutStats.Clusters, OutStats.Areas, OutStats.AreaPortals, OutStats.Sections, OutStats.UntaggedSections,
+        OutStats.AvgVisibleSections, OutStats.Bytes, OutStats.Seconds * 1000.0);
+    return Data;
+}
@@ -0,0 +1,84 @@
+#include "HL2EntityKeyValues.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Entity lump tokenizer and the allocation-free float parser used for origins, angles and colors.
+
+static TConstArrayView<uint8> LumpBytes(const ANSICHAR* Text)
+{
+    return TConstArrayView<uint8>(reinterpret_cast<const uint8*>(Text), FCStringAnsi::Strlen(Text));
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHL2ParseFloatsTest, "HL2BSPImporter.EntityKeyValues.ParseFloats",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHL2ParseFloatsTest::RunTest(const FString& Parameters)
+{
+    float V[4] = {};
+
+    TestEqual(TEXT("three ints"), FHL2EntityKeyValues::ParseFloats("1 -2 +3", V, 4), 3);
+    TestEqual(TEXT("negative"), V[1], -2.0f);
+    TestEqual(TEXT("explicit plus"), V[2], 3.0f);
+
+    TestEqual(TEXT("fractions"), FHL2EntityKeyValues::ParseFloats("  -0.5\t.25\r\n10.", V, 4), 3);
+    TestEqual(TEXT("-0.5"), V[0], -0.5f);
+    TestEqual(TEXT(".25"), V[1], 0.25f);
+    TestEqual(TEXT("10."), V[2], 10.0f);
+
+    TestEqual(TEXT("exponents"), FHL2EntityKeyValues::ParseFloats("1e3 2.5E-2 -4e+1", V, 4), 3);
+    TestEqual(TEXT("1e3"), V[0], 1000.0f);
+    TestEqual(TEXT("2.5E-2"), V[1], 0.025f);
+    TestEqual(TEXT("-4e+1"), V[2], -40.0f);
+
+    TestEqual(TEXT("leading zeros"), FHL2EntityKeyValues::ParseFloats("007 0.0001 000.5", V, 4), 3);
+    TestEqual(TEXT("007"), V[0], 7.0f);
+    TestEqual(TEXT("0.0001"), V[1], 0.0001f);
+    TestEqual(TEXT("000.5"), V[2], 0.5f);
+
+    // Digits past the 18th only scale the integer part; the fraction keeps its 18 significant digits
+    TestEqual(TEXT("long mantissa"), FHL2EntityKeyValues::ParseFloats("12345678901234567890 0.1234567890123456789012", V, 4), 2);
+    TestEqual(TEXT("20-digit integer"), V[0], 12345678901234567890.0f);
+    TestEqual(TEXT("24-digit fraction"), V[1], 0.12345678901234567f);
+
+    // A token that does not end at whitespace stops parsing and is not stored
+    V[1] = 99.0f;
+    TestEqual(TEXT("trailing garbage"), FHL2EntityKeyValues::ParseFloats("1 2x 3", V, 4), 1);
+    TestEqual(TEXT("garbage token not written"), V[1], 99.0f);
+    TestEqual(TEXT("bare sign"), FHL2EntityKeyValues::ParseFloats("- 1", V, 4), 0);
+    TestEqual(TEXT("dangling exponent"), FHL2EntityKeyValues::ParseFloats("5e", V, 4), 0);
+
+    TestEqual(TEXT("Count caps the read"), FHL2EntityKeyValues::ParseFloats("1 2 3 4 5", V, 2), 2);
+    TestEqual(TEXT("empty value"), FHL2EntityKeyValues::ParseFloats("", V, 4), 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHL2EntityKeyValuesParseTest, "HL2BSPImporter.EntityKeyValues.Parse",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHL2EntityKeyValuesParseTest::RunTest(const FString& Parameters)
+{
+    FHL2EntityKeyValues KV;
+    KV.Parse(LumpBytes(
+        "{\n\"classname\" \"worldspawn\"\n}\n"
+        "{\n}\n"
+        "{\n\"classname\" \"logic_relay\"\n\"OnTrigger\" \"a,Open,,0,-1\"\n\"OnTrigger\" \"b,Close,,1,-1\"\n}\n"
+        "{}"));
+
+    // Empty blocks are dropped, so entity indices cover the populated entities only
+    TestEqual(TEXT("entities"), KV.NumEntities(), 2);
+    TestTrue(TEXT("worldspawn"), KV.FindValue(0, "classname") == "worldspawn");
+
+    // Duplicate keys are all retained in file order; FindValue returns the first
+    TestEqual(TEXT("relay pairs"), KV.NumPairs(1), 3);
+    TestTrue(TEXT("first output"), KV.GetValue(1, 1) == "a,Open,,0,-1");
+    TestTrue(TEXT("second output"), KV.GetValue(1, 2) == "b,Close,,1,-1");
+    TestTrue(TEXT("FindValue first duplicate"), KV.FindValue(1, "ontrigger") == "a,Open,,0,-1");
+    TestFalse(TEXT("missing key"), KV.HasKey(1, "origin"));
+
+    KV.Parse(LumpBytes("{ }\n{}"));
+    TestEqual(TEXT("only empty blocks"), KV.NumEntities(), 0);
+    return true;
+}
+
+#endif
@@ -1,49 +1,348 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
 #include "HL2BSPImporterTypes.h"
+#include "HL2EntityKeyValues.h"
+#include "HL2BspTree.h"
 
-// Minimal placeholder BSP structures to allow compilation.
+// On-disk VBSP v20 structures (packed, little-endian). Lump views alias these directly.
 
-struct FBspVertex
+#pragma pack(push, 1)
+struct FLumpInfo { int32 Ofs; int32 Len; int32 Version; int32 FourCC; };
+struct FBspHeader { int32 Ident; int32 Version; FLumpInfo Lumps[64]; int32 MapRevision; };
+struct DVertex { float Pos[3]; };
+struct DEdge { uint16 V[2]; };
+struct DFace
 {
-    FVector Position = FVector::ZeroVector;
-    FVector2D UV = FVector2D::ZeroVector;
+    uint16 Planenum; uint8 Side; uint8 OnNode; int32 FirstEdge; int16 NumEdges; int16 TexInfo; int16 DispInfo; int16 SurfaceFogVolumeID;
+    uint8 Styles[4]; int32 Lightofs; float Area; int32 LmMins[2]; int32 LmSize[2]; int32 OrigFace; uint16 NumPrims; uint16 FirstPrimID; uint32 SmoothingGroups;
+};
+struct DTexInfo { float TextureVecs[2][4]; float LightmapVecs[2][4]; int32 Flags; int32 TexData; };
+struct DTexData { float Reflectivity[3]; int32 NameStringTableID; int32 Width; int32 Height; int32 ViewWidth; int32 ViewHeight; };
+struct DDispSubNeighbor { uint16 Neighbor; uint8 NeighborOrientation; uint8 Span; uint8 NeighborSpan; uint8 Pad; };
+struct DDispNeighbor { DDispSubNeighbor Sub[2]; };
+struct DDispCornerNeighbors { uint16 Neighbors[4]; uint8 NumNeighbors; uint8 Pad; };
+struct DDispInfo
+{
+    float StartPosition[3]; int32 DispVertStart; int32 DispTriStart; int32 Power; int32 MinTess; float SmoothingAngle; int32 Contents;
+    uint16 MapFace; uint16 Pad; int32 LightmapAlphaStart; int32 LightmapSamplePositionStart;
+    DDispNeighbor EdgeNeighbors[4]; DDispCornerNeighbors CornerNeighbors[4]; uint32 AllowedVerts[10];
+};
+struct DDispVert { float Vector[3]; float Dist; float Alpha; };
+struct DPlane { float Normal[3]; float Dist; int32 Type; };
+struct DBrush { int32 FirstSide; int32 NumSides; int32 Contents; };
+struct DBrushSide { uint16 Planenum; int16 TexInfo; int16 DispInfo; int16 Bevel; };
+struct DColorRGBExp32 { uint8 R; uint8 G; uint8 B; int8 Exponent; };
+struct DModel { float Mins[3]; float Maxs[3]; float Origin[3]; int32 HeadNode; int32 FirstFace; int32 NumFaces; };
+struct DNode { int32 PlaneNum; int32 Children[2]; int16 Mins[3]; int16 Maxs[3]; uint16 FirstFace; uint16 NumFaces; int16 Area; int16 Pad; };
+// dleaf_t version 1; version 0 appends a 24-byte ambient light cube after LeafWaterDataID (56 bytes per leaf)
+struct DLeaf
+{
+    int32 Contents; int16 Cluster; int16 AreaFlags; int16 Mins[3]; int16 Maxs[3];
+    uint16 FirstLeafFace; uint16 NumLeafFaces; uint16 FirstLeafBrush; uint16 NumLeafBrushes; int16 LeafWaterDataID; int16 Pad;
+};
+struct DArea { int32 NumAreaPortals; int32 FirstAreaPortal; };
+struct DAreaPortal { uint16 PortalKey; uint16 OtherArea; uint16 FirstClipPortalVert; uint16 NumClipPortalVerts; int32 PlaneNum; };
+struct DGameLump { int32 Id; uint16 Flags; uint16 Version; int32 FileOfs; int32 FileLen; };
+// StaticPropLump_t fields shared by sprp v4..v7; later versions append fields (v5 ForcedFadeScale, v6 DX levels, v7 color)
+struct DStaticPropV4
+{
+    float Origin[3]; float Angles[3]; uint16 PropType; uint16 FirstLeaf; uint16 LeafCount; uint8 Solid; uint8 Flags;
+    int32 Skin; float FadeMinDist; float FadeMaxDist; float LightingOrigin[3];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FBspHeader) == 1036, "VBSP header layout");
+static_assert(sizeof(DFace) == 56, "dface_t layout");
+static_assert(sizeof(DTexInfo) == 72, "texinfo_t layout");
+static_assert(sizeof(DTexData) == 32, "dtexdata_t layout");
+static_assert(sizeof(DDispInfo) == 176, "ddispinfo_t layout");
+static_assert(sizeof(DDispVert) == 20, "CDispVert layout");
+static_assert(sizeof(DPlane) == 20, "dplane_t layout");
+static_assert(sizeof(DBrush) == 12, "dbrush_t layout");
+static_assert(sizeof(DBrushSide) == 8, "dbrushside_t layout");
+static_assert(sizeof(DColorRGBExp32) == 4, "ColorRGBExp32 layout");
+static_assert(sizeof(DModel) == 48, "dmodel_t layout");
+static_assert(sizeof(DNode) == 32, "dnode_t layout");
+static_assert(sizeof(DLeaf) == 32, "dleaf_t v1 layout");
+static_assert(sizeof(DArea) == 8, "darea_t layout");
+static_assert(sizeof(DAreaPortal) == 12, "dareaportal_t layout");
+static_assert(sizeof(DGameLump) == 16, "dgamelump_t layout");
+static_assert(sizeof(DStaticPropV4) == 56, "StaticPropLump_t v4 layout");
+
+// Lump indices used by the reader.
+namespace BspLump
+{
+    enum : int32
+    {
+        Entities = 0,
+        Planes = 1,
+        TexData = 2,
+        Vertexes = 3,
+        Visibility = 4,
+        Nodes = 5,
+        TexInfo = 6,
+        Faces = 7,
+        Lighting = 8,
+        Leafs = 10,
+        Edges = 12,
+        SurfEdges = 13,
+        Models = 14,
+        LeafFaces = 16,
+        LeafBrushes = 17,
+        Brushes = 18,
+        BrushSides = 19,
+        Areas = 20,
+        AreaPortals = 21,
+        DispInfo = 26,
+        DispVerts = 33,
+        GameLump = 35,
+        TexDataStringData = 43,
+        TexDataStringTable = 44,
+        LightingHDR = 53,
+        FacesHDR = 58,
+    };
+}
+
+// texinfo_t::Flags bits the face filter understands (SURF_* in Source's bspflags.h)
+namespace BspSurf
+{
+    enum : int32
+    {
+        Sky2D = 0x0002,
+        Sky = 0x0004,
+        Trigger = 0x0040,
+        NoDraw = 0x0080,
+        Hint = 0x0100,
+        Skip = 0x0200,
+        NoLight = 0x0400,
+    };
+}
+
+// dbrush_t::Contents bits used for collision (CONTENTS_* in Source's bspflags.h)
+namespace BspContents
+{
+    enum : int32
+    {
+        Solid = 0x00000001,
+        Window = 0x00000002,
+        Grate = 0x00000008,
+        PlayerClip = 0x00010000,
+        MonsterClip = 0x00020000,
+    };
+}
+
+// Per-face bits in FBspGeometry::FaceFlags
+namespace BspFaceFlags
+{
+    enum : uint8
+    {
+        Sky = 0x01,      // kept by the filter for a separate sky mesh; not part of the world mesh
+        Culled = 0x02,   // dropped by the filter (zero corners)
+        Displacement = 0x04,   // base face of a displacement (DFace::DispInfo >= 0)
+    };
+}
+
+// Why a face was dropped; the first matching reason in this order wins
+enum class EBspCullReason : uint8
+{
+    None,
+    NoDraw,
+    Sky,
+    Skip,
+    Hint,
+    Trigger,
+    ToolTexture,
+    Unreachable,   // no leaf of a cluster reachable from a player start references it (FBspFaceFilter::bCullUnreachable)
+    Num
+};
+
+// Which faces Parse assembles. The default keeps everything.
+struct FBspFaceFilter
+{
+    int32 CullSurfaceFlags = 0;            // BspSurf bits; a face whose texinfo has any of them is dropped
+    bool bKeepSky = false;                 // sky faces selected by CullSurfaceFlags are kept and tagged BspFaceFlags::Sky
+    TArray<FString> CullTexturePrefixes;   // lower case with forward slashes, e.g. "tools/toolsclip"
+    bool bCullUnreachable = false;         // PVS pass after assembly, see FBspFile::Parse
+};
+
+// Faces removed from the world mesh by the filter, per reason
+struct FBspCullStats
+{
+    int32 Faces[(int32)EBspCullReason::Num] = {};
+    int32 SkyFacesKept = 0;
+
+    int32 Total() const
+    {
+        int32 Sum = 0;
+        for (int32 Count : Faces) Sum += Count;
+        return Sum;
+    }
+};
+
+// Outcome of the PVS pass (FBspFaceFilter::bCullUnreachable)
+struct FBspVisStats
+{
+    bool bApplied = false;           // false if the pass was off, or the map lacks a tree, visibility or start entities
+    int32 Clusters = 0;
+    int32 StartClusters = 0;         // distinct clusters holding a player start, landmark or sky camera
+    int32 ReachableClusters = 0;     // closure of the start clusters over the PVS
+    int32 FacesRemoved = 0;
+    int32 TrianglesRemoved = 0;      // fan triangles of the removed faces
+    int64 BytesSaved = 0;            // estimated builder stream and MeshDescription bytes of those corners and triangles
+    double Ms = 0.0;
+};
+
+// Compact structure-of-arrays geometry produced by the reader. Face arrays are indexed by LUMP_FACES index;
+// faces that could not be assembled keep an entry with zero corners so source indices stay stable.
+struct FBspGeometry
+{
+    TArray<FVector3f> Positions;      // LUMP_VERTEXES, Source space
+    TArray<int32> Indices;            // per face corner -> Positions
+    TArray<FVector2f> UVs;            // per face corner, normalized by texture size
+    TArray<FVector2f> LightmapUVs;    // per face corner, texinfo lightmap projection in luxels (LmMins not subtracted)
+    TArray<uint32> FaceFirstCorner;   // per face -> Indices/UVs
+    TArray<uint16> FaceNumCorners;
+    TArray<uint16> FaceTexture;       // per face -> TextureNames
+    TArray<uint8> FaceFlags;          // per face, BspFaceFlags
+    TArray<int32> FaceTexInfo;        // per face, LUMP_TEXINFO index (-1 if none)
+    TArray<int32> FacePlane;          // per face, Planenum * 2 + Side
+    TArray<uint32> FaceSmoothingGroups;   // per face, Hammer smoothing group bits (0 = flat)
+    TArray<uint16> FaceModel;         // per face, LUMP_MODELS index (0 = world, also for faces outside every model)
+    TArray<FIntPoint> FaceLightmapMins;   // per face, first luxel of its lightmap (LmMins)
+    TArray<FIntPoint> FaceLightmapSize;   // per face, lightmap samples (LmSize + 1); zero if the face is unlit
+    TArray<int32> FaceLightOfs;           // per face, byte offset of its first style in the lighting lump, -1 if unlit
+    TArray<FString> TextureNames;     // unique Source texture names; empty name = no texture
+
+    int32 NumFaces() const { return FaceFirstCorner.Num(); }
+    int32 NumCorners() const { return Indices.Num(); }
+
+    void Reset()
+    {
+        Positions.Reset(); Indices.Reset(); UVs.Reset(); LightmapUVs.Reset();
+        FaceFirstCorner.Reset(); FaceNumCorners.Reset(); FaceTexture.Reset(); FaceFlags.Reset();
+        FaceTexInfo.Reset(); FacePlane.Reset(); FaceSmoothingGroups.Reset(); FaceModel.Reset(); FaceLightmapMins.Reset(); FaceLightmapSize.Reset(); FaceLightOfs.Reset(); TextureNames.Reset();
+    }
 };
 
-struct FBspFace
+// One LUMP_MODELS entry: model 0 is the world, the others are brush entity models ("*N"), stored relative to
+// their entity's origin
+struct FBspModel
 {
-    uint32 FirstVertex = 0;
-    uint32 NumVertices = 0;
-    FString TextureName; // Source texture name for material lookup
+    FVector3f Mins = FVector3f::ZeroVector;
+    FVector3f Maxs = FVector3f::ZeroVector;
+    int32 HeadNode = 0;         // root of the model's own node tree (LUMP_NODES)
+    int32 FirstFace = 0;
+    int32 NumFaces = 0;
+};
+
+// One sprp entry in Source space. Angles are QAngle degrees (pitch, yaw, roll).
+struct FBspStaticProp
+{
+    FVector3f Origin = FVector3f::ZeroVector;
+    FVector3f Angles = FVector3f::ZeroVector;
+    int32 Model = 0;            // -> FBspFile::GetStaticPropModels()
+    int32 Skin = 0;
+    float FadeMinDist = 0.f;    // fading disabled if FadeMaxDist <= 0
+    float FadeMaxDist = 0.f;
+    uint8 Solid = 0;            // SOLID_NONE (0) props have no collision
+    uint8 Flags = 0;
 };
 
 struct FDispInfo
 {
+    static constexpr int32 MaxNeighbors = 24;   // 4 edges x 2 sub-neighbours + 4 corners x 4
+
     int32 Power = 0;
     int32 VertStart = 0;
     int32 MapFace = -1;
+    FVector3f StartPosition = FVector3f::ZeroVector;   // Source space; the base corner nearest to it is grid corner 0
+    uint16 Neighbors[MaxNeighbors] = {};              // distinct edge and corner neighbours, LUMP_DISPINFO indices
+    int32 NumNeighbors = 0;
 };
 
 struct FDispVert
 {
-    float Vector[3] = {0.f, 0.f, 0.f};
+    float Vector[3] = {0.f, 0.f, 0.f};   // unit direction of the offset
+    float Dist = 0.f;                    // offset length
+    float Alpha = 0.f;                   // texture blend, 0..255
+};
+
+// Timing of the last FBspFile::Parse: wall time of the decode graph and CPU time summed per task kind
+struct FBspDecodeStats
+{
+    double WallMs = 0.0;
+    TArray<TPair<const TCHAR*, double>> TaskCpuMs;
 };
 
 class FBspFile
 {
 public:
-    bool LoadFromFile(const FString& Filename);
+    // Maps the file read-only (falls back to a single buffered read where mapping is unavailable) and validates the header.
+    bool Open(const FString& Filename);
+    // Decodes geometry, displacements, entities and the BSP tree from the lump views of an opened file. Faces
+    // rejected by Filter keep zero corners and are tagged BspFaceFlags::Culled. With bCullUnreachable, world brush
+    // faces that no leaf of a reachable cluster references are removed the same way once everything is decoded.
+    bool Parse(const FBspFaceFilter& Filter = FBspFaceFilter());
+    bool LoadFromFile(const FString& Filename) { return Open(Filename) && Parse(); }
+    void Close();
+
+    bool IsOpen() const { return RawData.Num() > 0; }
+    bool IsMapped() const { return MappedRegion.IsValid(); }
+    TConstArrayView<uint8> GetRawData() const { return RawData; }
+    const FBspHeader* GetHeader() const { return RawData.Num() >= (int32)sizeof(FBspHeader) ? (const FBspHeader*)RawData.GetData() : nullptr; }
+
+    // Bounds- and alignment-checked typed view of a lump. An absent lump yields an empty view; a lump that
+    // does not fit the file returns false.
+    template <typename T>
+    bool GetLumpView(int32 LumpIndex, TConstArrayView<T>& OutView) const
+    {
+        TConstArrayView<uint8> Bytes;
+        if (!GetLumpBytes(LumpIndex, sizeof(T), alignof(T), Bytes))
+        {
+            OutView = TConstArrayView<T>();
+            return false;
+        }
+        OutView = TConstArrayView<T>(reinterpret_cast<const T*>(Bytes.GetData()), Bytes.Num() / (int32)sizeof(T));
+        return true;
+    }
 
-    const TArray<FBspVertex>& GetVertices() const { return Vertices; }
-    const TArray<FBspFace>& GetFaces() const { return Faces; }
+    const FBspGeometry& GetGeometry() const { return Geometry; }
+    const TArray<FBspModel>& GetModels() const { return Models; }
     const TArray<FDispInfo>& GetDispInfos() const { return DispInfos; }
     const TArray<FDispVert>& GetDispVerts() const { return DispVerts; }
+    // Every key/value pair of every entity; GetEntities() holds the subset promoted to DataTable rows
+    const FHL2EntityKeyValues& GetEntityKeyValues() const { return EntityKeyValues; }
+    const FBspDecodeStats& GetDecodeStats() const { return DecodeStats; }
+    const FBspCullStats& GetCullStats() const { return CullStats; }
+    const FBspVisStats& GetVisStats() const { return VisStats; }
+    const FHL2BspTree& GetTree() const { return Tree; }
     const TArray<FHL2Entity>& GetEntities() const { return Entities; }
+    // sprp game lump: model dictionary (e.g. "models/props_c17/oildrum001.mdl") and placements
+    const TArray<FString>& GetStaticPropModels() const { return StaticPropModels; }
+    const TArray<FBspStaticProp>& GetStaticProps() const { return StaticProps; }
 
 private:
-    TArray<FBspVertex> Vertices;
-    TArray<FBspFace> Faces;
+    bool GetLumpBytes(int32 LumpIndex, int32 ElementSize, int32 ElementAlign, TConstArrayView<uint8>& OutBytes) const;
+    void ParseStaticProps();
+    void CullUnreachableFaces();
+
+    FString SourceFilename;
+    TUniquePtr<IMappedFileHandle> MappedHandle;
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+    TArray<uint8> FallbackBytes;
+    TConstArrayView<uint8> RawData;
+
+    FBspGeometry Geometry;
+    TArray<FBspModel> Models;
     TArray<FDispInfo> DispInfos;
     TArray<FDispVert> DispVerts;
+    FHL2EntityKeyValues EntityKeyValues;
     TArray<FHL2Entity> Entities;
+    TArray<FString> StaticPropModels;
+    TArray<FBspStaticProp> StaticProps;
+    FBspDecodeStats DecodeStats;
+    FBspCullStats CullStats;
+    FHL2BspTree Tree;
+    FBspVisStats VisStats;
 };
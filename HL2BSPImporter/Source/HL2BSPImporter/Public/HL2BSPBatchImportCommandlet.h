@@ -0,0 +1,17 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HL2BSPBatchImportCommandlet.generated.h"
+
+// Headless import of many maps in one process:
+//   UnrealEditor-Cmd <Project> -run=HL2BSPBatchImport -input=<dir or .bsp> [-output=/Game/Maps] [-jobs=N] [-recursive]
+// Parsing and MeshDescription construction run as worker tasks (at most -jobs maps in flight); asset creation
+// and saving stay on the game thread, in input order. Returns non-zero if any map failed.
+UCLASS()
+class HL2BSPIMPORTER_API UHL2BSPBatchImportCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+public:
+    UHL2BSPBatchImportCommandlet();
+    virtual int32 Main(const FString& Params) override;
+};
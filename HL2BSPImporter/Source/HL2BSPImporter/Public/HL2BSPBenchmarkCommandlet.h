@@ -0,0 +1,24 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HL2BSPBenchmarkCommandlet.generated.h"
+
+// Reproducible stage-by-stage import benchmark on generated maps:
+//   UnrealEditor-Cmd <Project> -run=HL2BSPBenchmark [-faces=1000,10000] [-sides=4] [-disps=0] [-power=3]
+//       [-entities=1000] [-textures=64] [-iterations=5] [-warmup=1] [-skipmeshbuild] [-collision [-traces=10000]] [-tree [-queries=10000]]
+//       [-json=<file>]
+// Every numeric option takes a comma-separated list; all combinations are run. Each configuration is written
+// as a synthetic VBSP v20 file, then timed per stage: load (LoadFromFile), build_mesh_description, its
+// normals_tangents share, and build_from_mesh_descriptions (unless -skipmeshbuild). -collision also times brush
+// hull generation, cooking of the complex-as-simple trimesh and of the hulls, and the same random line traces
+// against each. -tree times the map's node/leaf tree (point-in-leaf and ray queries, serial and batched) against
+// complex-as-simple traces of the mesh. Results (min/median/mean/max ms per stage) go to JSON, by default
+// Saved/HL2BSPBenchmark/results.json.
+UCLASS()
+class HL2BSPIMPORTER_API UHL2BSPBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+public:
+    UHL2BSPBenchmarkCommandlet();
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,144 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "MeshDescription.h"
+#include "BspFile.h"
+#include "HL2BSPMeshBuilder.h"
+#include "HL2BrushCollision.h"
+#include "HL2StaticProps.h"
+#include "HL2BrushModels.h"
+#include "HL2LightmapAtlas.h"
+#include "HL2Visibility.h"
+#include "HL2MaterialSlots.h"
+
+class UHL2BSPImporterSettings;
+class UHL2EntityTable;
+class UStaticMesh;
+class UWorld;
+class UHL2ChunkManifest;
+class UTexture2D;
+class UHL2VisibilityData;
+class FHL2MaterialResolver;
+
+// Wall time of each import stage, in seconds
+struct FHL2ImportTimings
+{
+    double Parse = 0.0;
+    double Build = 0.0;
+    double Normals = 0.0;       // normal/tangent pass inside Build (summed over chunks)
+    double Collision = 0.0;
+    double MeshBuild = 0.0;
+    double Save = 0.0;
+};
+
+// Process physical memory in use right after each stage, in bytes
+struct FHL2ImportMemory
+{
+    uint64 AfterParse = 0;
+    uint64 AfterBuild = 0;
+    uint64 AfterNormals = 0;
+    uint64 AfterMeshBuild = 0;
+};
+
+// One grid cell of a chunked world, built like the single world mesh but from the faces in the cell only
+struct FHL2MeshChunk
+{
+    FIntPoint Cell = FIntPoint::ZeroValue;
+    FMeshDescription MeshDescription;
+    TArray<FName> SlotNames;
+    FHL2MeshBuildStats BuildStats;
+    FBox Bounds = FBox(ForceInit);
+    TArray<FHL2BrushHull> CollisionHulls;
+    FHL2LightmapAtlas Lightmap;
+    TArray<FMeshDescription> LODs;   // LOD 1.. with coarser displacements (DisplacementLODScreenSizes); empty with Nanite
+    TArray<int32> Clusters;          // BSP clusters and areas of the chunk's faces (bImportVisibility)
+    TArray<int32> Areas;
+};
+
+// One map on its way through the import: the parsed file and the finished MeshDescription. Parse and build
+// only touch this struct, so several maps can be prepared on worker threads at once.
+struct HL2BSPIMPORTER_API FHL2PreparedMap
+{
+    FString Filename;
+    FBspFile Bsp;
+    FMeshDescription MeshDescription;
+    TArray<FName> SlotNames;
+    // LOD 1.. of the world mesh without Nanite: the same faces with displacements one power lower per LOD
+    TArray<FMeshDescription> LODMeshDescriptions;
+    // Grid chunks instead of MeshDescription when the world is chunked; SlotNames and BuildStats then hold the totals
+    TArray<FHL2MeshChunk> Chunks;
+    // Sky faces, when the face filter keeps them for a separate mesh; empty otherwise
+    FMeshDescription SkyMeshDescription;
+    TArray<FName> SkySlotNames;
+    FHL2MeshBuildStats BuildStats;
+    // Lightmap charts of the world mesh (bImportLightmapUVs), texels included with bImportBakedLighting
+    FHL2LightmapAtlas Lightmap;
+    // Convex brush collision, when the settings ask for brush hulls; empty otherwise (chunks carry their own)
+    TArray<FHL2BrushHull> CollisionHulls;
+    FHL2BrushCollisionStats CollisionStats;
+    // Brush entity models, one group per distinct geometry, and the entities placing them (bSplitBrushEntities)
+    TArray<FHL2BrushModelGroup> BrushModels;
+    TArray<FHL2BrushEntityPlacement> BrushEntities;
+    FHL2BrushModelStats BrushModelStats;
+    // Static props grouped by model, when props are imported as instances
+    TArray<FHL2PropBatch> PropBatches;
+    // Runtime visibility asset of a chunked world (bImportVisibility)
+    FHL2VisibilityStats VisibilityStats;
+    // Material slots merged while the meshes were created (bCompactMaterialSlots)
+    FHL2SlotCompactionStats SlotCompaction;
+    FHL2ImportTimings Timings;
+    FHL2ImportMemory Memory;
+};
+
+// Face filter for the reader from the culling settings
+FBspFaceFilter MakeBSPFaceFilter(const UHL2BSPImporterSettings* Sets);
+
+// Any thread. Opens (memory-maps) and parses the BSP with the settings' face filter; false on any file/format error (logged).
+bool ParseBSPMap(const FString& Filename, const UHL2BSPImporterSettings* Sets, FHL2PreparedMap& Map);
+
+// Brush contents groups (bits of 1 << EHL2CollisionGroup) the collision settings include
+uint32 MakeCollisionGroupMask(const UHL2BSPImporterSettings* Sets);
+
+// Any thread. Builds the MeshDescription; the builder sets normals/tangents and counts bad triangles as it goes.
+// With bSplitBrushEntities the world takes model 0's faces and brushes only and each distinct brush entity model gets
+// its own MeshDescription and hulls. Without Nanite the world (or each chunk) also gets displacement LODs per
+// DisplacementLODScreenSizes. Also builds SkyMeshDescription if the reader kept sky faces, the brush hulls in
+// BrushHulls collision mode and the static prop batches.
+void BuildBSPMapGeometry(FHL2PreparedMap& Map, const UHL2BSPImporterSettings* Sets);
+
+// Game thread. Creates the UStaticMesh in Parent, assigns materials per slot (merging slots with the same material
+// when bCompactMaterialSlots; this and the other Create* functions then change the MeshDescriptions in Map), applies Nanite/collision settings
+// (brush hulls as simple collision when built, complex-as-simple otherwise) and builds render data, with the
+// displacement LODs and their screen sizes when there are any. Returns null if the object could not be created.
+UStaticMesh* CreateStaticMeshFromBSPMap(FHL2PreparedMap& Map, UObject* Parent, FName Name, EObjectFlags Flags, UClass* MeshClass,
+                                        FHL2MaterialResolver& Materials, const UHL2BSPImporterSettings* Sets);
+
+// Game thread. Chunked world: one static mesh per chunk in package <ManifestPackage>_Chunk_<X>_<Y>, and a manifest
+// of their cells and bounds named Name in Parent. The meshes are appended to OutMeshes when given.
+UHL2ChunkManifest* CreateChunkedMeshesFromBSPMap(FHL2PreparedMap& Map, UObject* Parent, FName Name, EObjectFlags Flags,
+                                                FHL2MaterialResolver& Materials, const UHL2BSPImporterSettings* Sets,
+                                                TArray<UStaticMesh*>* OutMeshes = nullptr);
+
+// Game thread. With bImportVisibility, the cluster visibility of Manifest's chunks in package PackageName; null if the
+// world is not chunked or the map has no PVS.
+UHL2VisibilityData* CreateVisibilityDataFromBSPMap(FHL2PreparedMap& Map, const UHL2ChunkManifest* Manifest, const UHL2BSPImporterSettings* Sets,
+                                                   const FString& PackageName);
+
+// Game thread. Static mesh of the kept sky faces (no collision); null if the map has none.
+UStaticMesh* CreateSkyMeshFromBSPMap(FHL2PreparedMap& Map, UObject* Parent, FName Name, EObjectFlags Flags,
+                                     FHL2MaterialResolver& Materials, const UHL2BSPImporterSettings* Sets);
+
+// Game thread. One static mesh per brush model group in package <BasePackageName>_Model_<N> (N = first model of the
+// group) and a <BasePackageName>_Brushes level placing them per entity; null if no brush entity was placed. The
+// meshes are appended to OutMeshes when given.
+UWorld* CreateBrushEntitiesFromBSPMap(FHL2PreparedMap& Map, const FString& BasePackageName, FHL2MaterialResolver& Materials,
+                                      const UHL2BSPImporterSettings* Sets, TArray<UStaticMesh*>* OutMeshes = nullptr);
+
+// Game thread. With bImportBakedLighting, the baked lightmap of the world mesh in package <BasePackageName>_Lightmap,
+// or of each chunk in <BasePackageName>_Chunk_<X>_<Y>_Lightmap; empty if nothing was baked.
+TArray<UTexture2D*> CreateLightmapTexturesFromBSPMap(const FHL2PreparedMap& Map, const FString& BasePackageName);
+
+// Game thread. Companion level with the static props as instances in package PackageName; null if nothing was placed.
+UWorld* CreatePropWorldFromBSPMap(const FHL2PreparedMap& Map, const FString& PackageName);
+
+// Game thread. Companion entity DataTable in package PackageName; null if the map has no entities.
+UHL2EntityTable* CreateEntityTableFromBSPMap(const FHL2PreparedMap& Map, const FString& PackageName);
@@ -2,5 +2,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogHL2BSPImporter, Log, All);
+
+// "stat HL2BSPImporter" in the editor; the same scopes appear as CPU events in Unreal Insights
+DECLARE_STATS_GROUP(TEXT("HL2 BSP Importer"), STATGROUP_HL2BSPImporter, STATCAT_Advanced);
+
+// Cycle stat (declared with DECLARE_CYCLE_STAT in the using .cpp) plus a trace event of the same name
+#define HL2_STAGE_SCOPE(StatName) \
+    SCOPE_CYCLE_COUNTER(StatName); \
+    TRACE_CPUPROFILER_EVENT_SCOPE(StatName)
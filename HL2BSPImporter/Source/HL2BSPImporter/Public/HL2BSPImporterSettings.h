@@ -3,6 +3,24 @@
 #include "Engine/DeveloperSettings.h"
 #include "HL2BSPImporterSettings.generated.h"
 
+UENUM()
+enum class EHL2CollisionMode : uint8
+{
+    // Trace against the render triangles
+    ComplexAsSimple,
+    // One convex hull per BSP brush, built from the brush planes and grouped by contents
+    BrushHulls,
+};
+
+UENUM()
+enum class EHL2ChunkMode : uint8
+{
+    // The whole world in one static mesh
+    SingleMesh,
+    // One static mesh per occupied cell of a uniform XY grid, plus a manifest of their bounds
+    Grid,
+};
+
 UCLASS(config = HL2BSPImporter, defaultconfig, meta = (DisplayName = "HL2 BSP Importer"))
 class HL2BSPIMPORTER_API UHL2BSPImporterSettings : public UDeveloperSettings
 {
@@ -18,12 +36,119 @@ public:
     UPROPERTY(config, EditAnywhere, Category = "Materials")
     FString MaterialJsonPath = TEXT("");
 
+    // One material slot (mesh section, draw call) per resolved material instead of per Source texture name; texture
+    // names mapped to the same material, and all unmapped ones, share a slot. Off to assign materials per texture later.
+    UPROPERTY(config, EditAnywhere, Category = "Materials")
+    bool bCompactMaterialSlots = true;
+
     UPROPERTY(config, EditAnywhere, Category = "Import")
     bool bBuildNanite = true;
 
+    // Without Nanite, each entry adds a mesh LOD (its screen size) in which every displacement drops one more power by
+    // taking every other grid sample; brush faces are the same in every LOD. Meshes without displacements get no LODs.
+    // Grid chunks get none either: chunks pick LODs independently, which would crack displacements across their seams.
+    UPROPERTY(config, EditAnywhere, Category = "Import", meta = (EditCondition = "!bBuildNanite && ChunkMode != EHL2ChunkMode::Grid"))
+    TArray<float> DisplacementLODScreenSizes = { 0.3f, 0.1f };
+
+    // Positions closer than this (in Unreal units, after scaling) are welded into one mesh vertex
+    UPROPERTY(config, EditAnywhere, Category = "Import", meta = (ClampMin = "0.0"))
+    float VertexWeldTolerance = 0.05f;
+
     UPROPERTY(config, EditAnywhere, Category = "Import")
     bool bImportCollision = true;
 
+    // Build LUMP_MODELS model 0 as the world and every brush entity model ("*N") as its own mesh, placed per entity in a
+    // <Mesh>_Brushes level; identical models share one mesh. Off merges brush entities into the world mesh.
+    UPROPERTY(config, EditAnywhere, Category = "Import")
+    bool bSplitBrushEntities = true;
+
+    // Faces go to the cell holding their centroid; displacements follow their base face and brush hulls their centre
+    UPROPERTY(config, EditAnywhere, Category = "Chunking")
+    EHL2ChunkMode ChunkMode = EHL2ChunkMode::SingleMesh;
+
+    // Grid cell edge length in Unreal units (after WorldScale), cells aligned to the world origin
+    UPROPERTY(config, EditAnywhere, Category = "Chunking", meta = (ClampMin = "100.0", EditCondition = "ChunkMode == EHL2ChunkMode::Grid"))
+    float ChunkCellSize = 10240.f;
+
+    // Tag each chunk with the BSP clusters and areas it is in and write a <Asset>_Visibility asset (world tree, area
+    // portals, per cluster the chunks its PVS can see) for UHL2VisibilityComponent to cull chunks at runtime
+    UPROPERTY(config, EditAnywhere, Category = "Chunking", meta = (EditCondition = "ChunkMode == EHL2ChunkMode::Grid"))
+    bool bImportVisibility = false;
+
+    UPROPERTY(config, EditAnywhere, Category = "Collision", meta = (EditCondition = "bImportCollision"))
+    EHL2CollisionMode CollisionMode = EHL2CollisionMode::ComplexAsSimple;
+
+    // Brush hulls are always built for CONTENTS_SOLID; these add brushes with the other blocking contents
+    UPROPERTY(config, EditAnywhere, Category = "Collision", meta = (EditCondition = "CollisionMode == EHL2CollisionMode::BrushHulls"))
+    bool bCollideWindows = true;
+
+    UPROPERTY(config, EditAnywhere, Category = "Collision", meta = (EditCondition = "CollisionMode == EHL2CollisionMode::BrushHulls"))
+    bool bCollideGrates = true;
+
+    UPROPERTY(config, EditAnywhere, Category = "Collision", meta = (EditCondition = "CollisionMode == EHL2CollisionMode::BrushHulls"))
+    bool bCollidePlayerClip = true;
+
+    UPROPERTY(config, EditAnywhere, Category = "Collision", meta = (EditCondition = "CollisionMode == EHL2CollisionMode::BrushHulls"))
+    bool bCollideMonsterClip = false;
+
+    // Merge adjacent coplanar faces with the same texinfo, drop collinear corners no other face uses and
+    // triangulate by ear clipping (largest minimum angle first) instead of fanning each compiler-split face
+    UPROPERTY(config, EditAnywhere, Category = "Import")
+    bool bMergeCoplanarFaces = true;
+
+    // Faces that are never rendered in game are dropped while faces are assembled (texinfo SURF_* flags)
+    UPROPERTY(config, EditAnywhere, Category = "Culling")
+    bool bCullNoDraw = true;
+
+    // SURF_SKY and SURF_SKY2D faces (the skybox shell around the playable area)
+    UPROPERTY(config, EditAnywhere, Category = "Culling")
+    bool bCullSky = true;
+
+    UPROPERTY(config, EditAnywhere, Category = "Culling")
+    bool bCullSkip = true;
+
+    UPROPERTY(config, EditAnywhere, Category = "Culling")
+    bool bCullHint = true;
+
+    UPROPERTY(config, EditAnywhere, Category = "Culling")
+    bool bCullTrigger = true;
+
+    // Faces whose texture name starts with one of these (case-insensitive) are dropped
+    UPROPERTY(config, EditAnywhere, Category = "Culling")
+    TArray<FString> CulledTexturePrefixes = {
+        TEXT("tools/toolsclip"), TEXT("tools/toolsplayerclip"), TEXT("tools/toolsnpcclip"), TEXT("tools/toolsinvisible"),
+        TEXT("tools/toolsnodraw"), TEXT("tools/toolsskip"), TEXT("tools/toolshint"), TEXT("tools/toolstrigger"),
+        TEXT("tools/toolsareaportal"), TEXT("tools/toolsoccluder"), TEXT("tools/toolsblocklight"), TEXT("tools/toolsblock_los"),
+        TEXT("tools/toolsfog"), TEXT("tools/toolsskybox") };
+
+    // Drop world brush faces that no leaf of a reachable cluster references: the PVS is followed outward from the
+    // clusters holding an info_player_*, info_landmark or sky_camera, so faces in solid, outside or sealed-off leaves go
+    // away before the mesh is built. Needs a map compiled with vvis.
+    UPROPERTY(config, EditAnywhere, Category = "Culling")
+    bool bCullUnreachableFaces = false;
+
+    // With bCullSky, build the sky faces into a separate <Mesh>_Sky static mesh instead of dropping them
+    UPROPERTY(config, EditAnywhere, Category = "Culling", meta = (EditCondition = "bCullSky"))
+    bool bImportSkyAsSeparateMesh = false;
+
+    // Place the sprp static props in a <Mesh>_Props level, one hierarchical instanced component per model
     UPROPERTY(config, EditAnywhere, Category = "Props")
     bool bImportPropsAsInstances = true;
+
+    // Content folder mirroring the game's model tree: models/foo/bar.mdl is expected at <PropMeshRoot>/models/foo/bar
+    UPROPERTY(config, EditAnywhere, Category = "Props", meta = (EditCondition = "bImportPropsAsInstances"))
+    FString PropMeshRoot = TEXT("/Game/HL2");
+
+    // UV channel 1 from the map's own lightmap projection (texinfo lightmap vectors), one chart per polygon or
+    // displacement packed into one page per mesh; the meshes use it as their lightmap coordinate
+    UPROPERTY(config, EditAnywhere, Category = "Lighting")
+    bool bImportLightmapUVs = true;
+
+    // Also decode the compiled lightmaps (light style 0) into a <Mesh>_Lightmap RGBA16F texture laid out on UV channel 1
+    UPROPERTY(config, EditAnywhere, Category = "Lighting", meta = (EditCondition = "bImportLightmapUVs"))
+    bool bImportBakedLighting = false;
+
+    // Write <Asset>.ImportReport.json (timings, memory, lump sizes, per-slot triangle counts) next to each imported asset
+    UPROPERTY(config, EditAnywhere, Category = "Diagnostics")
+    bool bWriteImportReport = true;
 };
@@ -0,0 +1,51 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "MeshDescription.h"
+
+class FBspFile;
+class UHL2BSPImporterSettings;
+struct FHL2LightmapAtlas;
+
+// Which faces a build takes: the world (brushes and displacements) or the faces the reader tagged as sky
+enum class EHL2BuildPart : uint8
+{
+    World,
+    Sky,
+};
+
+// What the builder kept and dropped, for logs and the import report
+struct FHL2MeshBuildStats
+{
+    int32 FacesBuilt = 0;
+    int32 FacesSkipped = 0;          // fewer than 3 valid corners (faces culled by the reader's filter are not counted)
+    int32 FacesMerged = 0;           // absorbed into a coplanar neighbour (bMergeCoplanarFaces)
+    int32 CollinearCornersRemoved = 0;
+    int32 DispsBuilt = 0;
+    int32 DispsSkipped = 0;          // base face without 3 or 4 corners, bad power or vertex range (culled bases are not counted)
+    int32 DispNodesStitched = 0;     // border nodes snapped onto a neighbouring displacement's
+    int32 Vertices = 0;              // after welding
+    int32 VertexInstances = 0;
+    int32 Triangles = 0;
+    int32 DegenerateTriangles = 0;   // zero area, found while the tangent frames are built
+    int32 CollapsedTriangles = 0;    // two corners welded onto one vertex
+    double NormalsSeconds = 0.0;     // normal/tangent pass, part of the build
+    int32 LightmapCharts = 0;        // bImportLightmapUVs: one per polygon or displacement
+    FIntPoint LightmapSize = FIntPoint::ZeroValue;
+    TArray<int32> TrianglesPerSlot;  // parallel to OutMaterialSlotNames
+};
+
+// Builds a welded MeshDescription, normals and tangents included, from parsed brush faces and displacement grids.
+// Brush faces are fan-triangulated, or merged and ear-clipped with bMergeCoplanarFaces; displacements are stitched
+// to neighbours in the same build. Polygon groups follow Source texture names in first-use order (OutMaterialSlotNames).
+//   Part:         World, or only the faces tagged BspFaceFlags::Sky (no displacements)
+//   FaceMask:     one bit per face; restricts the build to set faces and displacements on set base faces
+//   OutLightmap:  receives the packed lightmap charts (UV channel 1) when bImportLightmapUVs is on
+//   DispLODShift: drops that many powers from every displacement for a lower LOD; brush faces stay as in LOD 0
+FMeshDescription BuildMeshDescriptionFromBSP(const FBspFile& Bsp, const UHL2BSPImporterSettings* Sets, TArray<FName>& OutMaterialSlotNames,
+                                             FHL2MeshBuildStats* OutStats = nullptr, EHL2BuildPart Part = EHL2BuildPart::World,
+                                             const TBitArray<>* FaceMask = nullptr, FHL2LightmapAtlas* OutLightmap = nullptr,
+                                             int32 DispLODShift = 0);
+
+// Slot names BuildMeshDescriptionFromBSP will produce for this file, in the same order, without building any
+// geometry. Lets material loads start before the build.
+TArray<FName> GatherMaterialSlotNames(const FBspFile& Bsp);
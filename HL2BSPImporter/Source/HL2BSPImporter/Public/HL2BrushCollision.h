@@ -0,0 +1,57 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class FBspFile;
+class UBodySetup;
+struct FHL2CoordTransform;
+
+// Contents class of a collision brush; the first match in this order wins (a solid window is Solid)
+enum class EHL2CollisionGroup : uint8
+{
+    Solid,
+    Window,
+    Grate,
+    PlayerClip,
+    MonsterClip,
+    Num
+};
+
+// Convex hull of one brush, in Unreal space
+struct FHL2BrushHull
+{
+    TArray<FVector3f> Points;
+    int32 Brush = -1;   // LUMP_BRUSHES index
+    EHL2CollisionGroup Group = EHL2CollisionGroup::Solid;
+};
+
+struct FHL2BrushCollisionStats
+{
+    int32 Hulls[(int32)EHL2CollisionGroup::Num] = {};
+    int32 BrushesSkipped = 0;     // contents not in the group mask
+    int32 BrushesDegenerate = 0;  // planes do not enclose a volume (or bad side/plane indices)
+    int32 Points = 0;
+    double Seconds = 0.0;
+
+    int32 TotalHulls() const
+    {
+        int32 Sum = 0;
+        for (int32 Count : Hulls) Sum += Count;
+        return Sum;
+    }
+};
+
+const TCHAR* GetCollisionGroupName(EHL2CollisionGroup Group);
+
+// Any thread. Intersects the half-spaces of every brush whose contents fall in GroupMask (bits of 1 << EHL2CollisionGroup)
+// into a convex point set, brushes in parallel. Bevel sides are included; they only add planes that touch the hull.
+// Output is ordered by group, then brush index.
+void BuildBrushHulls(const FBspFile& Bsp, const FHL2CoordTransform& Xform, uint32 GroupMask,
+                     TArray<FHL2BrushHull>& OutHulls, FHL2BrushCollisionStats& OutStats);
+
+// Any thread. Brushes listed by the leaves under HeadNode (a FBspModel::HeadNode; every model has its own subtree),
+// each once and in ascending order. Empty if the map has no usable node/leaf lumps.
+void GetModelBrushes(const FBspFile& Bsp, int32 HeadNode, TArray<int32>& OutBrushes);
+
+// Game thread. Replaces the convex elements of BodySetup with the hulls (each named after its group) and makes
+// simple collision answer complex queries as well.
+void ApplyBrushHulls(UBodySetup* BodySetup, TConstArrayView<FHL2BrushHull> Hulls);
@@ -0,0 +1,54 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "MeshDescription.h"
+#include "HL2LightmapAtlas.h"
+#include "HL2BrushCollision.h"
+
+class FBspFile;
+class UPackage;
+class UStaticMesh;
+class UWorld;
+struct FHL2CoordTransform;
+
+// Brush entity models (LUMP_MODELS 1..N) with the same faces up to a translation; one mesh serves all of them
+struct FHL2BrushModelGroup
+{
+    TArray<int32> Models;           // LUMP_MODELS indices; the first one is built
+    TBitArray<> Faces;              // kept faces of the first model, as a builder face mask
+    FVector3f Pivot = FVector3f::ZeroVector;   // Unreal space centre of the first model's faces; the mesh is built around it
+    FMeshDescription MeshDescription;
+    TArray<FName> SlotNames;
+    FHL2LightmapAtlas Lightmap;     // charts only; brush models are not baked
+    TArray<FHL2BrushHull> CollisionHulls;   // the first model's brushes, around Pivot (BrushHulls collision mode)
+};
+
+// One brush entity using a group's mesh
+struct FHL2BrushEntityPlacement
+{
+    int32 Entity = INDEX_NONE;      // FBspFile::GetEntities() index
+    int32 Group = INDEX_NONE;
+    FTransform Transform;           // Unreal world space, pivot offset included
+    FString Label;                  // targetname, or classname_<entity index>
+    bool bMovable = false;          // class moves at runtime (doors, trains, buttons, ...)
+};
+
+struct FHL2BrushModelStats
+{
+    int32 Models = 0;               // submodels in LUMP_MODELS (the world excluded)
+    int32 Referenced = 0;           // used by at least one entity
+    int32 Empty = 0;                // referenced, but every face was culled (triggers, areaportals, ...)
+    int32 Groups = 0;               // distinct geometries = meshes
+    int32 Placements = 0;
+    int32 Triangles = 0;            // over the built meshes
+};
+
+// Any thread. Finds the entities with a "*N" model, groups their models by a hash of the kept faces (positions
+// relative to the face centre, UVs relative to each face's integer texture offset, texture names) and computes
+// each placement from the entity's origin and angles.
+void GroupBrushModels(const FBspFile& Bsp, const FHL2CoordTransform& Xform, TArray<FHL2BrushModelGroup>& OutGroups,
+                      TArray<FHL2BrushEntityPlacement>& OutPlacements, FHL2BrushModelStats& OutStats);
+
+// Game thread. Level asset in Package holding one static mesh actor per placement, GroupMeshes parallel to the
+// groups (null entries are skipped). Null if nothing was placed.
+UWorld* CreateBrushEntityWorld(TConstArrayView<FHL2BrushEntityPlacement> Placements, TConstArrayView<UStaticMesh*> GroupMeshes,
+                               UPackage* Package, FName Name, EObjectFlags Flags);
@@ -0,0 +1,100 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class FBspFile;
+
+// One LUMP_NODES entry with its splitting plane inlined (Source space), 24 bytes. A child >= 0 is a node, < 0 is leaf
+// -1 - child. Nodes keep vbsp's depth-first order, so a walk mostly moves forward through the array.
+struct FHL2BspNode
+{
+    FVector3f Normal = FVector3f::ZeroVector;
+    float Dist = 0.f;
+    int32 Children[2] = { 0, 0 };   // front (Dot(N, P) >= Dist), back
+};
+static_assert(sizeof(FHL2BspNode) == 24, "FHL2BspNode layout");
+
+// One LUMP_LEAFS entry, whatever the lump version
+struct FHL2BspLeaf
+{
+    int32 Contents = 0;
+    int16 Cluster = -1;              // -1 for solid leaves and leaves outside the map
+    int16 Area = 0;
+    int32 FirstLeafFace = 0;         // -> FHL2BspTree::LeafFaces
+    int32 NumLeafFaces = 0;
+};
+
+// One side of a LUMP_AREAPORTALS entry: the portal as seen from the area listing it
+struct FHL2BspAreaPortal
+{
+    int32 PortalKey = 0;             // func_areaportal "portalnumber"; both sides of a portal share it
+    int32 OtherArea = 0;
+};
+
+// One LUMP_AREAS entry; area 0 is the void outside the map
+struct FHL2BspArea
+{
+    int32 FirstAreaPortal = 0;       // -> FHL2BspTree::AreaPortals
+    int32 NumAreaPortals = 0;
+};
+
+// A segment for TraceRay, Source space
+struct FHL2BspRay
+{
+    FVector3f Start = FVector3f::ZeroVector;
+    FVector3f End = FVector3f::ZeroVector;
+};
+
+struct FHL2BspTraceResult
+{
+    bool bHit = false;
+    bool bStartSolid = false;        // Start is inside a matching leaf (Fraction 0, no normal)
+    float Fraction = 1.f;            // along Start -> End where the first matching leaf begins
+    FVector3f Position = FVector3f::ZeroVector;
+    FVector3f Normal = FVector3f::ZeroVector;   // of the plane entered through, facing Start
+    int32 Leaf = INDEX_NONE;         // the leaf hit
+};
+
+// The world's node/leaf tree and its visibility data, copied out of the file by FBspFile::Parse
+struct FHL2BspTree
+{
+    TArray<FHL2BspNode> Nodes;        // node 0 is the world's head node
+    TArray<FHL2BspLeaf> Leafs;
+    TArray<uint16> LeafFaces;         // LUMP_LEAFFACES: LUMP_FACES indices
+    TArray<uint8> Visibility;         // LUMP_VISIBILITY as stored: cluster count, PVS/PAS offsets, run-length bitsets
+    int32 NumClusters = 0;
+    TArray<FHL2BspArea> Areas;
+    TArray<FHL2BspAreaPortal> AreaPortals;
+
+    // Reads LUMP_PLANES, LUMP_NODES, LUMP_LEAFS (version 0 or 1), LUMP_LEAFFACES, LUMP_VISIBILITY, LUMP_AREAS and
+    // LUMP_AREAPORTALS; false if the map has no usable tree (the arrays are then empty)
+    bool Load(const FBspFile& Bsp);
+    void Reset();
+
+    bool IsValid() const { return Leafs.Num() > 0; }
+    bool HasVisibility() const { return NumClusters > 0; }
+
+    // Queries take Source-space coordinates; ContentsMask selects the leaves that stop a ray or count as solid
+    // (CONTENTS_* bits, CONTENTS_SOLID by default). All are const and safe to run from any number of threads.
+
+    // Leaf holding a point; INDEX_NONE without a tree
+    int32 PointInLeaf(const FVector3f& Point) const;
+    bool IsPointSolid(const FVector3f& Point, int32 ContentsMask = DefaultContentsMask) const;
+
+    // First matching leaf along Start -> End. Splits the segment at each node plane it crosses and visits the near
+    // side first, so the first matching leaf reached is the nearest. False (Out.Fraction 1) if nothing is hit.
+    bool TraceRay(const FVector3f& Start, const FVector3f& End, FHL2BspTraceResult& Out, int32 ContentsMask = DefaultContentsMask) const;
+
+    // Leaves a box touches (appended to OutLeaves, each once)
+    void BoxLeaves(const FBox3f& Box, TArray<int32>& OutLeaves) const;
+
+    // Batch forms, spread over the task graph in blocks of BatchQueryBlock. Out has to be as long as the input.
+    void PointInLeafBatch(TConstArrayView<FVector3f> Points, TArrayView<int32> OutLeaves) const;
+    void TraceRayBatch(TConstArrayView<FHL2BspRay> Rays, TArrayView<FHL2BspTraceResult> OutResults, int32 ContentsMask = DefaultContentsMask) const;
+
+    static constexpr int32 DefaultContentsMask = 0x1;   // CONTENTS_SOLID
+    static constexpr int32 BatchQueryBlock = 256;
+
+    // Decompressed PVS row of Cluster: bit c is set if cluster c may be visible from it. Maps without visibility
+    // data see everything. False if Cluster is out of range or its row is corrupt.
+    bool GetClusterPVS(int32 Cluster, TBitArray<>& OutVisible) const;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "HL2ChunkManifest.generated.h"
+
+class UStaticMesh;
+
+USTRUCT()
+struct HL2BSPIMPORTER_API FHL2ChunkEntry
+{
+    GENERATED_BODY()
+    UPROPERTY(EditAnywhere, Category = "HL2") TSoftObjectPtr<UStaticMesh> Mesh;
+    UPROPERTY(EditAnywhere, Category = "HL2") FIntPoint Cell = FIntPoint::ZeroValue;
+    UPROPERTY(EditAnywhere, Category = "HL2") FBox Bounds = FBox(ForceInit);
+    UPROPERTY(EditAnywhere, Category = "HL2") int32 Triangles = 0;
+    // BSP clusters and areas the chunk's geometry is in (bImportVisibility); empty without visibility data
+    UPROPERTY(EditAnywhere, Category = "HL2") TArray<int32> Clusters;
+    UPROPERTY(EditAnywhere, Category = "HL2") TArray<int32> Areas;
+};
+
+// Index of the world chunk meshes of one chunked import: which grid cell each mesh covers and its bounds, so chunks
+// can be placed, streamed and culled without loading them first.
+UCLASS()
+class HL2BSPIMPORTER_API UHL2ChunkManifest : public UDataAsset
+{
+    GENERATED_BODY()
+public:
+    UPROPERTY(EditAnywhere, Category = "HL2") FString SourceFile;
+    // Edge length of a grid cell in Unreal units; cell (X, Y) spans [X, X + 1) * CellSize on each axis
+    UPROPERTY(EditAnywhere, Category = "HL2") float CellSize = 0.f;
+    UPROPERTY(EditAnywhere, Category = "HL2") FBox Bounds = FBox(ForceInit);
+    UPROPERTY(EditAnywhere, Category = "HL2") TArray<FHL2ChunkEntry> Chunks;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UHL2BSPImporterSettings;
+
+// Source -> Unreal coordinate conversion (optional Y/Z swap, Y flip, WorldScale) baked once per import
+// into a single 3x4 float matrix. Bulk stream transforms run through VectorRegister4Float.
+struct HL2BSPIMPORTER_API FHL2CoordTransform
+{
+    // Row-major: Out[r] = Row[r].X * In.X + Row[r].Y * In.Y + Row[r].Z * In.Z + Row[r].W
+    FVector4f Rows[3];
+
+    static FHL2CoordTransform FromSettings(const UHL2BSPImporterSettings* Sets);
+
+    FVector3f TransformPosition(const FVector3f& P) const
+    {
+        return FVector3f(
+            Rows[0].X * P.X + Rows[0].Y * P.Y + Rows[0].Z * P.Z + Rows[0].W,
+            Rows[1].X * P.X + Rows[1].Y * P.Y + Rows[1].Z * P.Z + Rows[1].W,
+            Rows[2].X * P.X + Rows[2].Y * P.Y + Rows[2].Z * P.Z + Rows[2].W);
+    }
+
+    FVector3f TransformVector(const FVector3f& V) const
+    {
+        return FVector3f(
+            Rows[0].X * V.X + Rows[0].Y * V.Y + Rows[0].Z * V.Z,
+            Rows[1].X * V.X + Rows[1].Y * V.Y + Rows[1].Z * V.Z,
+            Rows[2].X * V.X + Rows[2].Y * V.Y + Rows[2].Z * V.Z);
+    }
+
+    // Source QAngle (pitch about Y, yaw about Z, roll about X, degrees) -> rotation in Unreal space
+    FQuat TransformAngles(const FVector3f& Angles) const;
+
+    // Vectorized stream transforms. In and Out must have the same length; in-place (In == Out) is allowed.
+    void TransformPositions(TConstArrayView<FVector3f> In, TArrayView<FVector3f> Out) const;
+    void TransformVectors(TConstArrayView<FVector3f> In, TArrayView<FVector3f> Out) const;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FBspGeometry;
+struct FDispInfo;
+struct FDispVert;
+
+// Grid layout used throughout: node (Row, Col) = Row * Side + Col. Rows run from base corner 0 to corner 1, columns
+// from the corner 0-1 edge to the corner 3-2 edge, as in Source's CCoreDispInfo.
+
+// Base surface of one displacement. Corner 0 is the base face corner nearest DDispInfo::StartPosition; the others
+// follow the face's winding. A triangle base repeats its last corner, collapsing the grid's last column onto it;
+// TessellateDisplacement gives that whole column one shared position so it welds into a single apex vertex.
+struct FHL2DispBase
+{
+    FVector3f Corners[4];
+    FVector2f UVs[4];
+    FVector2f LightmapUVs[4];
+    bool bTriangle = false;
+};
+
+inline int32 GetDispSide(int32 Power)
+{
+    return (1 << Power) + 1;
+}
+
+// Two triangles per cell; a triangle base loses the collapsed half of each cell in its last column
+inline int32 GetDispNumTriangles(int32 Side, bool bTriangle)
+{
+    return (Side - 1) * (Side - 1) * 2 - (bTriangle ? Side - 1 : 0);
+}
+
+inline bool IsDispBorderNode(int32 Side, int32 Node)
+{
+    const int32 Row = Node / Side;
+    const int32 Col = Node % Side;
+    return Row == 0 || Col == 0 || Row == Side - 1 || Col == Side - 1;
+}
+
+// Oriented base of Info's face; false unless the face has 3 or 4 corners
+bool GetDispBase(const FBspGeometry& Geo, const FDispInfo& Info, FHL2DispBase& Out);
+
+// Any thread. Side * Side nodes: the bilinear base position plus Vector * Dist (Source space), UVs, lightmap UVs
+// (skipped if OutLightmapUVs is empty) and blend alphas in 0..1. Verts is the full grid as stored in the map; a Step of
+// 2^k takes every 2^k-th sample of it, which is exactly the grid of a displacement k powers lower.
+void TessellateDisplacement(const FHL2DispBase& Base, int32 Side, int32 Step, TConstArrayView<FDispVert> Verts, TArrayView<FVector3f> OutPositions,
+                            TArrayView<FVector2f> OutUVs, TArrayView<FVector2f> OutLightmapUVs, TArrayView<float> OutAlphas);
+
+// Any thread. GetDispNumTriangles triangles as node triples offset by FirstNode, in the base face's winding. Cell
+// diagonals alternate in a checkerboard, as Source's do.
+void TriangulateDisplacement(int32 Side, bool bTriangle, int32 FirstNode, TArrayView<int32> OutTriNodes);
+
+// One displacement of a build, for StitchDisplacements
+struct FHL2DispStitchInput
+{
+    int32 DispInfo = INDEX_NONE;   // LUMP_DISPINFO index
+    int32 Side = 0;
+    int32 FirstNode = 0;           // into NodePositions
+    bool bTriangle = false;        // last column is one welded apex; stitched as a single node
+};
+
+// Border nodes of displacements listed as each other's edge or corner neighbours that lie within 0.5 units are
+// snapped onto their average, so they weld into one vertex. Neighbours outside Disps (another chunk, a brush
+// entity) are left alone. Pairs are found in parallel per displacement. Returns the number of nodes snapped.
+int32 StitchDisplacements(TConstArrayView<FDispInfo> Infos, TConstArrayView<FHL2DispStitchInput> Disps, TArrayView<FVector3f> NodePositions);
@@ -0,0 +1,36 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Every key/value pair of the entity lump, kept in one character arena. Keys and values are returned as
+// NUL-terminated views into the arena; duplicate keys (e.g. entity outputs) are all retained in file order.
+class HL2BSPIMPORTER_API FHL2EntityKeyValues
+{
+public:
+    // Tokenizes the ANSI entity lump in place; only the arena and pair tables are allocated (once, up front).
+    void Parse(TConstArrayView<uint8> Lump);
+    void Reset();
+
+    int32 NumEntities() const { return EntityFirstPair.Num(); }
+    int32 NumPairs(int32 Entity) const { return GetPairEnd(Entity) - EntityFirstPair[Entity]; }
+    FAnsiStringView GetKey(int32 Entity, int32 PairIndex) const { return View(Pairs[EntityFirstPair[Entity] + PairIndex].Key); }
+    FAnsiStringView GetValue(int32 Entity, int32 PairIndex) const { return View(Pairs[EntityFirstPair[Entity] + PairIndex].Value); }
+
+    // First value for Key (case-insensitive), or an empty view if the entity has no such key
+    FAnsiStringView FindValue(int32 Entity, FAnsiStringView Key) const;
+    bool HasKey(int32 Entity, FAnsiStringView Key) const;
+
+    // Parses up to Count whitespace-separated floats from a value without allocating; returns how many were read
+    static int32 ParseFloats(FAnsiStringView Value, float* Out, int32 Count);
+
+private:
+    struct FSpan { int32 Ofs = 0; int32 Len = 0; };
+    struct FPair { FSpan Key; FSpan Value; };
+
+    FAnsiStringView View(const FSpan& S) const { return FAnsiStringView(Arena.GetData() + S.Ofs, S.Len); }
+    int32 GetPairEnd(int32 Entity) const { return Entity + 1 < EntityFirstPair.Num() ? EntityFirstPair[Entity + 1] : Pairs.Num(); }
+    FSpan Store(const uint8* Begin, const uint8* End);
+
+    TArray<ANSICHAR> Arena;
+    TArray<FPair> Pairs;
+    TArray<int32> EntityFirstPair;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FBspGeometry;
+
+// Polygons produced by merging coplanar brush faces, each with its own triangulation. Corners index the reader's
+// per-corner streams (FBspGeometry::Indices/UVs), so positions and UVs come straight from the parsed faces.
+struct FHL2MergedPolygons
+{
+    TArray<int32> Corners;            // per polygon corner -> FBspGeometry corner
+    TArray<int32> PolyFirstCorner;    // per polygon -> Corners
+    TArray<int32> PolyNumCorners;
+    TArray<int32> PolyFace;           // lowest source face index in the polygon (texture, flags)
+    TArray<uint16> TriCorners;        // 3 local corner indices per triangle, NumCorners - 2 triangles per polygon, in polygon order
+    TArray<int32> Members;            // source faces of each polygon, PolyFace first
+    TArray<int32> PolyFirstMember;    // per polygon -> Members, plus one end entry
+
+    int32 FacesMerged = 0;            // source faces absorbed into a neighbour
+    int32 CollinearRemoved = 0;       // boundary corners dropped as collinear
+
+    int32 Num() const { return PolyFirstCorner.Num(); }
+    TConstArrayView<int32> GetMembers(int32 Poly) const
+    {
+        return TConstArrayView<int32>(Members.GetData() + PolyFirstMember[Poly], PolyFirstMember[Poly + 1] - PolyFirstMember[Poly]);
+    }
+};
+
+// Merges edge-adjacent faces that share a texinfo (so also a texture projection) and a plane into simple polygons,
+// drops collinear boundary corners that no other face references (T-junction vertices stay), and triangulates each
+// polygon by clipping the ear with the largest minimum angle. Faces must have at least 3 corners; displacement base
+// faces are passed through unmerged. Output polygons are ordered by PolyFace.
+void MergeCoplanarFaces(const FBspGeometry& Geo, TConstArrayView<int32> Faces, FHL2MergedPolygons& Out);
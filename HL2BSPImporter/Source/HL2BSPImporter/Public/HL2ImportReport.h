@@ -0,0 +1,9 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FHL2PreparedMap;
+
+// Writes <PackageName>.ImportReport.json next to the imported asset: wall time, per-stage and per-decode-task
+// timings, memory samples and the process peak, every non-empty lump with its size and element count, and the
+// builder's per-slot triangle counts and skipped/degenerate geometry. Returns false if the file could not be written.
+bool WriteImportReport(const FHL2PreparedMap& Map, const FString& PackageName, double WallSeconds);
@@ -0,0 +1,49 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class FBspFile;
+class UTexture2D;
+
+// Lightmap rectangle of one built polygon, face or displacement, in Source luxels
+struct FHL2LightmapChart
+{
+    FIntPoint Origin = FIntPoint::ZeroValue;   // atlas texel of the first sample (inside the chart's padding)
+    FIntPoint Mins = FIntPoint::ZeroValue;     // luxel coordinate of the first sample
+    FIntPoint Size = FIntPoint::ZeroValue;     // samples
+    float Scale = 1.f;                         // below 1 when the chart was shrunk to HL2LightmapMaxChartSize
+    int32 FirstFace = 0;                       // -> FHL2LightmapAtlas::ChartFaces, the faces whose samples fill the chart
+    int32 NumFaces = 0;
+};
+
+// Every chart of one mesh packed into a single lightmap page
+struct FHL2LightmapAtlas
+{
+    FIntPoint Size = FIntPoint::ZeroValue;
+    TArray<FHL2LightmapChart> Charts;
+    TArray<int32> ChartFaces;
+    TArray<FFloat16Color> Texels;   // linear RGB, row-major; empty unless BakeLightmapAtlas ran
+
+    // Adds a chart covering luxel coordinates in [Min, Max] and returns its index
+    int32 AddChart(const FVector2f& Min, const FVector2f& Max, TConstArrayView<int32> Faces);
+
+    // Atlas UV of a luxel coordinate inside Chart (sample centres fall on texel centres)
+    FVector2f GetUV(int32 Chart, const FVector2f& Luxel) const
+    {
+        const FHL2LightmapChart& C = Charts[Chart];
+        return FVector2f(
+            (C.Origin.X + (Luxel.X - C.Mins.X) * C.Scale + 0.5f) / (float)FMath::Max(1, Size.X),
+            (C.Origin.Y + (Luxel.Y - C.Mins.Y) * C.Scale + 0.5f) / (float)FMath::Max(1, Size.Y));
+    }
+};
+
+// Any thread. Shelf packer: charts sorted by height, placed left to right on shelves of a page about as wide as the
+// square root of the padded chart area. Sets every chart's Origin and the atlas Size.
+void PackLightmapAtlas(FHL2LightmapAtlas& Atlas);
+
+// Any thread. Fills Texels from the first light style of each chart's faces: LUMP_LIGHTING, or LUMP_LIGHTING_HDR
+// through LUMP_FACES_HDR on HDR-only maps. Unlit faces are white; padding repeats the chart's edge texels.
+// False if the map has no lighting.
+bool BakeLightmapAtlas(const FBspFile& Bsp, FHL2LightmapAtlas& Atlas);
+
+// Game thread. Uncompressed RGBA16F texture of the baked texels, clamped, without mips; null if nothing was baked.
+UTexture2D* CreateLightmapTexture(const FHL2LightmapAtlas& Atlas, UObject* Outer, FName Name, EObjectFlags Flags);
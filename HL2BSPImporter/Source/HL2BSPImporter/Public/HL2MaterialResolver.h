@@ -0,0 +1,46 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPath.h"
+
+class UHL2BSPImporterSettings;
+class UMaterialInterface;
+struct FStreamableHandle;
+
+// Texture name -> material path table parsed from the material JSON. Keys are case-normalized
+// (lower case, forward slashes) since Source texture names are case-insensitive.
+struct HL2BSPIMPORTER_API FHL2MaterialIndex
+{
+    FString SourcePath;
+    FDateTime Timestamp;
+    TMap<FString, FSoftObjectPath> ByTexture;
+
+    static FString NormalizeTextureName(const FString& TextureName);
+    const FSoftObjectPath* Find(FName SlotName) const { return ByTexture.Find(NormalizeTextureName(SlotName.ToString())); }
+};
+
+// Resolves material slots for one import. Loads are batched into a single FStreamableManager request issued
+// before the mesh build; Resolve() blocks (and logs the wait) only if the batch has not finished yet.
+class HL2BSPIMPORTER_API FHL2MaterialResolver
+{
+public:
+    // Index for the configured JSON (settings path, else plugin Resources/Materials.json). The file is parsed
+    // once and reused until its path or timestamp changes. Safe to call from any thread.
+    static TSharedRef<const FHL2MaterialIndex> GetIndex(const UHL2BSPImporterSettings* Sets);
+
+    explicit FHL2MaterialResolver(TSharedRef<const FHL2MaterialIndex> InIndex);
+    ~FHL2MaterialResolver();
+
+    // Game thread. Starts async loads for the mapped materials of these slots; unmapped slots are skipped.
+    void RequestLoads(TConstArrayView<FName> SlotNames);
+
+    // Game thread. Material for a slot, or null if the slot is unmapped or the load failed.
+    UMaterialInterface* Resolve(FName SlotName);
+
+    const FHL2MaterialIndex& GetIndexData() const { return *Index; }
+    int32 NumRequested() const { return NumRequestedPaths; }
+
+private:
+    TSharedRef<const FHL2MaterialIndex> Index;
+    TSharedPtr<FStreamableHandle> Handle;
+    int32 NumRequestedPaths = 0;
+};
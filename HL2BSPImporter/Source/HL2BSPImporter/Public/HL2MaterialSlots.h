@@ -0,0 +1,18 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FMeshDescription;
+
+// Material slots merged across the meshes of one import
+struct FHL2SlotCompactionStats
+{
+    int32 Meshes = 0;
+    int32 SlotsBefore = 0;          // one per Source texture name
+    int32 SlotsAfter = 0;           // one per distinct resolved material
+    double Seconds = 0.0;
+};
+
+// Any thread. Moves the polygons of every polygon group whose material slot name is a key of SlotRedirects into the
+// group of the slot it maps to (the group is renamed if the mesh has none yet) and deletes the emptied groups, so
+// BuildFromMeshDescriptions makes one section per remaining slot. Returns the number of groups removed.
+int32 CompactMaterialSlots(FMeshDescription& MD, const TMap<FName, FName>& SlotRedirects);
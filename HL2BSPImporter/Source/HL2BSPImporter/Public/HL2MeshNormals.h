@@ -0,0 +1,33 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Consecutive points and triangles of the builder's streams that come from one brush polygon or one displacement
+struct FHL2NormalRegion
+{
+    int32 FirstPoint = 0;            // the region's points run up to the next region's FirstPoint
+    int32 FirstTri = 0;
+    int32 NumTris = 0;
+    uint32 SmoothingGroups = 0;      // regions sharing a bit share normals at common vertices; 0 keeps the region flat
+    FVector3f PlaneNormal = FVector3f::ZeroVector;   // unit, Unreal space; zero to smooth over the triangles instead
+};
+
+// Tangent frame per point (vertex instance), plus what construction-time validation found in the triangles
+struct FHL2TangentFrames
+{
+    TArray<FVector3f> Normals;
+    TArray<FVector3f> Tangents;
+    TArray<float> BinormalSigns;
+    int32 DegenerateTriangles = 0;   // zero area; they add nothing to any frame
+    int32 CollapsedTriangles = 0;    // two corners welded onto the same vertex
+};
+
+// Any thread. Normals, tangents and binormal signs for every point, without a MeshDescription:
+//  - Corner contributions are weighted by corner angle and UV tangents come from the triangle's UV gradients, as
+//    in MikkTSpace; the tangent is then orthogonalized against the final normal. Parallel over regions.
+//  - A region with a PlaneNormal takes it for all its points (oriented like its winding); others accumulate their
+//    triangles' normals.
+//  - Points on one welded vertex (PointVertex) add the normals of other regions' points there when their regions
+//    share a smoothing group and face the same half-space. Parallel over points.
+// Triangles are wound clockwise seen from the front, as in UE.
+void ComputeTangentFrames(TConstArrayView<FHL2NormalRegion> Regions, TConstArrayView<FVector3f> Positions, TConstArrayView<FVector2f> UVs,
+                          TConstArrayView<int32> PointVertex, int32 NumVertices, TConstArrayView<int32> TriPoints, FHL2TangentFrames& Out);
@@ -0,0 +1,31 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPath.h"
+
+class FBspFile;
+class UPackage;
+class UWorld;
+struct FHL2CoordTransform;
+
+// Every placement of one sprp model, ready for a single AddInstances call
+struct FHL2PropBatch
+{
+    FString Model;                  // Source path from the sprp dictionary
+    FSoftObjectPath Mesh;           // static mesh expected for it under PropMeshRoot
+    TArray<FTransform> Instances;   // Unreal world space
+    float CullStart = 0.f;          // Unreal units; both 0 = never culled
+    float CullEnd = 0.f;
+    bool bCollision = false;        // at least one placement is solid
+};
+
+// "models/props_c17/oildrum001.mdl" under "/Game/HL2" -> /Game/HL2/models/props_c17/oildrum001.oildrum001
+FSoftObjectPath MakePropMeshPath(const FString& Model, const FString& MeshRoot);
+
+// Any thread. Groups the sprp placements by model (dictionary order) and converts origins and QAngles to Unreal
+// transforms with the import's axis/scale. Fade distances become the batch's cull distances: the largest of
+// each, or none if any placement never fades.
+void BuildStaticPropBatches(const FBspFile& Bsp, const FHL2CoordTransform& Xform, const FString& MeshRoot, TArray<FHL2PropBatch>& OutBatches);
+
+// Game thread. Level asset in Package holding one actor with a UHierarchicalInstancedStaticMeshComponent per batch.
+// Meshes are loaded in one batch; models without a mesh are skipped. Null if no batch could be placed.
+UWorld* CreateStaticPropWorld(TConstArrayView<FHL2PropBatch> Batches, UPackage* Package, FName Name, EObjectFlags Flags);
@@ -0,0 +1,21 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Shape of a generated map. Content is deterministic for a given parameter set.
+struct FHL2SyntheticBspParams
+{
+    int32 NumFaces = 10000;
+    int32 SidesPerFace = 4;        // regular polygons, clamped to [3, 32]
+    int32 NumDisplacements = 0;    // the first N faces are emitted as quads with a displacement each
+    int32 DispPower = 3;           // 2..4
+    int32 NumEntities = 1000;
+    int32 NumTextures = 64;
+    int32 Seed = 1;
+};
+
+// Writes a self-consistent VBSP v20 image (vertexes, edges, surfedges, faces, texinfo/texdata + string tables,
+// dispinfo/dispverts, entity text, one solid prism brush under each vertex ring in planes/brushes/brushsides, and a
+// node/leaf tree over those prisms without visibility) for benchmarking the reader, builder, collision and tree
+// queries. LUMP_EDGES stores uint16 vertex indices, so once 64K vertices are used further faces reuse existing
+// vertex rings, as real maps near the limit do.
+HL2BSPIMPORTER_API void GenerateSyntheticBsp(const FHL2SyntheticBspParams& Params, TArray<uint8>& OutBytes);
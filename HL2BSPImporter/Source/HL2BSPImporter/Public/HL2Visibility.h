@@ -0,0 +1,31 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class FBspFile;
+class UHL2ChunkManifest;
+class UHL2VisibilityData;
+struct FHL2CoordTransform;
+
+struct FHL2VisibilityStats
+{
+    int32 Clusters = 0;
+    int32 Areas = 0;
+    int32 AreaPortals = 0;          // distinct portals (both sides counted once)
+    int32 Sections = 0;
+    int32 UntaggedSections = 0;     // no cluster found; visible from everywhere
+    double AvgVisibleSections = 0.0;   // over clusters
+    int64 Bytes = 0;                // tree, leaf tables and bit rows of the asset
+    double Seconds = 0.0;
+};
+
+// Any thread. Clusters and areas the geometry of each section is in; FaceSection maps a LUMP_FACES index to its
+// section (INDEX_NONE = none). Faces listed in leaves take those leaves. Displacements and other unlisted faces take
+// every leaf their bounds touch, displacement offsets included, like the engine does. Empty without visibility data.
+void GatherSectionClusters(const FBspFile& Bsp, TConstArrayView<int32> FaceSection, int32 NumSections,
+                           TArray<TArray<int32>>& OutClusters, TArray<TArray<int32>>& OutAreas);
+
+// Game thread. Visibility asset for the chunks of Manifest (tagged by GatherSectionClusters): the world tree in Unreal
+// space, each leaf's cluster and area, the area portals with their func_areaportal start state, and per cluster the
+// chunks its PVS touches. Null if the map has no visibility data.
+UHL2VisibilityData* CreateVisibilityData(const FBspFile& Bsp, const FHL2CoordTransform& Xform, const UHL2ChunkManifest& Manifest,
+                                         UObject* Parent, FName Name, EObjectFlags Flags, FHL2VisibilityStats& OutStats);
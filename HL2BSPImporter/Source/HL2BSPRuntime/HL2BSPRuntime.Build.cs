@@ -0,0 +1,15 @@
+using UnrealBuildTool;
+
+// Game-side half of the plugin: what imported maps need at runtime, without the editor dependencies
+public class HL2BSPRuntime : ModuleRules
+{
+    public HL2BSPRuntime(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+        PrivatePCHHeaderFile = "Public/HL2BSPRuntime.h";
+        PublicDependencyModuleNames.AddRange(
+            new string[] {
+                "Core", "CoreUObject", "Engine"
+            });
+    }
+}
@@ -0,0 +1,7 @@
+// Minimal module implementation for the HL2BSPRuntime module
+#include "HL2BSPRuntime.h" // Must be first
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY(LogHL2BSPRuntime);
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, HL2BSPRuntime)
@@ -0,0 +1,238 @@
+#include "HL2VisibilityComponent.h"
+#include "HL2BSPRuntime.h"
+#include "HL2VisibilityData.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+// Runtime PVS/area portal culling of imported sections.
+
+DECLARE_STATS_GROUP(TEXT("HL2 BSP Runtime"), STATGROUP_HL2BSPRuntime, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Visibility Update"), STAT_HL2_VisUpdate, STATGROUP_HL2BSPRuntime);
+
+UHL2VisibilityComponent::UHL2VisibilityComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    // Cameras are updated after TG_PostPhysics; this frame's view is known by now
+    PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+}
+
+bool UHL2VisibilityComponent::ValidateData() const
+{
+    const UHL2VisibilityData* Data = VisibilityData;
+    if (!Data || Data->NumSections() == 0 || Data->LeafClusters.Num() == 0)
+    {
+        return false;
+    }
+    const int32 NumLeafs = Data->LeafClusters.Num();
+    // Children come after their parent (as the importer writes them), so leaf lookups always terminate
+    for (int32 n = 0; n < Data->Nodes.Num(); ++n)
+    {
+        for (int32 Child : Data->Nodes[n].Children)
+        {
+            if (Child >= 0 ? (Child <= n || Child >= Data->Nodes.Num()) : -1 - Child >= NumLeafs) return false;
+        }
+    }
+    for (const FHL2VisAreaPortal& Portal : Data->AreaPortals)
+    {
+        if (Portal.Areas[0] < 0 || Portal.Areas[0] >= Data->NumAreas || Portal.Areas[1] < 0 || Portal.Areas[1] >= Data->NumAreas) return false;
+    }
+    return Data->LeafAreas.Num() == NumLeafs
+        && Data->SectionWords == (Data->NumSections() + 31) / 32
+        && Data->ClusterSections.Num() == Data->NumClusters * Data->SectionWords
+        && (Data->AreaWords == 0 || (Data->AreaWords == (Data->NumAreas + 31) / 32 && Data->SectionAreas.Num() == Data->NumSections() * Data->AreaWords));
+}
+
+void UHL2VisibilityComponent::BeginPlay()
+{
+    Super::BeginPlay();
+    bDataValid = ValidateData();
+    if (!bDataValid)
+    {
+        if (VisibilityData)
+        {
+            UE_LOG(LogHL2BSPRuntime, Warning, TEXT("%s: visibility data %s is empty or inconsistent; nothing is culled"), *GetPathName(), *VisibilityData->GetName());
+        }
+        SetComponentTickEnabled(false);
+        return;
+    }
+    const UHL2VisibilityData* Data = VisibilityData;
+    SectionVisible.Init(true, Data->NumSections());
+    PortalOpen.Init(true, Data->AreaPortals.Num());
+    AreaPortalLinks.Reset();
+    AreaPortalLinks.SetNum(Data->NumAreas);
+    for (int32 p = 0; p < Data->AreaPortals.Num(); ++p)
+    {
+        const FHL2VisAreaPortal& Portal = Data->AreaPortals[p];
+        PortalOpen[p] = Portal.bStartOpen;
+        AreaPortalLinks[Portal.Areas[0]].Add(p);
+        AreaPortalLinks[Portal.Areas[1]].Add(p);
+    }
+    CameraLeaf = CameraCluster = CameraArea = INDEX_NONE;
+    bAreasDirty = true;
+    BindSections();
+}
+
+void UHL2VisibilityComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (bDataValid)
+    {
+        ApplyVisibility(true);
+    }
+    Super::EndPlay(EndPlayReason);
+}
+
+void UHL2VisibilityComponent::BindSections()
+{
+    const UHL2VisibilityData* Data = VisibilityData;
+    SectionPrimitives.SetNum(Data->NumSections());
+    TMap<const UStaticMesh*, int32> MeshSections;
+    for (int32 s = 0; s < Data->NumSections(); ++s)
+    {
+        if (const UStaticMesh* Mesh = Data->SectionMeshes[s].Get())
+        {
+            MeshSections.Add(Mesh, s);
+        }
+    }
+    int32 Bound = 0;
+    for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+    {
+        TInlineComponentArray<UStaticMeshComponent*> Components(*It);
+        for (UStaticMeshComponent* Component : Components)
+        {
+            if (const int32* Section = MeshSections.Find(Component->GetStaticMesh()))
+            {
+                SectionPrimitives[*Section].Add(Component);
+                ++Bound;
+            }
+        }
+    }
+    UE_LOG(LogHL2BSPRuntime, Log, TEXT("%s: %d components bound to %d sections (%d clusters, %d areas, %d area portals)"),
+        *GetPathName(), Bound, Data->NumSections(), Data->NumClusters, Data->NumAreas, Data->AreaPortals.Num());
+}
+
+void UHL2VisibilityComponent::RegisterSection(int32 Section, UPrimitiveComponent* Primitive)
+{
+    if (!bDataValid || !Primitive || !SectionPrimitives.IsValidIndex(Section))
+    {
+        return;
+    }
+    SectionPrimitives[Section].AddUnique(Primitive);
+    Primitive->SetVisibility(SectionVisible[Section]);
+}
+
+void UHL2VisibilityComponent::SetAreaPortalOpen(int32 PortalKey, bool bOpen)
+{
+    if (!bDataValid)
+    {
+        return;
+    }
+    const TArray<FHL2VisAreaPortal>& Portals = VisibilityData->AreaPortals;
+    for (int32 p = 0; p < Portals.Num(); ++p)
+    {
+        if (Portals[p].PortalKey == PortalKey && PortalOpen[p] != bOpen)
+        {
+            PortalOpen[p] = bOpen;
+            bAreasDirty = true;
+        }
+    }
+}
+
+void UHL2VisibilityComponent::FloodAreas()
+{
+    const UHL2VisibilityData* Data = VisibilityData;
+    ConnectedAreas.Init(false, Data->NumAreas);
+    if (!Data->AreaPortals.IsValidIndex(0) || CameraArea <= 0 || CameraArea >= Data->NumAreas)
+    {
+        // No portals, or the camera is in the void: areas do not restrict anything
+        ConnectedAreas.Init(true, Data->NumAreas);
+        return;
+    }
+    TArray<int32, TInlineAllocator<64>> Pending;
+    ConnectedAreas[CameraArea] = true;
+    Pending.Add(CameraArea);
+    while (Pending.Num() > 0)
+    {
+        const int32 Area = Pending.Pop(EAllowShrinking::No);
+        for (int32 p : AreaPortalLinks[Area])
+        {
+            if (!PortalOpen[p]) continue;
+            const FHL2VisAreaPortal& Portal = Data->AreaPortals[p];
+            const int32 Other = Portal.Areas[0] == Area ? Portal.Areas[1] : Portal.Areas[0];
+            if (ConnectedAreas[Other]) continue;
+            ConnectedAreas[Other] = true;
+            Pending.Add(Other);
+        }
+    }
+}
+
+void UHL2VisibilityComponent::SetSectionVisible(int32 Section, bool bVisible)
+{
+    if (SectionVisible[Section] == bVisible)
+    {
+        return;
+    }
+    SectionVisible[Section] = bVisible;
+    for (const TWeakObjectPtr<UPrimitiveComponent>& Primitive : SectionPrimitives[Section])
+    {
+        if (Primitive.IsValid())
+        {
+            Primitive->SetVisibility(bVisible);
+        }
+    }
+}
+
+void UHL2VisibilityComponent::ApplyVisibility(bool bShowAll)
+{
+    const UHL2VisibilityData* Data = VisibilityData;
+    for (int32 s = 0; s < Data->NumSections(); ++s)
+    {
+        SetSectionVisible(s, bShowAll || (Data->IsSectionInPVS(CameraCluster, s) && Data->IsSectionInAreas(s, ConnectedAreas)));
+    }
+}
+
+void UHL2VisibilityComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+    SCOPE_CYCLE_COUNTER(STAT_HL2_VisUpdate);
+    const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+    if (!bDataValid || !PC || !PC->PlayerCameraManager)
+    {
+        return;
+    }
+    const UHL2VisibilityData* Data = VisibilityData;
+    const FVector Camera = GetOwner()->GetActorTransform().InverseTransformPosition(PC->PlayerCameraManager->GetCameraLocation());
+    const int32 Leaf = Data->FindLeaf(FVector3f(Camera));
+    if (Leaf == CameraLeaf && !bAreasDirty)
+    {
+        return;
+    }
+    CameraLeaf = Leaf;
+    const int32 Cluster = Data->LeafClusters[Leaf];
+    const int32 Area = Data->LeafAreas[Leaf];
+    if (Cluster < 0 || Cluster >= Data->NumClusters)
+    {
+        // In solid or outside the map (noclip, or a camera clipping into a wall for a frame)
+        if (bShowAllOutsideMap && CameraCluster != INDEX_NONE)
+        {
+            CameraCluster = INDEX_NONE;
+            ApplyVisibility(true);
+        }
+        return;
+    }
+    if (Cluster == CameraCluster && Area == CameraArea && !bAreasDirty)
+    {
+        return;
+    }
+    if (Area != CameraArea || bAreasDirty)
+    {
+        CameraArea = Area;
+        FloodAreas();
+        bAreasDirty = false;
+    }
+    CameraCluster = Cluster;
+    ApplyVisibility(false);
+}
@@ -0,0 +1,41 @@
+#include "HL2VisibilityData.h"
+#include "HL2BSPRuntime.h"
+
+int32 UHL2VisibilityData::FindLeaf(const FVector3f& Point) const
+{
+    if (Nodes.Num() == 0)
+    {
+        return LeafClusters.Num() > 0 ? 0 : INDEX_NONE;
+    }
+    int32 Child = 0;
+    while (Child >= 0)
+    {
+        const FHL2VisNode& Node = Nodes[Child];
+        Child = Node.Children[FVector3f::DotProduct(FVector3f(Node.Plane), Point) >= Node.Plane.W ? 0 : 1];
+    }
+    return -1 - Child;
+}
+
+bool UHL2VisibilityData::IsSectionInAreas(int32 Section, const TBitArray<>& Areas) const
+{
+    if (AreaWords == 0)
+    {
+        return true;
+    }
+    const uint32* Row = SectionAreas.GetData() + Section * AreaWords;
+    const uint32* Mask = Areas.GetData();
+    for (int32 w = 0; w < AreaWords; ++w)
+    {
+        if (Row[w] & Mask[w])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int64 UHL2VisibilityData::GetDataSize() const
+{
+    return Nodes.Num() * (int64)sizeof(FHL2VisNode) + LeafClusters.Num() * (int64)sizeof(int16) + LeafAreas.Num()
+        + (ClusterSections.Num() + SectionAreas.Num()) * (int64)sizeof(uint32) + AreaPortals.Num() * (int64)sizeof(FHL2VisAreaPortal);
+}
@@ -0,0 +1,6 @@
+// Primary module header for HL2BSPRuntime
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogHL2BSPRuntime, Log, All);
@@ -0,0 +1,58 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HL2VisibilityComponent.generated.h"
+
+class UHL2VisibilityData;
+class UPrimitiveComponent;
+
+// Hides the sections of an imported map that the compiled visibility says the local camera cannot see. Each frame the
+// camera's leaf is looked up in the map's tree; sections are only touched when its cluster or area, or an area
+// portal, changes. Put it on an actor with the same transform as the section meshes (usually the origin).
+UCLASS(ClassGroup = (HL2), meta = (BlueprintSpawnableComponent))
+class HL2BSPRUNTIME_API UHL2VisibilityComponent : public UActorComponent
+{
+    GENERATED_BODY()
+public:
+    UHL2VisibilityComponent();
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "HL2")
+    TObjectPtr<UHL2VisibilityData> VisibilityData;
+
+    // With the camera in solid or outside the map, show everything; otherwise keep what was last visible
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "HL2")
+    bool bShowAllOutsideMap = true;
+
+    // Components in the world whose static mesh is a section mesh are found at BeginPlay; this adds others
+    UFUNCTION(BlueprintCallable, Category = "HL2")
+    void RegisterSection(int32 Section, UPrimitiveComponent* Primitive);
+
+    // Opens or closes every area portal with this key (a door's func_areaportal)
+    UFUNCTION(BlueprintCallable, Category = "HL2")
+    void SetAreaPortalOpen(int32 PortalKey, bool bOpen);
+
+    UFUNCTION(BlueprintPure, Category = "HL2")
+    int32 GetCameraCluster() const { return CameraCluster; }
+
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+    bool ValidateData() const;
+    void BindSections();
+    void FloodAreas();
+    void ApplyVisibility(bool bShowAll);
+    void SetSectionVisible(int32 Section, bool bVisible);
+
+    TArray<TArray<TWeakObjectPtr<UPrimitiveComponent>>> SectionPrimitives;
+    TBitArray<> SectionVisible;
+    TArray<TArray<int32>> AreaPortalLinks;   // per area -> VisibilityData->AreaPortals
+    TBitArray<> PortalOpen;
+    TBitArray<> ConnectedAreas;              // areas reachable from the camera's through open portals
+    int32 CameraLeaf = INDEX_NONE;
+    int32 CameraCluster = INDEX_NONE;
+    int32 CameraArea = INDEX_NONE;
+    bool bAreasDirty = true;
+    bool bDataValid = false;
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "HL2VisibilityData.generated.h"
+
+class UStaticMesh;
+
+// One node of the map's world tree, its plane in Unreal space
+USTRUCT()
+struct HL2BSPRUNTIME_API FHL2VisNode
+{
+    GENERATED_BODY()
+    // Front side is Dot(Plane.XYZ, P) >= Plane.W
+    UPROPERTY() FVector4f Plane = FVector4f(0.f, 0.f, 1.f, 0.f);
+    // Front, back: >= 0 is a node, < 0 is leaf -1 - child
+    UPROPERTY() int32 Children[2] = { -1, -1 };
+};
+
+// A func_areaportal between two areas. Closed portals cut the areas behind them off from the camera's area.
+USTRUCT()
+struct HL2BSPRUNTIME_API FHL2VisAreaPortal
+{
+    GENERATED_BODY()
+    UPROPERTY(VisibleAnywhere, Category = "HL2") int32 PortalKey = 0;   // the entity's "portalnumber"
+    UPROPERTY(VisibleAnywhere, Category = "HL2") int32 Areas[2] = { 0, 0 };
+    UPROPERTY(VisibleAnywhere, Category = "HL2") bool bStartOpen = true;
+};
+
+// Precomputed visibility of one imported map: its world tree and, per cluster, which sections (chunk meshes) its PVS
+// can see. Written next to the chunk manifest; UHL2VisibilityComponent hides the sections the camera cannot see.
+UCLASS()
+class HL2BSPRUNTIME_API UHL2VisibilityData : public UDataAsset
+{
+    GENERATED_BODY()
+public:
+    UPROPERTY(VisibleAnywhere, Category = "HL2") FString SourceFile;
+    UPROPERTY(VisibleAnywhere, Category = "HL2") int32 NumClusters = 0;
+    UPROPERTY(VisibleAnywhere, Category = "HL2") int32 NumAreas = 0;
+    // Section s is drawn by the components using SectionMeshes[s]
+    UPROPERTY(VisibleAnywhere, Category = "HL2") TArray<TSoftObjectPtr<UStaticMesh>> SectionMeshes;
+    UPROPERTY(VisibleAnywhere, Category = "HL2") TArray<FHL2VisAreaPortal> AreaPortals;
+
+    UPROPERTY() TArray<FHL2VisNode> Nodes;
+    UPROPERTY() TArray<int16> LeafClusters;    // -1 for solid leaves and leaves outside the map
+    UPROPERTY() TArray<uint8> LeafAreas;
+    // NumClusters rows of SectionWords words; bit s of row c: section s touches a cluster in c's PVS
+    UPROPERTY() int32 SectionWords = 0;
+    UPROPERTY() TArray<uint32> ClusterSections;
+    // One row of AreaWords words per section: the areas its geometry is in. Empty if the map has no area portals.
+    UPROPERTY() int32 AreaWords = 0;
+    UPROPERTY() TArray<uint32> SectionAreas;
+
+    int32 NumSections() const { return SectionMeshes.Num(); }
+
+    // Leaf holding a point in the space the sections were imported in; INDEX_NONE without a tree
+    int32 FindLeaf(const FVector3f& Point) const;
+
+    bool IsSectionInPVS(int32 Cluster, int32 Section) const
+    {
+        return (ClusterSections[Cluster * SectionWords + (Section >> 5)] >> (Section & 31)) & 1u;
+    }
+
+    // Whether the section is in one of Areas (bit per area)
+    bool IsSectionInAreas(int32 Section, const TBitArray<>& Areas) const;
+
+    // Serialized size of the tree and bit rows, in bytes
+    int64 GetDataSize() const;
+};